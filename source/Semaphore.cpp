@@ -9,7 +9,8 @@
  *
  * @date       2016-01-15
  *
- * @revision   none
+ * @revision   2026-10-16 Eric Tsang - an atomic counter with a futex slow
+ *   path instead of a sem_t; adds try_wait and timed_wait.
  *
  * @designer   Eric Tsang
  *
@@ -17,12 +18,22 @@
  *
  * @note
  *
- * used to wrap an integer of the gmp library so that they will be properly
- *   initialized and deallocated when an instance of this class is constructed
- *   or destroyed.
+ * permits are taken with a compare and swap on the counter, and returned with
+ *   an atomic increment. a thread that finds no permits counts itself as a
+ *   sleeper, and sleeps on the counter with FUTEX_WAIT for as long as it is
+ *   0; post only makes the FUTEX_WAKE system call when there are sleepers.
+ *   the sleeper count is raised before the counter is checked, and post
+ *   checks it after raising the counter, so either the sleeper sees the
+ *   permit, or post sees the sleeper.
  */
 #include "Semaphore.h"
 
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
 /**
  * instantiates a Semaphore instance.
  *
@@ -32,13 +43,15 @@
  *
  * @date       2016-01-15
  *
- * @revision   none
+ * @revision   2026-10-16 Eric Tsang - initializes the counter rather than a
+ *   sem_t.
  *
  * @designer   Eric Tsang
  *
  * @programmer Eric Tsang
  *
- * @note       none
+ * @note       a semaphore shared between processes must be constructed in
+ *   memory they all map, e.g. with placement new into MAP_SHARED memory.
  *
  * @signature  Semaphore::Semaphore(bool betweenProcesses,int permits)
  *
@@ -51,7 +64,9 @@
  */
 Semaphore::Semaphore(bool betweenProcesses,int permits)
 {
-    sem_init(&sem,betweenProcesses?1:0,permits);
+    this->permits = permits;
+    numSleepers = 0;
+    futexFlags = betweenProcesses ? 0 : FUTEX_PRIVATE_FLAG;
 }
 
 /**
@@ -63,19 +78,18 @@ Semaphore::Semaphore(bool betweenProcesses,int permits)
  *
  * @date       2016-01-15
  *
- * @revision   none
+ * @revision   2026-10-16 Eric Tsang - nothing to release any more.
  *
  * @designer   Eric Tsang
  *
  * @programmer Eric Tsang
  *
- * @note       none
+ * @note       the kernel keeps no state for a futex nobody sleeps on.
  *
  * @signature  Semaphore::~Semaphore()
  */
 Semaphore::~Semaphore()
 {
-    sem_destroy(&sem);
 }
 
 /**
@@ -88,7 +102,8 @@ Semaphore::~Semaphore()
  *
  * @date       2016-01-15
  *
- * @revision   none
+ * @revision   2026-10-16 Eric Tsang - only makes a system call if a thread
+ *   is sleeping on the semaphore.
  *
  * @designer   Eric Tsang
  *
@@ -100,7 +115,11 @@ Semaphore::~Semaphore()
  */
 void Semaphore::post()
 {
-    sem_post(&sem);
+    __atomic_add_fetch(&permits,1,__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&numSleepers,__ATOMIC_SEQ_CST) > 0)
+    {
+        syscall(SYS_futex,&permits,FUTEX_WAKE|futexFlags,1,0,0,0);
+    }
 }
 
 /**
@@ -113,7 +132,8 @@ void Semaphore::post()
  *
  * @date       2016-01-15
  *
- * @revision   none
+ * @revision   2026-10-16 Eric Tsang - only makes a system call if there are
+ *   no permits.
  *
  * @designer   Eric Tsang
  *
@@ -125,5 +145,134 @@ void Semaphore::post()
  */
 void Semaphore::wait()
 {
-    sem_wait(&sem);
+    if (!try_wait())
+    {
+        sleep(-1);
+    }
+}
+
+/**
+ * acquires a permit from the semaphore if one is available, without
+ *   blocking.
+ *
+ * @class      Semaphore
+ *
+ * @method     try_wait
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       never makes a system call.
+ *
+ * @signature  bool Semaphore::try_wait()
+ *
+ * @return     true if a permit was acquired.
+ */
+bool Semaphore::try_wait()
+{
+    int available = __atomic_load_n(&permits,__ATOMIC_SEQ_CST);
+    while (available > 0)
+    {
+        if (__atomic_compare_exchange_n(&permits,&available,available-1,true,__ATOMIC_ACQUIRE,__ATOMIC_RELAXED))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * acquires a permit from the semaphore, or blocks until one becomes available
+ *   or {timeout} milliseconds have passed.
+ *
+ * @class      Semaphore
+ *
+ * @method     timed_wait
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the timeout is measured on CLOCK_MONOTONIC, so changes to the
+ *   wall clock do not affect it.
+ *
+ * @signature  bool Semaphore::timed_wait(long timeout)
+ *
+ * @param      timeout milliseconds to wait at most.
+ *
+ * @return     true if a permit was acquired; false if the wait timed out.
+ */
+bool Semaphore::timed_wait(long timeout)
+{
+    if (try_wait())
+    {
+        return true;
+    }
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC,&now);
+    return sleep(now.tv_sec*1000000000L+now.tv_nsec+timeout*1000000L);
+}
+
+/**
+ * sleeps on the semaphore's counter until a permit is acquired, or the
+ *   {deadline} passes.
+ *
+ * @class      Semaphore
+ *
+ * @method     sleep
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       FUTEX_WAIT_BITSET takes an absolute CLOCK_MONOTONIC deadline,
+ *   so spurious wake ups and signals do not stretch the timeout. the futex
+ *   only sleeps while the counter is still 0, so a post racing the sleeper
+ *   cannot be missed.
+ *
+ * @signature  bool Semaphore::sleep(long deadline)
+ *
+ * @param      deadline CLOCK_MONOTONIC time in nanoseconds to give up at; -1
+ *   to never give up.
+ *
+ * @return     true if a permit was acquired; false if the deadline passed.
+ */
+bool Semaphore::sleep(long deadline)
+{
+    struct timespec deadlineSpec;
+    deadlineSpec.tv_sec = deadline/1000000000L;
+    deadlineSpec.tv_nsec = deadline%1000000000L;
+
+    bool isAcquired = true;
+    __atomic_add_fetch(&numSleepers,1,__ATOMIC_SEQ_CST);
+    while (!try_wait())
+    {
+        if (syscall(SYS_futex,&permits,FUTEX_WAIT_BITSET|futexFlags,0,deadline < 0 ? 0 : &deadlineSpec,0,FUTEX_BITSET_MATCH_ANY) == -1)
+        {
+            if (errno == ETIMEDOUT)
+            {
+                errno = 0;
+                isAcquired = false;
+                break;
+            }
+
+            // EAGAIN if a permit came in before sleeping, or EINTR
+            errno = 0;
+        }
+    }
+    __atomic_sub_fetch(&numSleepers,1,__ATOMIC_SEQ_CST);
+    return isAcquired;
 }
@@ -7,7 +7,8 @@
  *
  * @date       2016-01-15
  *
- * @revision   none
+ * @revision   2026-10-16 Eric Tsang - an atomic counter with a futex slow
+ *   path instead of a sem_t; adds try_wait and timed_wait.
  *
  * @designer   Eric Tsang
  *
@@ -15,14 +16,14 @@
  *
  * @note
  *
- * used to wrap a semaphore object so it can be properly deallocated when the
- *   Semaphore instance is destroyed.
+ * a counting semaphore that takes and returns permits with atomic operations
+ *   alone while no thread has to block, and only makes a futex system call to
+ *   sleep when there are no permits, or to wake a sleeper. to share it between
+ *   processes, construct it in shared memory with betweenProcesses set.
  */
 #ifndef SEMAPHORE_H
 #define SEMAPHORE_H
 
-#include <semaphore.h>
-
 class Semaphore
 {
 public:
@@ -31,7 +32,16 @@ public:
     ~Semaphore();
     void post();
     void wait();
-    sem_t sem;
+    bool try_wait();
+    bool timed_wait(long timeout);
+
+private:
+
+    bool sleep(long deadline);
+
+    int permits;            // permits available; the futex word
+    int numSleepers;        // threads in or about to enter the futex wait
+    int futexFlags;         // FUTEX_PRIVATE_FLAG unless shared by processes
 };
 
 #endif
@@ -0,0 +1,644 @@
+#include "async_helper.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sysexits.h>
+#include <sys/socket.h>
+
+static void forget_events(struct async_fd_t* target);
+static void fatal_error(const char* errstr);
+
+/**
+ * reactor running on the calling thread; 0 if none.
+ */
+static __thread struct async_reactor_t* runningReactor = 0;
+
+/**
+ * initializes {reactor}, with no tasks, and makes it the reactor of the
+ *   calling thread.
+ *
+ * @function   async_reactor_init
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       a reactor, its sockets and its tasks must only be used by the
+ *   thread that initialized it.
+ *
+ * @signature  void async_reactor_init(struct async_reactor_t* reactor)
+ *
+ * @param      reactor reactor to initialize.
+ */
+void async_reactor_init(struct async_reactor_t* reactor)
+{
+    reactor->epoll = epoll_create1(EPOLL_CLOEXEC);
+    if (reactor->epoll == -1)
+    {
+        fatal_error("epoll_create1");
+    }
+    reactor->eventIndex = 0;
+    reactor->eventCount = 0;
+    reactor->numTasks = 0;
+    for (int i = 0; i < ASYNC_FRAME_CLASSES; ++i)
+    {
+        reactor->freeFrames[i] = 0;
+    }
+    runningReactor = reactor;
+}
+
+/**
+ * frees the pooled frames of {reactor}, and closes its epoll.
+ *
+ * @function   async_reactor_destroy
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       frames of tasks that have not finished are not tracked, so they
+ *   are not freed.
+ *
+ * @signature  void async_reactor_destroy(struct async_reactor_t* reactor)
+ *
+ * @param      reactor reactor to destroy.
+ */
+void async_reactor_destroy(struct async_reactor_t* reactor)
+{
+    for (int i = 0; i < ASYNC_FRAME_CLASSES; ++i)
+    {
+        while (reactor->freeFrames[i] != 0)
+        {
+            void* frame = reactor->freeFrames[i];
+            reactor->freeFrames[i] = *(void**) frame;
+            free(frame);
+        }
+    }
+    close(reactor->epoll);
+    if (runningReactor == reactor)
+    {
+        runningReactor = 0;
+    }
+}
+
+/**
+ * waits for the sockets of {reactor} with epoll, and resumes the coroutines
+ *   waiting on them once their operations have been done, until every spawned
+ *   task has finished.
+ *
+ * @function   async_reactor_run
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       sockets are registered edge triggered, so an operation is only
+ *   attempted again once epoll reports its socket ready after it would have
+ *   blocked. the operations waiting on a socket are both attempted before
+ *   either coroutine is resumed, since a resumed coroutine may close the
+ *   socket.
+ *
+ * @signature  void async_reactor_run(struct async_reactor_t* reactor)
+ *
+ * @param      reactor reactor to run.
+ */
+void async_reactor_run(struct async_reactor_t* reactor)
+{
+    while (reactor->numTasks > 0)
+    {
+        reactor->eventCount = epoll_wait(reactor->epoll,reactor->events,ASYNC_EPOLL_QUEUE_LEN,-1);
+        if (reactor->eventCount == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            fatal_error("epoll_wait");
+        }
+
+        for (reactor->eventIndex = 0; reactor->eventIndex < reactor->eventCount; ++reactor->eventIndex)
+        {
+            struct epoll_event* event = &reactor->events[reactor->eventIndex];
+            struct async_fd_t* target = (struct async_fd_t*) event->data.ptr;
+            if (target == 0)
+            {
+                continue;
+            }
+
+            struct async_op_t* reader = 0;
+            struct async_op_t* writer = 0;
+            if (target->reader != 0 && (event->events&(EPOLLIN|EPOLLRDHUP|EPOLLERR|EPOLLHUP))
+                && async_attempt(target->reader))
+            {
+                reader = target->reader;
+                target->reader = 0;
+            }
+            if (target->writer != 0 && (event->events&(EPOLLOUT|EPOLLERR|EPOLLHUP))
+                && async_attempt(target->writer))
+            {
+                writer = target->writer;
+                target->writer = 0;
+            }
+            if (reader != 0)
+            {
+                reader->waiter.resume();
+            }
+            if (writer != 0)
+            {
+                writer->waiter.resume();
+            }
+        }
+        reactor->eventCount = 0;
+    }
+}
+
+/**
+ * allocates a coroutine frame from the pool of the reactor of the thread.
+ *
+ * @function   async_frame_alloc
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       frames are pooled by size, rounded up to ASYNC_FRAME_GRANULE,
+ *   so a task started for every connection or request only calls malloc
+ *   until as many frames as are running at once have been freed once.
+ *
+ * @signature  void* async_frame_alloc(size_t size)
+ *
+ * @param      size bytes of the frame.
+ *
+ * @return     the frame.
+ */
+void* async_frame_alloc(size_t size)
+{
+    size_t sizeClass = (size+ASYNC_FRAME_GRANULE-1)/ASYNC_FRAME_GRANULE;
+    void* frame;
+    if (sizeClass < ASYNC_FRAME_CLASSES && runningReactor->freeFrames[sizeClass] != 0)
+    {
+        frame = runningReactor->freeFrames[sizeClass];
+        runningReactor->freeFrames[sizeClass] = *(void**) frame;
+        return frame;
+    }
+    frame = malloc(sizeClass*ASYNC_FRAME_GRANULE);
+    if (frame == 0)
+    {
+        fatal_error("malloc");
+    }
+    return frame;
+}
+
+/**
+ * returns a coroutine frame to the pool of the reactor of the thread.
+ *
+ * @function   async_frame_free
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  void async_frame_free(void* frame, size_t size)
+ *
+ * @param      frame frame returned by async_frame_alloc.
+ * @param      size bytes of the frame, as passed to async_frame_alloc.
+ */
+void async_frame_free(void* frame, size_t size)
+{
+    size_t sizeClass = (size+ASYNC_FRAME_GRANULE-1)/ASYNC_FRAME_GRANULE;
+    if (sizeClass < ASYNC_FRAME_CLASSES)
+    {
+        *(void**) frame = runningReactor->freeFrames[sizeClass];
+        runningReactor->freeFrames[sizeClass] = frame;
+    }
+    else
+    {
+        free(frame);
+    }
+}
+
+/**
+ * attempts {op} without blocking.
+ *
+ * @function   async_attempt
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       a write carries on from the bytes already written, until they
+ *   all are.
+ *
+ * @signature  bool async_attempt(struct async_op_t* op)
+ *
+ * @param      op operation to attempt.
+ *
+ * @return     true once {op} is done, and its result set; false if it would
+ *   block.
+ */
+bool async_attempt(struct async_op_t* op)
+{
+    ssize_t result;
+    switch (op->kind)
+    {
+    case ASYNC_OP_READ:
+        result = recv(op->fd,op->buf,op->len,0);
+        break;
+    case ASYNC_OP_WRITE:
+        result = 0;
+        while (op->done < op->len)
+        {
+            result = send(op->fd,op->buf+op->done,op->len-op->done,MSG_NOSIGNAL);
+            if (result == -1)
+            {
+                break;
+            }
+            op->done += result;
+        }
+        if (result != -1)
+        {
+            result = op->done;
+        }
+        break;
+    default:
+        result = accept4(op->fd,0,0,SOCK_NONBLOCK|SOCK_CLOEXEC);
+        break;
+    }
+
+    if (result == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+    {
+        return false;
+    }
+    op->result = result;
+    op->error = result == -1 ? errno : 0;
+    return true;
+}
+
+/**
+ * adds {fd} to the epoll of the reactor of the thread, with {target} as the
+ *   data of its events.
+ *
+ * @function   async_register
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  void async_register(struct async_fd_t* target, int fd,
+ *   unsigned int events)
+ *
+ * @param      target file descriptor to initialize.
+ * @param      fd non-blocking file descriptor to register.
+ * @param      events epoll events to wait for.
+ */
+void async_register(struct async_fd_t* target, int fd, unsigned int events)
+{
+    target->fd = fd;
+    target->reader = 0;
+    target->writer = 0;
+
+    struct epoll_event event = epoll_event();
+    event.events = events;
+    event.data.ptr = target;
+    if (epoll_ctl(runningReactor->epoll,EPOLL_CTL_ADD,fd,&event) == -1)
+    {
+        fatal_error("epoll_ctl");
+    }
+}
+
+/**
+ * removes {target} from the epoll of the reactor of the thread.
+ *
+ * @function   async_unregister
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  void async_unregister(struct async_fd_t* target)
+ *
+ * @param      target file descriptor to remove.
+ */
+void async_unregister(struct async_fd_t* target)
+{
+    epoll_ctl(runningReactor->epoll,EPOLL_CTL_DEL,target->fd,0);
+    forget_events(target);
+}
+
+/**
+ * counts a task spawned on the reactor of the thread.
+ *
+ * @function   async_task_started
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  void async_task_started()
+ */
+void async_task_started()
+{
+    runningReactor->numTasks++;
+}
+
+/**
+ * counts a spawned task that finished on the reactor of the thread.
+ *
+ * @function   async_task_finished
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  void async_task_finished()
+ */
+void async_task_finished()
+{
+    runningReactor->numTasks--;
+}
+
+/**
+ * starts {task} on the reactor of the thread, and lets it run on its own; its
+ *   frame is freed once it finishes.
+ *
+ * @function   async_spawn
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the task runs until it first waits, before this returns.
+ *
+ * @signature  void async_spawn(async_task_t task)
+ *
+ * @param      task task to start.
+ */
+void async_spawn(async_task_t task)
+{
+    std::coroutine_handle<async_task_t::promise_type> handle = task.handle;
+    task.handle = 0;
+    handle.promise().isDetached = true;
+    async_task_started();
+    handle.resume();
+}
+
+/**
+ * aborts the program if a task throws; the servers do not use exceptions.
+ *
+ * @function   async_task_t::promise_type::unhandled_exception
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  void async_task_t::promise_type::unhandled_exception()
+ */
+void async_task_t::promise_type::unhandled_exception()
+{
+    fprintf(stderr,"unhandled exception in task\n");
+    abort();
+}
+
+/**
+ * returns the result of the operation, with errno set if it failed.
+ *
+ * @function   async_io_t::await_resume
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  ssize_t async_io_t::await_resume()
+ *
+ * @return     bytes read or written, the accepted socket, or -1.
+ */
+ssize_t async_io_t::await_resume()
+{
+    if (op.result == -1)
+    {
+        errno = op.error;
+    }
+    return op.result;
+}
+
+/**
+ * registers {fd} with the reactor of the thread.
+ *
+ * @function   async_socket_t::async_socket_t
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the socket is registered for both directions once, edge
+ *   triggered, so awaiting it never calls epoll_ctl.
+ *
+ * @signature  async_socket_t::async_socket_t(int fd)
+ *
+ * @param      fd connected, non-blocking socket.
+ */
+async_socket_t::async_socket_t(int fd)
+{
+    async_register(&target,fd,EPOLLIN|EPOLLOUT|EPOLLRDHUP|EPOLLET);
+}
+
+/**
+ * closes the socket.
+ *
+ * @function   async_socket_t::~async_socket_t
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       closing the socket removes it from epoll.
+ *
+ * @signature  async_socket_t::~async_socket_t()
+ */
+async_socket_t::~async_socket_t()
+{
+    forget_events(&target);
+    close(target.fd);
+}
+
+/**
+ * registers the listening socket {fd} with the reactor of the thread.
+ *
+ * @function   async_listener_t::async_listener_t
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       EPOLLEXCLUSIVE wakes one of the threads listening on the socket
+ *   for a connection request, rather than all of them.
+ *
+ * @signature  async_listener_t::async_listener_t(int fd)
+ *
+ * @param      fd non-blocking listening socket.
+ */
+async_listener_t::async_listener_t(int fd)
+{
+    async_register(&target,fd,EPOLLIN|EPOLLET|EPOLLEXCLUSIVE);
+}
+
+/**
+ * removes the listening socket from the reactor of the thread.
+ *
+ * @function   async_listener_t::~async_listener_t
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  async_listener_t::~async_listener_t()
+ */
+async_listener_t::~async_listener_t()
+{
+    async_unregister(&target);
+}
+
+/**
+ * clears the events of {target} that the reactor of the thread has yet to
+ *   handle, since {target} is about to be freed.
+ *
+ * @function   forget_events
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       without this, a coroutine that closes its socket while the
+ *   reactor handles an event of another socket could leave an event pointing
+ *   at its freed frame later in the same batch.
+ *
+ * @signature  static void forget_events(struct async_fd_t* target)
+ *
+ * @param      target file descriptor about to be freed.
+ */
+static void forget_events(struct async_fd_t* target)
+{
+    for (int i = runningReactor->eventIndex+1; i < runningReactor->eventCount; ++i)
+    {
+        if (runningReactor->events[i].data.ptr == target)
+        {
+            runningReactor->events[i].data.ptr = 0;
+        }
+    }
+}
+
+/**
+ * prints the error message, then exits the program.
+ *
+ * @function   fatal_error
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  static void fatal_error(const char* errstr)
+ *
+ * @param      errstr string to print before exiting the program
+ */
+static void fatal_error(const char* errstr)
+{
+    fprintf(stderr,"%s: ",errstr);
+    perror(0);
+    exit(EX_OSERR);
+}
@@ -0,0 +1,250 @@
+#ifndef _ASYNC_HELPER_H_
+#define _ASYNC_HELPER_H_
+
+#include <stddef.h>
+#include <sys/types.h>
+#include <sys/epoll.h>
+#include <coroutine>
+
+/**
+ * size of events array passed to epoll_wait by a reactor.
+ */
+#define ASYNC_EPOLL_QUEUE_LEN 2048
+
+/**
+ * coroutine frames are pooled in size classes this many bytes apart.
+ */
+#define ASYNC_FRAME_GRANULE 64
+
+/**
+ * number of size classes of pooled coroutine frames; bigger frames are
+ *   allocated with malloc.
+ */
+#define ASYNC_FRAME_CLASSES 64
+
+/**
+ * kinds of operation an async_op_t performs.
+ */
+#define ASYNC_OP_READ 0
+#define ASYNC_OP_WRITE 1
+#define ASYNC_OP_ACCEPT 2
+
+/**
+ * runs the coroutines of one thread. a coroutine runs until an operation on a
+ *   socket would block; it then waits in the reactor's epoll, which resumes it
+ *   once the operation has been done.
+ */
+struct async_reactor_t
+{
+    int epoll;                      // events with a null data.ptr are ignored
+    struct epoll_event events[ASYNC_EPOLL_QUEUE_LEN];
+    int eventIndex;                 // event being handled
+    int eventCount;                 // events returned by the last epoll_wait
+    int numTasks;                   // spawned tasks not finished
+    void* freeFrames[ASYNC_FRAME_CLASSES];
+};
+
+/**
+ * an operation on a socket, attempted until it would not block. it lives in
+ *   the frame of the coroutine awaiting it.
+ */
+struct async_op_t
+{
+    int kind;                       // ASYNC_OP_READ, ASYNC_OP_WRITE or ASYNC_OP_ACCEPT
+    int fd;
+    char* buf;
+    size_t len;
+    size_t done;                    // bytes written so far
+    ssize_t result;
+    int error;                      // errno of a failed operation
+    std::coroutine_handle<> waiter;
+};
+
+/**
+ * file descriptor registered with the reactor of the thread; the epoll
+ *   events of the file descriptor point to it.
+ */
+struct async_fd_t
+{
+    int fd;
+    struct async_op_t* reader;      // operation waiting for EPOLLIN; 0 if none
+    struct async_op_t* writer;      // operation waiting for EPOLLOUT; 0 if none
+};
+
+void async_reactor_init(struct async_reactor_t* reactor);
+void async_reactor_destroy(struct async_reactor_t* reactor);
+void async_reactor_run(struct async_reactor_t* reactor);
+void* async_frame_alloc(size_t size);
+void async_frame_free(void* frame, size_t size);
+bool async_attempt(struct async_op_t* op);
+void async_register(struct async_fd_t* target, int fd, unsigned int events);
+void async_unregister(struct async_fd_t* target);
+void async_task_started();
+void async_task_finished();
+
+/**
+ * awaitable operation on a socket. the operation is attempted at once, and
+ *   the coroutine is only suspended if it would block.
+ *
+ * co_await returns what the system call returns: bytes read or written, or
+ *   the accepted file descriptor; -1 with errno set if it failed.
+ */
+class async_io_t
+{
+public:
+    async_io_t(struct async_fd_t* target, int kind, void* buf, size_t len)
+    {
+        this->target = target;
+        op.kind = kind;
+        op.fd = target->fd;
+        op.buf = (char*) buf;
+        op.len = len;
+        op.done = 0;
+        op.result = 0;
+        op.error = 0;
+    }
+    bool await_ready()
+    {
+        return async_attempt(&op);
+    }
+    void await_suspend(std::coroutine_handle<> waiter)
+    {
+        op.waiter = waiter;
+        if (op.kind == ASYNC_OP_WRITE)
+        {
+            target->writer = &op;
+        }
+        else
+        {
+            target->reader = &op;
+        }
+    }
+    ssize_t await_resume();
+private:
+    struct async_fd_t* target;
+    struct async_op_t op;
+};
+
+/**
+ * connected, non-blocking socket, registered with the reactor of the thread
+ *   while the object exists. the socket is closed with the object.
+ */
+class async_socket_t
+{
+public:
+    async_socket_t(int fd);
+    ~async_socket_t();
+    async_socket_t(const async_socket_t&) = delete;
+    async_socket_t& operator=(const async_socket_t&) = delete;
+    int fd() { return target.fd; }
+
+    /**
+     * reads up to {len} bytes; returns the bytes read, 0 once the peer has
+     *   closed its end, or -1.
+     */
+    async_io_t read(void* buf, size_t len)
+    {
+        return async_io_t(&target,ASYNC_OP_READ,buf,len);
+    }
+
+    /**
+     * writes all {len} bytes; returns {len}, or -1.
+     */
+    async_io_t write(const void* buf, size_t len)
+    {
+        return async_io_t(&target,ASYNC_OP_WRITE,(void*) buf,len);
+    }
+private:
+    struct async_fd_t target;
+};
+
+/**
+ * listening socket, registered with the reactor of the thread while the
+ *   object exists. any number of threads may listen on the same socket; it is
+ *   not closed with the object.
+ */
+class async_listener_t
+{
+public:
+    async_listener_t(int fd);
+    ~async_listener_t();
+    async_listener_t(const async_listener_t&) = delete;
+    async_listener_t& operator=(const async_listener_t&) = delete;
+
+    /**
+     * accepts a connection; returns its non-blocking socket, or -1.
+     */
+    async_io_t accept()
+    {
+        return async_io_t(&target,ASYNC_OP_ACCEPT,0,0);
+    }
+private:
+    struct async_fd_t target;
+};
+
+/**
+ * coroutine that returns nothing. it starts once awaited, and resumes the
+ *   coroutine awaiting it once it finishes; or once spawned with async_spawn,
+ *   and then runs on its own. its frame comes from the reactor's pool.
+ */
+class async_task_t
+{
+public:
+    struct promise_type
+    {
+        std::coroutine_handle<> continuation;
+        bool isDetached = false;
+
+        struct final_awaiter_t
+        {
+            bool await_ready() noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> self) noexcept
+            {
+                std::coroutine_handle<> continuation = self.promise().continuation;
+                if (self.promise().isDetached)
+                {
+                    self.destroy();
+                    async_task_finished();
+                }
+                return continuation ? continuation : std::noop_coroutine();
+            }
+            void await_resume() noexcept {}
+        };
+
+        static void* operator new(size_t size) { return async_frame_alloc(size); }
+        static void operator delete(void* frame, size_t size) { async_frame_free(frame,size); }
+        async_task_t get_return_object() { return async_task_t(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        final_awaiter_t final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception();
+    };
+
+    explicit async_task_t(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+    async_task_t(async_task_t&& other) : handle(other.handle) { other.handle = 0; }
+    async_task_t(const async_task_t&) = delete;
+    async_task_t& operator=(const async_task_t&) = delete;
+    ~async_task_t()
+    {
+        if (handle)
+        {
+            handle.destroy();
+        }
+    }
+
+    bool await_ready() { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter)
+    {
+        handle.promise().continuation = awaiter;
+        return handle;
+    }
+    void await_resume() {}
+
+    friend void async_spawn(async_task_t task);
+private:
+    std::coroutine_handle<promise_type> handle;
+};
+
+void async_spawn(async_task_t task);
+
+#endif
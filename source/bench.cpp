@@ -0,0 +1,793 @@
+/**
+ * benchmark driver. starts each server on the loopback interface, loads it
+ *   with the epoll client for every combination of worker count, connection
+ *   count and payload size, and writes the aggregated statistics of repeated
+ *   trials to a CSV file.
+ *
+ * @sourceFile bench.cpp
+ *
+ * @program    bench.out
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       run from the folder the servers and client were built in.
+ */
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sysexits.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+/**
+ * most values a comma separated list option takes.
+ */
+#define BENCH_LIST_LEN 16
+
+/**
+ * most trials of one configuration.
+ */
+#define BENCH_MAX_TRIALS 64
+
+/**
+ * milliseconds to wait for a server to start listening.
+ */
+#define BENCH_START_TIMEOUT 5000
+
+/**
+ * milliseconds to wait for a server to drain and exit before killing it.
+ */
+#define BENCH_STOP_TIMEOUT 5000
+
+/**
+ * milliseconds a client may run past its lifetime before it is killed.
+ */
+#define BENCH_CLIENT_GRACE 10000
+
+/**
+ * size of the buffer the output of a client run is read into.
+ */
+#define BENCH_OUTPUT_LEN 65536
+
+/**
+ * two-sided 95% critical values of Student's t distribution, by degrees of
+ *   freedom from 1 to 30; the normal distribution's 1.96 is used beyond.
+ */
+static const double tCritical95[] =
+{
+    12.706,4.303,3.182,2.776,2.571,2.447,2.365,2.306,2.262,2.228,
+    2.201,2.179,2.160,2.145,2.131,2.120,2.110,2.101,2.093,2.086,
+    2.080,2.074,2.069,2.064,2.060,2.056,2.052,2.048,2.045,2.042,
+};
+
+/**
+ * statistics of one client run, summed over the client's worker processes.
+ */
+struct trial_t
+{
+    double requestsRate;        // echo requests served per second
+    double sessionsRate;        // sessions served per second
+    double avgRequestLatency;   // microseconds; weighted by requests
+    double p99RequestLatency;   // microseconds; the worst of the workers'
+    unsigned long totalRequestCount;
+    unsigned long corruptSessionCount;
+    int numReports;             // number of worker reports parsed
+};
+
+/**
+ * prints the error message, then exits the program.
+ *
+ * @function   fatal_error
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  void fatal_error(const char* string)
+ *
+ * @param      string string to print before exiting the program
+ */
+void fatal_error(char const * string)
+{
+    fprintf(stderr,"%s: ",string);
+    perror(0);
+    exit(EX_OSERR);
+}
+
+/**
+ * returns the current time in milliseconds.
+ *
+ * @function   current_time
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  long current_time()
+ *
+ * @return     current time in milliseconds.
+ */
+long current_time()
+{
+    struct timeval te;
+    gettimeofday(&te,0);
+    return te.tv_sec*1000L + te.tv_usec/1000;
+}
+
+/**
+ * parses a comma separated list of positive integers.
+ *
+ * @function   parse_list
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  int parse_list(const char* spec, long* values)
+ *
+ * @param      spec list to parse, e.g. "1,2,4".
+ * @param      values set to the values of the list; BENCH_LIST_LEN long.
+ *
+ * @return     number of values parsed; 0 if {spec} is invalid.
+ */
+int parse_list(const char* spec, long* values)
+{
+    int count = 0;
+    const char* cursor = spec;
+    while (count < BENCH_LIST_LEN)
+    {
+        char* parsedCursor;
+        values[count] = strtol(cursor,&parsedCursor,10);
+        if (parsedCursor == cursor || values[count] <= 0)
+        {
+            return 0;
+        }
+        count++;
+        if (*parsedCursor == '\0')
+        {
+            return count;
+        }
+        if (*parsedCursor != ',')
+        {
+            return 0;
+        }
+        cursor = parsedCursor+1;
+    }
+    return 0;
+}
+
+/**
+ * starts {program} in a process group of its own, with its output sent to
+ *   {outputFd}.
+ *
+ * @function   spawn
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the process group keeps the signals that the client sends to
+ *   its own group from reaching the driver.
+ *
+ * @signature  pid_t spawn(char* const* argv, int outputFd)
+ *
+ * @param      argv program and arguments to run; null terminated.
+ * @param      outputFd file descriptor stdout and stderr are redirected to.
+ *
+ * @return     process id of the new process.
+ */
+pid_t spawn(char* const* argv, int outputFd)
+{
+    pid_t pid = fork();
+    if (pid == -1)
+    {
+        fatal_error("fork");
+    }
+    if (pid == 0)
+    {
+        setpgid(0,0);
+        dup2(outputFd,STDOUT_FILENO);
+        dup2(outputFd,STDERR_FILENO);
+        sigset_t signals;
+        sigemptyset(&signals);
+        sigprocmask(SIG_SETMASK,&signals,0);
+        execv(argv[0],argv);
+        fprintf(stderr,"exec %s: %s\n",argv[0],strerror(errno));
+        _exit(EX_OSERR);
+    }
+    setpgid(pid,pid);
+    return pid;
+}
+
+/**
+ * waits for the process {pid} to exit for up to {timeout} milliseconds, then
+ *   kills its process group.
+ *
+ * @function   reap
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  bool reap(pid_t pid, long timeout)
+ *
+ * @param      pid process to wait for.
+ * @param      timeout milliseconds to wait.
+ *
+ * @return     true if the process exited in time; false if it was killed.
+ */
+bool reap(pid_t pid, long timeout)
+{
+    long deadline = current_time()+timeout;
+    while (current_time() < deadline)
+    {
+        if (waitpid(pid,0,WNOHANG) == pid)
+        {
+            return true;
+        }
+        usleep(10000);
+    }
+    kill(-pid,SIGKILL);
+    waitpid(pid,0,0);
+    return false;
+}
+
+/**
+ * waits until a server accepts connections on {port} of the loopback
+ *   interface.
+ *
+ * @function   wait_for_port
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  bool wait_for_port(int port)
+ *
+ * @param      port port to connect to.
+ *
+ * @return     true once connected; false after BENCH_START_TIMEOUT.
+ */
+bool wait_for_port(int port)
+{
+    struct sockaddr_in addr;
+    memset(&addr,0,sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((unsigned short) port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    long deadline = current_time()+BENCH_START_TIMEOUT;
+    while (current_time() < deadline)
+    {
+        int fd = socket(AF_INET,SOCK_STREAM,0);
+        if (fd == -1)
+        {
+            fatal_error("socket");
+        }
+        int result = connect(fd,(struct sockaddr*) &addr,sizeof(addr));
+        close(fd);
+        if (result == 0)
+        {
+            return true;
+        }
+        usleep(20000);
+    }
+    errno = 0;
+    return false;
+}
+
+/**
+ * adds the statistics printed by the client in {output} to {trial}.
+ *
+ * @function   parse_client_output
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       every worker process of the client prints a block of "key:
+ *   value" lines; rates and counts are summed, and the average latency is
+ *   weighted by the requests behind it. percentiles of separate workers
+ *   cannot be merged, so the p99 latency is the highest any worker reported;
+ *   an upper bound of the client's.
+ *
+ * @signature  void parse_client_output(char* output, struct trial_t* trial)
+ *
+ * @param      output output of the client; modified.
+ * @param      trial statistics to add to.
+ */
+void parse_client_output(char* output, struct trial_t* trial)
+{
+    double latencySum = 0;
+    double blockLatency = 0;
+    for (char* line = strtok(output,"\n"); line != 0; line = strtok(0,"\n"))
+    {
+        char* colon = strchr(line,':');
+        if (colon == 0)
+        {
+            continue;
+        }
+        *colon = '\0';
+        char* key = line;
+        while (isspace(*key)) key++;
+        double value = strtod(colon+1,0);
+
+        if (strcmp(key,"avgRequestLatency") == 0)
+        {
+            blockLatency = value;
+        }
+        else if (strcmp(key,"p99RequestLatency") == 0)
+        {
+            if (value > trial->p99RequestLatency) trial->p99RequestLatency = value;
+        }
+        else if (strcmp(key,"totalRequestCount") == 0)
+        {
+            trial->totalRequestCount += (unsigned long) value;
+            latencySum += blockLatency*value;
+            trial->numReports++;
+        }
+        else if (strcmp(key,"requestsRate") == 0)
+        {
+            trial->requestsRate += value;
+        }
+        else if (strcmp(key,"sessionsRate") == 0)
+        {
+            trial->sessionsRate += value;
+        }
+        else if (strcmp(key,"corruptSessionCount") == 0)
+        {
+            trial->corruptSessionCount += (unsigned long) value;
+        }
+    }
+    if (trial->totalRequestCount > 0)
+    {
+        trial->avgRequestLatency = latencySum/trial->totalRequestCount;
+    }
+}
+
+/**
+ * runs the client against the server on {port} for {duration} milliseconds.
+ *
+ * @function   run_client
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  bool run_client(int port, int numProcesses, long numConnections,
+ *   long payloadLen, long requestsPerConnection, long duration,
+ *   struct trial_t* trial)
+ *
+ * @param      port port of the server on the loopback interface.
+ * @param      numProcesses number of client worker processes.
+ * @param      numConnections number of connections kept open.
+ * @param      payloadLen bytes per echo request.
+ * @param      requestsPerConnection echo requests made before reconnecting.
+ * @param      duration milliseconds to run the client for.
+ * @param      trial set to the statistics of the run.
+ *
+ * @return     true if the client reported its statistics.
+ */
+bool run_client(int port, int numProcesses, long numConnections, long payloadLen, long requestsPerConnection, long duration, struct trial_t* trial)
+{
+    char portArg[16], processesArg[16], connectionsArg[24], payloadArg[24], requestsArg[24], durationArg[24];
+    sprintf(portArg,"%d",port);
+    sprintf(processesArg,"%d",numProcesses);
+    sprintf(connectionsArg,"%ld",numConnections);
+    sprintf(payloadArg,"%ld",payloadLen);
+    sprintf(requestsArg,"%ld",requestsPerConnection);
+    sprintf(durationArg,"%ld",duration);
+    char* argv[] = {(char*) "./epoll_clnt.out",(char*) "-h",(char*) "127.0.0.1",(char*) "-p",portArg,
+        (char*) "-n",processesArg,(char*) "-c",connectionsArg,(char*) "-l",payloadArg,
+        (char*) "-r",requestsArg,(char*) "-t",durationArg,0};
+
+    int pipeFds[2];
+    if (pipe2(pipeFds,O_CLOEXEC) == -1)
+    {
+        fatal_error("pipe2");
+    }
+    fcntl(pipeFds[1],F_SETFD,0);
+    pid_t pid = spawn(argv,pipeFds[1]);
+    close(pipeFds[1]);
+
+    // read the client's output until every one of its processes is done
+    static char output[BENCH_OUTPUT_LEN];
+    size_t outputLen = 0;
+    long deadline = current_time()+duration+BENCH_CLIENT_GRACE;
+    while (true)
+    {
+        long remaining = deadline-current_time();
+        struct pollfd pollFd;
+        pollFd.fd = pipeFds[0];
+        pollFd.events = POLLIN;
+        pollFd.revents = 0;
+        if (remaining <= 0 || poll(&pollFd,1,(int) remaining) == 0)
+        {
+            fprintf(stderr,"[bench] client did not finish in time; killing it\n");
+            kill(-pid,SIGKILL);
+            break;
+        }
+        ssize_t bytesRead = read(pipeFds[0],output+outputLen,sizeof(output)-1-outputLen);
+        if (bytesRead <= 0)
+        {
+            break;
+        }
+        outputLen += bytesRead;
+    }
+    errno = 0;
+    output[outputLen] = '\0';
+    close(pipeFds[0]);
+    waitpid(pid,0,0);
+
+    memset(trial,0,sizeof(struct trial_t));
+    parse_client_output(output,trial);
+    return trial->numReports == numProcesses;
+}
+
+/**
+ * computes the mean of {values}, and the half width of its 95% confidence
+ *   interval.
+ *
+ * @function   confidence_interval
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       uses Student's t distribution, so that a handful of trials
+ *   gives an honest interval. the half width is 0 for a single trial.
+ *
+ * @signature  double confidence_interval(const double* values, int count,
+ *   double* halfWidth)
+ *
+ * @param      values samples.
+ * @param      count number of samples.
+ * @param      halfWidth set to the half width of the interval.
+ *
+ * @return     mean of the samples.
+ */
+double confidence_interval(const double* values, int count, double* halfWidth)
+{
+    double mean = 0;
+    for (register int i = 0; i < count; ++i)
+    {
+        mean += values[i];
+    }
+    mean /= count;
+
+    *halfWidth = 0;
+    if (count > 1)
+    {
+        double variance = 0;
+        for (register int i = 0; i < count; ++i)
+        {
+            variance += (values[i]-mean)*(values[i]-mean);
+        }
+        variance /= count-1;
+        int degrees = count-1;
+        double t = degrees <= 30 ? tCritical95[degrees-1] : 1.96;
+        *halfWidth = t*sqrt(variance/count);
+    }
+    return mean;
+}
+
+/**
+ * main entry point of the application.
+ *
+ * parses command line arguments, then runs every configuration of the matrix
+ *   and appends a line of statistics for each to the CSV file.
+ *
+ * @function   main
+ *
+ * @date       2026-10-16
+ *
+ * @revision   2026-10-16 Eric Tsang - benchmarks coro_svr as well.
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       every server is restarted for each worker count on a port of
+ *   its own, so connections of the previous server lingering in TIME_WAIT do
+ *   not get in the way. a warm-up run precedes the trials of every
+ *   configuration and is discarded.
+ *
+ * @signature  int main (int argc, char* argv[])
+ *
+ * @param      argc number of command line arguments.
+ * @param      argv array of c-style strings.
+ *
+ * @return     exit code of the application.
+ */
+int main (int argc, char* argv[])
+{
+    // file to write the results to
+    const char* csvPath = "./bench.csv";
+
+    // servers to benchmark
+    const char* servers[] = {"epoll_svr","select_svr","thread_svr","coro_svr"};
+    bool isServerSelected[] = {true,true,true,true};
+    const int numServers = sizeof(servers)/sizeof(servers[0]);
+
+    // values of the matrix
+    long workerCounts[BENCH_LIST_LEN] = {1,2,4};
+    int numWorkerCounts = 3;
+    long connectionCounts[BENCH_LIST_LEN] = {10,100};
+    int numConnectionCounts = 2;
+    long payloadLens[BENCH_LIST_LEN] = {64,4096};
+    int numPayloadLens = 2;
+
+    // how each configuration is run
+    int numTrials = 5;
+    long trialDuration = 3000;
+    long warmupDuration = 1000;
+    long requestsPerConnection = 100;
+    int numClientProcesses = 2;
+    int basePort = 7300;
+
+    // parse command line arguments
+    {
+        int option;
+        while ((option = getopt(argc,argv,"o:s:w:c:l:n:t:W:r:N:p:")) != -1)
+        {
+            switch (option)
+            {
+            case 'o':
+                {
+                    csvPath = optarg;
+                    break;
+                }
+            case 's':
+                {
+                    for (register int i = 0; i < numServers; ++i)
+                    {
+                        isServerSelected[i] = strstr(optarg,servers[i]) != 0;
+                    }
+                    break;
+                }
+            case 'w':
+            case 'c':
+            case 'l':
+                {
+                    long* values = option == 'w' ? workerCounts : option == 'c' ? connectionCounts : payloadLens;
+                    int* count = option == 'w' ? &numWorkerCounts : option == 'c' ? &numConnectionCounts : &numPayloadLens;
+                    long parsed[BENCH_LIST_LEN];
+                    int numParsed = parse_list(optarg,parsed);
+                    if (numParsed == 0)
+                    {
+                        fprintf(stderr,"invalid argument for option -%c\n",option);
+                    }
+                    else
+                    {
+                        memcpy(values,parsed,sizeof(parsed));
+                        *count = numParsed;
+                    }
+                    break;
+                }
+            case 'n':
+            case 't':
+            case 'W':
+            case 'r':
+            case 'N':
+            case 'p':
+                {
+                    char* parsedCursor = optarg;
+                    long value = strtol(optarg,&parsedCursor,10);
+                    if (parsedCursor == optarg || value < 0 || (option == 'n' && (value < 1 || value > BENCH_MAX_TRIALS)))
+                    {
+                        fprintf(stderr,"invalid argument for option -%c\n",option);
+                        break;
+                    }
+                    switch (option)
+                    {
+                    case 'n': numTrials = (int) value; break;
+                    case 't': trialDuration = value; break;
+                    case 'W': warmupDuration = value; break;
+                    case 'r': requestsPerConnection = value; break;
+                    case 'N': numClientProcesses = (int) value; break;
+                    case 'p': basePort = (int) value; break;
+                    }
+                    break;
+                }
+            case '?':
+                {
+                    if (isprint(optopt))
+                    {
+                        fprintf(stderr,"unknown option \"-%c\".\n",optopt);
+                    }
+                    else
+                    {
+                        fprintf(stderr,"unknown option character \"%x\".\n",optopt);
+                    }
+                }
+            default:
+                {
+                    fprintf(stderr,"usage: %s [-o CSV file] [-s servers, e.g. epoll_svr,thread_svr] [-w worker counts, e.g. 1,2,4] [-c connection counts] [-l payload sizes] [-n trials] [-t trial ms] [-W warm-up ms] [-r requests per connection] [-N client processes] [-p base port]\n",argv[0]);
+                    return EX_USAGE;
+                }
+            }
+        }
+    }
+
+    // open the CSV file, and write the header if it is new
+    FILE* csv = fopen(csvPath,"a");
+    if (csv == 0)
+    {
+        fatal_error("fopen");
+    }
+    if (ftell(csv) == 0)
+    {
+        fprintf(csv,"server,workers,connections,payload,trials,requests_per_s,requests_per_s_ci95,sessions_per_s,sessions_per_s_ci95,latency_us,latency_us_ci95,corrupt_sessions,requests_per_s_samples,latency_p99_us_samples\n");
+    }
+
+    // keep the server's output out of the way
+    int devNull = open("/dev/null",O_WRONLY|O_CLOEXEC);
+    if (devNull == -1)
+    {
+        fatal_error("open");
+    }
+
+    // run the matrix
+    int port = basePort;
+    for (register int s = 0; s < numServers; ++s)
+    {
+        if (!isServerSelected[s]) continue;
+        for (register int w = 0; w < numWorkerCounts; ++w)
+        {
+            // start the server
+            char program[64];
+            char portArg[16];
+            char workersArg[16];
+            sprintf(program,"./%s.out",servers[s]);
+            sprintf(portArg,"%d",port);
+            sprintf(workersArg,"%ld",workerCounts[w]);
+            char* serverArgv[] = {program,(char*) "-p",portArg,(char*) "-n",workersArg,0};
+            pid_t server = spawn(serverArgv,devNull);
+            if (!wait_for_port(port))
+            {
+                fprintf(stderr,"[bench] %s did not start listening on port %d; skipping it\n",servers[s],port);
+                kill(-server,SIGKILL);
+                waitpid(server,0,0);
+                port++;
+                continue;
+            }
+
+            for (register int c = 0; c < numConnectionCounts; ++c)
+            {
+                for (register int l = 0; l < numPayloadLens; ++l)
+                {
+                    struct trial_t trial;
+                    if (warmupDuration > 0)
+                    {
+                        run_client(port,numClientProcesses,connectionCounts[c],payloadLens[l],requestsPerConnection,warmupDuration,&trial);
+                    }
+
+                    // run the trials
+                    double requestsRates[BENCH_MAX_TRIALS];
+                    double sessionsRates[BENCH_MAX_TRIALS];
+                    double latencies[BENCH_MAX_TRIALS];
+                    double p99Latencies[BENCH_MAX_TRIALS];
+                    unsigned long corruptSessions = 0;
+                    int numCompleted = 0;
+                    for (register int t = 0; t < numTrials; ++t)
+                    {
+                        if (!run_client(port,numClientProcesses,connectionCounts[c],payloadLens[l],requestsPerConnection,trialDuration,&trial))
+                        {
+                            fprintf(stderr,"[bench] %s workers %ld connections %ld payload %ld: trial %d reported no statistics; dropped\n",
+                                servers[s],workerCounts[w],connectionCounts[c],payloadLens[l],t+1);
+                            continue;
+                        }
+                        requestsRates[numCompleted] = trial.requestsRate;
+                        sessionsRates[numCompleted] = trial.sessionsRate;
+                        latencies[numCompleted] = trial.avgRequestLatency;
+                        p99Latencies[numCompleted] = trial.p99RequestLatency;
+                        corruptSessions += trial.corruptSessionCount;
+                        numCompleted++;
+                        fprintf(stderr,"[bench] %s workers %ld connections %ld payload %ld: trial %d/%d %.0f requests/s\n",
+                            servers[s],workerCounts[w],connectionCounts[c],payloadLens[l],t+1,numTrials,trial.requestsRate);
+                    }
+                    if (numCompleted == 0)
+                    {
+                        continue;
+                    }
+
+                    // write the configuration's line
+                    double requestsCi, sessionsCi, latencyCi;
+                    double requestsMean = confidence_interval(requestsRates,numCompleted,&requestsCi);
+                    double sessionsMean = confidence_interval(sessionsRates,numCompleted,&sessionsCi);
+                    double latencyMean = confidence_interval(latencies,numCompleted,&latencyCi);
+                    fprintf(csv,"%s,%ld,%ld,%ld,%d,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%lu,",
+                        servers[s],workerCounts[w],connectionCounts[c],payloadLens[l],numCompleted,
+                        requestsMean,requestsCi,sessionsMean,sessionsCi,latencyMean,latencyCi,corruptSessions);
+                    for (register int t = 0; t < numCompleted; ++t)
+                    {
+                        fprintf(csv,"%s%.1f",t == 0 ? "" : ";",requestsRates[t]);
+                    }
+                    fprintf(csv,",");
+                    for (register int t = 0; t < numCompleted; ++t)
+                    {
+                        fprintf(csv,"%s%.1f",t == 0 ? "" : ";",p99Latencies[t]);
+                    }
+                    fprintf(csv,"\n");
+                    fflush(csv);
+                }
+            }
+
+            // stop the server; it drains and exits on SIGTERM
+            kill(server,SIGTERM);
+            if (!reap(server,BENCH_STOP_TIMEOUT))
+            {
+                fprintf(stderr,"[bench] %s did not exit on SIGTERM; killed it\n",servers[s]);
+            }
+            port++;
+        }
+    }
+
+    fclose(csv);
+    close(devNull);
+    return EX_OK;
+}
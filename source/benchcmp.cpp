@@ -0,0 +1,651 @@
+/**
+ * benchmark comparison. reads a baseline and a candidate CSV file written by
+ *   bench.out, compares the trials of every configuration found in both with
+ *   a one-sided Mann-Whitney U test, and prints a regression report. exits
+ *   with 1 if requests/s or p99 latency got significantly worse by more than
+ *   a threshold, so it can gate a change.
+ *
+ * @sourceFile benchcmp.cpp
+ *
+ * @program    benchcmp.out
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       a configuration is a server, worker count, connection count
+ *   and payload size; when a file has several lines for one, the last wins.
+ */
+#include <ctype.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sysexits.h>
+
+/**
+ * most configurations read from one file.
+ */
+#define BENCHCMP_MAX_CONFIGS 1024
+
+/**
+ * most samples of one metric of a configuration; as many as bench.out runs
+ *   trials.
+ */
+#define BENCHCMP_MAX_SAMPLES 64
+
+/**
+ * most samples per side for which the exact distribution of U is used;
+ *   larger samples use the normal approximation.
+ */
+#define BENCHCMP_EXACT_SAMPLES 20
+
+/**
+ * length of the longest CSV line read.
+ */
+#define BENCHCMP_LINE_LEN 8192
+
+/**
+ * exit code when a regression is found.
+ */
+#define BENCHCMP_REGRESSION 1
+
+/**
+ * metrics compared, and which way is worse.
+ */
+enum metric_t
+{
+    METRIC_REQUESTS_RATE,   // requests/s; lower is worse
+    METRIC_P99_LATENCY,     // p99 request latency in us; higher is worse
+    METRIC_COUNT
+};
+
+/**
+ * CSV column, name printed in the report, and direction of each metric, in
+ *   the order of metric_t.
+ */
+static const struct { const char* column; const char* name; bool isHigherBetter; } metrics[METRIC_COUNT] =
+{
+    {"requests_per_s_samples","requests/s",true},
+    {"latency_p99_us_samples","p99 us",false},
+};
+
+/**
+ * trials of one configuration read from a CSV file.
+ */
+struct config_t
+{
+    char server[32];
+    long workers;
+    long connections;
+    long payload;
+    double samples[METRIC_COUNT][BENCHCMP_MAX_SAMPLES];
+    int numSamples[METRIC_COUNT];
+};
+
+/**
+ * prints the error message, then exits the program.
+ *
+ * @function   fatal_error
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  void fatal_error(const char* string)
+ *
+ * @param      string string to print before exiting the program
+ */
+void fatal_error(char const * string)
+{
+    fprintf(stderr,"%s: ",string);
+    perror(0);
+    exit(EX_OSERR);
+}
+
+/**
+ * splits the CSV line {line} into its fields, in place.
+ *
+ * @function   split_csv
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       bench.out never quotes fields, so neither does this.
+ *
+ * @signature  int split_csv(char* line, char** fields, int maxFields)
+ *
+ * @param      line line to split; modified.
+ * @param      fields set to the fields of the line.
+ * @param      maxFields most fields to split off.
+ *
+ * @return     number of fields.
+ */
+int split_csv(char* line, char** fields, int maxFields)
+{
+    line[strcspn(line,"\r\n")] = '\0';
+    int count = 0;
+    while (count < maxFields)
+    {
+        fields[count++] = line;
+        char* comma = strchr(line,',');
+        if (comma == 0)
+        {
+            break;
+        }
+        *comma = '\0';
+        line = comma+1;
+    }
+    return count;
+}
+
+/**
+ * parses a semicolon separated list of samples.
+ *
+ * @function   parse_samples
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       stops at the first value that is not a number.
+ *
+ * @signature  int parse_samples(const char* spec, double* samples)
+ *
+ * @param      spec list to parse, e.g. "1200.5;1187.0;1210.3".
+ * @param      samples set to the values of the list; BENCHCMP_MAX_SAMPLES
+ *   long.
+ *
+ * @return     number of samples parsed.
+ */
+int parse_samples(const char* spec, double* samples)
+{
+    int count = 0;
+    const char* cursor = spec;
+    while (count < BENCHCMP_MAX_SAMPLES)
+    {
+        char* parsedCursor;
+        double value = strtod(cursor,&parsedCursor);
+        if (parsedCursor == cursor)
+        {
+            break;
+        }
+        samples[count++] = value;
+        if (*parsedCursor != ';')
+        {
+            break;
+        }
+        cursor = parsedCursor+1;
+    }
+    return count;
+}
+
+/**
+ * reads the configurations of a CSV file written by bench.out.
+ *
+ * @function   read_configs
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       columns are found by the names in the header, so files of
+ *   older versions of bench.out are read as well; metrics whose column is
+ *   missing have no samples.
+ *
+ * @signature  int read_configs(const char* path, struct config_t* configs)
+ *
+ * @param      path path of the CSV file.
+ * @param      configs set to the configurations read;
+ *   BENCHCMP_MAX_CONFIGS long.
+ *
+ * @return     number of configurations read.
+ */
+int read_configs(const char* path, struct config_t* configs)
+{
+    FILE* file = fopen(path,"r");
+    if (file == 0)
+    {
+        fatal_error(path);
+    }
+
+    // find the columns by name
+    static char line[BENCHCMP_LINE_LEN];
+    char* fields[64];
+    if (fgets(line,sizeof(line),file) == 0)
+    {
+        fclose(file);
+        return 0;
+    }
+    int numColumns = split_csv(line,fields,64);
+    int serverColumn = -1, workersColumn = -1, connectionsColumn = -1, payloadColumn = -1;
+    int metricColumns[METRIC_COUNT];
+    for (register int m = 0; m < METRIC_COUNT; ++m)
+    {
+        metricColumns[m] = -1;
+    }
+    for (register int i = 0; i < numColumns; ++i)
+    {
+        if (strcmp(fields[i],"server") == 0) serverColumn = i;
+        else if (strcmp(fields[i],"workers") == 0) workersColumn = i;
+        else if (strcmp(fields[i],"connections") == 0) connectionsColumn = i;
+        else if (strcmp(fields[i],"payload") == 0) payloadColumn = i;
+        for (register int m = 0; m < METRIC_COUNT; ++m)
+        {
+            if (strcmp(fields[i],metrics[m].column) == 0) metricColumns[m] = i;
+        }
+    }
+    if (serverColumn == -1 || workersColumn == -1 || connectionsColumn == -1 || payloadColumn == -1)
+    {
+        fprintf(stderr,"%s: not a CSV file written by bench.out\n",path);
+        exit(EX_DATAERR);
+    }
+
+    // read a configuration from every line, replacing earlier lines of the
+    // same configuration
+    int numConfigs = 0;
+    while (fgets(line,sizeof(line),file) != 0)
+    {
+        int numFields = split_csv(line,fields,64);
+        if (numFields <= serverColumn || numFields <= workersColumn || numFields <= connectionsColumn || numFields <= payloadColumn)
+        {
+            continue;
+        }
+        struct config_t config;
+        memset(&config,0,sizeof(config));
+        snprintf(config.server,sizeof(config.server),"%s",fields[serverColumn]);
+        config.workers = strtol(fields[workersColumn],0,10);
+        config.connections = strtol(fields[connectionsColumn],0,10);
+        config.payload = strtol(fields[payloadColumn],0,10);
+        for (register int m = 0; m < METRIC_COUNT; ++m)
+        {
+            if (metricColumns[m] != -1 && metricColumns[m] < numFields)
+            {
+                config.numSamples[m] = parse_samples(fields[metricColumns[m]],config.samples[m]);
+            }
+        }
+
+        int index = 0;
+        while (index < numConfigs && (strcmp(configs[index].server,config.server) != 0 || configs[index].workers != config.workers ||
+            configs[index].connections != config.connections || configs[index].payload != config.payload))
+        {
+            index++;
+        }
+        if (index == BENCHCMP_MAX_CONFIGS)
+        {
+            fprintf(stderr,"%s: more than %d configurations; the rest are ignored\n",path,BENCHCMP_MAX_CONFIGS);
+            break;
+        }
+        configs[index] = config;
+        if (index == numConfigs) numConfigs++;
+    }
+    fclose(file);
+    return numConfigs;
+}
+
+/**
+ * comparator of doubles for qsort.
+ *
+ * @function   compare_doubles
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  int compare_doubles(const void* a, const void* b)
+ *
+ * @param      a first double.
+ * @param      b second double.
+ *
+ * @return     negative, 0 or positive as {a} is less than, equal to or
+ *   greater than {b}.
+ */
+int compare_doubles(const void* a, const void* b)
+{
+    double difference = *(const double*) a-*(const double*) b;
+    return difference < 0 ? -1 : difference > 0 ? 1 : 0;
+}
+
+/**
+ * returns the median of {samples}.
+ *
+ * @function   median
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  double median(const double* samples, int count)
+ *
+ * @param      samples samples; at least one.
+ * @param      count number of samples.
+ *
+ * @return     median of the samples.
+ */
+double median(const double* samples, int count)
+{
+    double sorted[BENCHCMP_MAX_SAMPLES];
+    memcpy(sorted,samples,sizeof(double)*count);
+    qsort(sorted,count,sizeof(double),compare_doubles);
+    return count%2 ? sorted[count/2] : (sorted[count/2-1]+sorted[count/2])/2;
+}
+
+/**
+ * returns the probability that the Mann-Whitney U statistic of two samples
+ *   of {m} and {n} values from the same distribution is {u} or less.
+ *
+ * @function   exact_u_cdf
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       counts the orderings of the two samples with each value of U,
+ *   using that the number of orderings of {m} and {n} values with U = u is
+ *   that of {m}-1 and {n} with U = u-{n}, plus that of {m} and {n}-1 with
+ *   U = u. only valid without ties.
+ *
+ * @signature  double exact_u_cdf(int m, int n, double u)
+ *
+ * @param      m size of the first sample; at most BENCHCMP_EXACT_SAMPLES.
+ * @param      n size of the second sample; at most BENCHCMP_EXACT_SAMPLES.
+ * @param      u value of U.
+ *
+ * @return     P(U <= {u}).
+ */
+double exact_u_cdf(int m, int n, double u)
+{
+    const int maxU = BENCHCMP_EXACT_SAMPLES*BENCHCMP_EXACT_SAMPLES;
+    static double counts[BENCHCMP_EXACT_SAMPLES+1][BENCHCMP_EXACT_SAMPLES+1][BENCHCMP_EXACT_SAMPLES*BENCHCMP_EXACT_SAMPLES+1];
+    for (register int i = 0; i <= m; ++i)
+    {
+        for (register int j = 0; j <= n; ++j)
+        {
+            for (register int k = 0; k <= maxU; ++k)
+            {
+                if (i == 0 || j == 0)
+                {
+                    counts[i][j][k] = k == 0 ? 1 : 0;
+                }
+                else
+                {
+                    counts[i][j][k] = (k >= j ? counts[i-1][j][k-j] : 0)+counts[i][j-1][k];
+                }
+            }
+        }
+    }
+    double below = 0, total = 0;
+    for (register int k = 0; k <= m*n; ++k)
+    {
+        total += counts[m][n][k];
+        if (k <= u) below += counts[m][n][k];
+    }
+    return below/total;
+}
+
+/**
+ * tests whether the {candidate} samples tend to be lower than the
+ *   {baseline} samples, with a one-sided Mann-Whitney U test.
+ *
+ * @function   mann_whitney_lower
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       U counts the pairs of a candidate and a baseline sample where
+ *   the candidate is greater, ties counting half. the p-value comes from the
+ *   exact distribution of U for small samples without ties, and from the
+ *   normal approximation, corrected for ties and continuity, otherwise.
+ *
+ * @signature  double mann_whitney_lower(const double* candidate, int m,
+ *   const double* baseline, int n)
+ *
+ * @param      candidate candidate samples.
+ * @param      m number of candidate samples.
+ * @param      baseline baseline samples.
+ * @param      n number of baseline samples.
+ *
+ * @return     p-value of the candidate being lower by chance alone.
+ */
+double mann_whitney_lower(const double* candidate, int m, const double* baseline, int n)
+{
+    double u = 0;
+    bool hasTies = false;
+    for (register int i = 0; i < m; ++i)
+    {
+        for (register int j = 0; j < n; ++j)
+        {
+            if (candidate[i] > baseline[j]) u += 1;
+            else if (candidate[i] == baseline[j]) { u += 0.5; hasTies = true; }
+        }
+    }
+    if (!hasTies && m <= BENCHCMP_EXACT_SAMPLES && n <= BENCHCMP_EXACT_SAMPLES)
+    {
+        return exact_u_cdf(m,n,u);
+    }
+
+    // normal approximation; the variance shrinks with every group of tied
+    // values across both samples
+    double pooled[2*BENCHCMP_MAX_SAMPLES];
+    memcpy(pooled,candidate,sizeof(double)*m);
+    memcpy(pooled+m,baseline,sizeof(double)*n);
+    int total = m+n;
+    qsort(pooled,total,sizeof(double),compare_doubles);
+    double tieSum = 0;
+    for (register int i = 0; i < total;)
+    {
+        int j = i;
+        while (j < total && pooled[j] == pooled[i]) j++;
+        double tied = j-i;
+        tieSum += tied*tied*tied-tied;
+        i = j;
+    }
+    double mean = (double) m*n/2;
+    double variance = (double) m*n/12*((total+1)-tieSum/((double) total*(total-1)));
+    if (variance <= 0)
+    {
+        return 1;
+    }
+    double z = (u-mean+0.5)/sqrt(variance);
+    return 0.5*erfc(-z/sqrt(2.0));
+}
+
+/**
+ * main entry point of the application.
+ *
+ * parses command line arguments, reads both CSV files, and prints a line per
+ *   configuration and metric comparing the candidate to the baseline.
+ *
+ * @function   main
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       a metric regressed if the candidate is worse with a p-value
+ *   below alpha, and its median is worse by more than the threshold. both are
+ *   needed: the test alone flags differences too small to matter, and the
+ *   threshold alone flags noise.
+ *
+ * @signature  int main (int argc, char* argv[])
+ *
+ * @param      argc number of command line arguments.
+ * @param      argv array of c-style strings.
+ *
+ * @return     EX_OK, or BENCHCMP_REGRESSION if any metric regressed.
+ */
+int main (int argc, char* argv[])
+{
+    // percent change of the median that counts as a regression
+    double threshold = 5;
+
+    // significance level of the test
+    double alpha = 0.05;
+
+    // parse command line arguments
+    {
+        int option;
+        while ((option = getopt(argc,argv,"t:a:")) != -1)
+        {
+            switch (option)
+            {
+            case 't':
+            case 'a':
+                {
+                    char* parsedCursor = optarg;
+                    double value = strtod(optarg,&parsedCursor);
+                    if (parsedCursor == optarg || value < 0 || (option == 'a' && value > 1))
+                    {
+                        fprintf(stderr,"invalid argument for option -%c\n",option);
+                        break;
+                    }
+                    if (option == 't') threshold = value;
+                    else alpha = value;
+                    break;
+                }
+            case '?':
+                {
+                    if (isprint(optopt))
+                    {
+                        fprintf(stderr,"unknown option \"-%c\".\n",optopt);
+                    }
+                    else
+                    {
+                        fprintf(stderr,"unknown option character \"%x\".\n",optopt);
+                    }
+                }
+            default:
+                {
+                    fprintf(stderr,"usage: %s [-t threshold %%] [-a alpha] baseline.csv candidate.csv\n",argv[0]);
+                    return EX_USAGE;
+                }
+            }
+        }
+        if (argc-optind != 2)
+        {
+            fprintf(stderr,"usage: %s [-t threshold %%] [-a alpha] baseline.csv candidate.csv\n",argv[0]);
+            return EX_USAGE;
+        }
+    }
+
+    static struct config_t baselines[BENCHCMP_MAX_CONFIGS];
+    static struct config_t candidates[BENCHCMP_MAX_CONFIGS];
+    int numBaselines = read_configs(argv[optind],baselines);
+    int numCandidates = read_configs(argv[optind+1],candidates);
+
+    printf("# baseline %s, candidate %s; regression past %.1f%% at p < %.3f\n",argv[optind],argv[optind+1],threshold,alpha);
+    printf("# %-10s %7s %11s %7s %-10s %12s %12s %8s %7s %s\n","server","workers","connections","payload","metric","baseline","candidate","change","p","verdict");
+    int numRegressions = 0;
+    int numCompared = 0;
+    for (register int c = 0; c < numCandidates; ++c)
+    {
+        const struct config_t* candidate = candidates+c;
+        const struct config_t* baseline = 0;
+        for (register int b = 0; b < numBaselines && baseline == 0; ++b)
+        {
+            if (strcmp(baselines[b].server,candidate->server) == 0 && baselines[b].workers == candidate->workers &&
+                baselines[b].connections == candidate->connections && baselines[b].payload == candidate->payload)
+            {
+                baseline = baselines+b;
+            }
+        }
+        if (baseline == 0)
+        {
+            printf("  %-10s %7ld %11ld %7ld not in the baseline\n",candidate->server,candidate->workers,candidate->connections,candidate->payload);
+            continue;
+        }
+
+        for (register int m = 0; m < METRIC_COUNT; ++m)
+        {
+            int numCandidateSamples = candidate->numSamples[m];
+            int numBaselineSamples = baseline->numSamples[m];
+            if (numCandidateSamples == 0 || numBaselineSamples == 0)
+            {
+                continue;
+            }
+            double baselineMedian = median(baseline->samples[m],numBaselineSamples);
+            double candidateMedian = median(candidate->samples[m],numCandidateSamples);
+            double change = baselineMedian != 0 ? 100*(candidateMedian-baselineMedian)/baselineMedian : 0;
+            double worsening = metrics[m].isHigherBetter ? -change : change;
+
+            // test in the direction that is worse for this metric
+            double p = metrics[m].isHigherBetter ?
+                mann_whitney_lower(candidate->samples[m],numCandidateSamples,baseline->samples[m],numBaselineSamples) :
+                mann_whitney_lower(baseline->samples[m],numBaselineSamples,candidate->samples[m],numCandidateSamples);
+            double pBetter = metrics[m].isHigherBetter ?
+                mann_whitney_lower(baseline->samples[m],numBaselineSamples,candidate->samples[m],numCandidateSamples) :
+                mann_whitney_lower(candidate->samples[m],numCandidateSamples,baseline->samples[m],numBaselineSamples);
+
+            const char* verdict = "same";
+            if (p < alpha && worsening > threshold)
+            {
+                verdict = "REGRESSION";
+                numRegressions++;
+            }
+            else if (pBetter < alpha && -worsening > threshold)
+            {
+                verdict = "improvement";
+                p = pBetter;
+            }
+            else if (numCandidateSamples < 3 || numBaselineSamples < 3)
+            {
+                verdict = "too few trials";
+            }
+            numCompared++;
+            printf("  %-10s %7ld %11ld %7ld %-10s %12.1f %12.1f %+7.1f%% %7.4f %s\n",
+                candidate->server,candidate->workers,candidate->connections,candidate->payload,metrics[m].name,
+                baselineMedian,candidateMedian,change,p,verdict);
+        }
+    }
+    printf("# %d comparisons, %d regressions\n",numCompared,numRegressions);
+    return numRegressions > 0 ? BENCHCMP_REGRESSION : EX_OK;
+}
@@ -0,0 +1,525 @@
+#include "coro_helper.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sysexits.h>
+#include <sys/mman.h>
+#include <sys/epoll.h>
+
+static void coro_trampoline();
+static void ready(struct coro_scheduler_t* scheduler, struct coro_t* coro);
+static void fatal_error(const char* errstr);
+
+/**
+ * scheduler running on the calling thread; 0 if none.
+ */
+static __thread struct coro_scheduler_t* runningScheduler = 0;
+
+/**
+ * initializes {scheduler}, with no coroutines.
+ *
+ * @function   coro_scheduler_init
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       a scheduler, and its coroutines, must only be run by one
+ *   thread.
+ *
+ * @signature  void coro_scheduler_init(struct coro_scheduler_t* scheduler,
+ *   size_t stackLen)
+ *
+ * @param      scheduler scheduler to initialize.
+ * @param      stackLen bytes of stack of each coroutine, not counting its
+ *   guard page; rounded up to whole pages.
+ */
+void coro_scheduler_init(struct coro_scheduler_t* scheduler, size_t stackLen)
+{
+    size_t pageLen = sysconf(_SC_PAGESIZE);
+    scheduler->epoll = epoll_create1(EPOLL_CLOEXEC);
+    if (scheduler->epoll == -1)
+    {
+        fatal_error("epoll_create1");
+    }
+    scheduler->stackLen = (stackLen+pageLen-1)/pageLen*pageLen;
+    scheduler->current = 0;
+    scheduler->readyHead = 0;
+    scheduler->readyTail = 0;
+    scheduler->freeList = 0;
+    scheduler->numCoros = 0;
+}
+
+/**
+ * frees the finished coroutines of {scheduler}, and closes its epoll.
+ *
+ * @function   coro_scheduler_destroy
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       coroutines that have not finished are not tracked, so their
+ *   stacks are not freed.
+ *
+ * @signature  void coro_scheduler_destroy(struct coro_scheduler_t* scheduler)
+ *
+ * @param      scheduler scheduler to destroy.
+ */
+void coro_scheduler_destroy(struct coro_scheduler_t* scheduler)
+{
+    size_t pageLen = sysconf(_SC_PAGESIZE);
+    while (scheduler->freeList != 0)
+    {
+        struct coro_t* coro = scheduler->freeList;
+        scheduler->freeList = coro->next;
+        munmap(coro->stack,scheduler->stackLen+pageLen);
+        free(coro);
+    }
+    close(scheduler->epoll);
+}
+
+/**
+ * starts a coroutine on {scheduler} that calls {routine} with {arg}.
+ *
+ * @function   coro_spawn
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the coroutine first runs the next time the scheduler runs. the
+ *   stack of a finished coroutine is reused if there is one; otherwise a new
+ *   one is mapped, with a PROT_NONE guard page below it, so a coroutine that
+ *   overflows its stack crashes instead of overwriting memory.
+ *
+ * @signature  void coro_spawn(struct coro_scheduler_t* scheduler,
+ *   void* (*routine)(void*), void* arg)
+ *
+ * @param      scheduler scheduler to run the coroutine on.
+ * @param      routine function to run as the coroutine.
+ * @param      arg argument to pass to {routine}.
+ */
+void coro_spawn(struct coro_scheduler_t* scheduler, void* (*routine)(void*), void* arg)
+{
+    size_t pageLen = sysconf(_SC_PAGESIZE);
+    struct coro_t* coro = scheduler->freeList;
+    if (coro != 0)
+    {
+        scheduler->freeList = coro->next;
+    }
+    else
+    {
+        coro = (struct coro_t*) malloc(sizeof(struct coro_t));
+        coro->stack = (char*) mmap(0,scheduler->stackLen+pageLen,PROT_READ|PROT_WRITE,
+            MAP_PRIVATE|MAP_ANONYMOUS|MAP_STACK|MAP_NORESERVE,-1,0);
+        if (coro->stack == MAP_FAILED)
+        {
+            fatal_error("mmap");
+        }
+        if (mprotect(coro->stack,pageLen,PROT_NONE) == -1)
+        {
+            fatal_error("mprotect");
+        }
+    }
+
+    coro->routine = routine;
+    coro->arg = arg;
+    coro->isDone = false;
+    if (getcontext(&coro->context) == -1)
+    {
+        fatal_error("getcontext");
+    }
+    coro->context.uc_stack.ss_sp = coro->stack;
+    coro->context.uc_stack.ss_size = scheduler->stackLen+pageLen;
+    coro->context.uc_link = &scheduler->context;
+    makecontext(&coro->context,coro_trampoline,0);
+
+    scheduler->numCoros++;
+    ready(scheduler,coro);
+}
+
+/**
+ * waits for the file descriptors the coroutines of {scheduler} wait for,
+ *   then resumes every coroutine that is ready, until each waits again or
+ *   finishes.
+ *
+ * @function   coro_run
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       does not wait if coroutines are ready already. to be called
+ *   in a loop by the thread that owns the scheduler; between calls, it may
+ *   spawn coroutines, and check why it was woken.
+ *
+ * @signature  int coro_run(struct coro_scheduler_t* scheduler, int timeout)
+ *
+ * @param      scheduler scheduler to run.
+ * @param      timeout milliseconds to wait for file descriptors at most; -1
+ *   to wait until one is ready.
+ *
+ * @return     number of coroutines that have not finished.
+ */
+int coro_run(struct coro_scheduler_t* scheduler, int timeout)
+{
+    runningScheduler = scheduler;
+
+    // wait for file descriptors
+    struct epoll_event events[CORO_EPOLL_QUEUE_LEN];
+    int eventCount = epoll_wait(scheduler->epoll,events,CORO_EPOLL_QUEUE_LEN,scheduler->readyHead != 0 ? 0 : timeout);
+    if (eventCount == -1)
+    {
+        if (errno != EINTR)
+        {
+            fatal_error("epoll_wait");
+        }
+        errno = 0;
+        eventCount = 0;
+    }
+    for (register int i = 0; i < eventCount; ++i)
+    {
+        if (events[i].data.ptr != 0)
+        {
+            ready(scheduler,(struct coro_t*) events[i].data.ptr);
+        }
+    }
+
+    // resume the ready coroutines; those that become ready meanwhile wait for
+    // the next call
+    struct coro_t* coro = scheduler->readyHead;
+    scheduler->readyHead = scheduler->readyTail = 0;
+    while (coro != 0)
+    {
+        struct coro_t* next = coro->next;
+        scheduler->current = coro;
+        if (swapcontext(&scheduler->context,&coro->context) == -1)
+        {
+            fatal_error("swapcontext");
+        }
+        scheduler->current = 0;
+        if (coro->isDone)
+        {
+            scheduler->numCoros--;
+            coro->next = scheduler->freeList;
+            scheduler->freeList = coro;
+        }
+        coro = next;
+    }
+    return scheduler->numCoros;
+}
+
+/**
+ * suspends the calling coroutine until {fd} is ready for {events}.
+ *
+ * @function   coro_wait
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the file descriptor is armed with EPOLLONESHOT, and stays in
+ *   the epoll until it is closed, so waiting on it again only costs an
+ *   EPOLL_CTL_MOD. only one coroutine of a scheduler may wait on a file
+ *   descriptor at a time.
+ *
+ * @signature  void coro_wait(int fd, unsigned int events)
+ *
+ * @param      fd file descriptor to wait for.
+ * @param      events epoll events to wait for, e.g. EPOLLIN.
+ */
+void coro_wait(int fd, unsigned int events)
+{
+    struct coro_scheduler_t* scheduler = runningScheduler;
+    struct coro_t* coro = scheduler->current;
+
+    struct epoll_event event = epoll_event();
+    event.events = events|EPOLLONESHOT;
+    event.data.ptr = coro;
+    if (epoll_ctl(scheduler->epoll,EPOLL_CTL_MOD,fd,&event) == -1)
+    {
+        if (errno != ENOENT || epoll_ctl(scheduler->epoll,EPOLL_CTL_ADD,fd,&event) == -1)
+        {
+            fatal_error("epoll_ctl");
+        }
+        errno = 0;
+    }
+    if (swapcontext(&coro->context,&scheduler->context) == -1)
+    {
+        fatal_error("swapcontext");
+    }
+}
+
+/**
+ * returns true if called from a coroutine.
+ *
+ * @function   coro_is_running
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  bool coro_is_running()
+ *
+ * @return     true if called from a coroutine.
+ */
+bool coro_is_running()
+{
+    return runningScheduler != 0 && runningScheduler->current != 0;
+}
+
+/**
+ * accepts a connection like accept does on a blocking socket.
+ *
+ * @function   coro_accept
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       in a coroutine, {fd} must be non-blocking; the coroutine waits
+ *   instead of the thread, and the connection accepted is non-blocking too.
+ *   outside of a coroutine, it is plain accept.
+ *
+ * @signature  int coro_accept(int fd, struct sockaddr* addr,
+ *   socklen_t* addrLen)
+ *
+ * @param      fd listening socket.
+ * @param      addr set to the address of the peer; may be 0.
+ * @param      addrLen length of {addr}; may be 0.
+ *
+ * @return     socket of the connection accepted; -1 on failure.
+ */
+int coro_accept(int fd, struct sockaddr* addr, socklen_t* addrLen)
+{
+    if (!coro_is_running())
+    {
+        return accept(fd,addr,addrLen);
+    }
+    while (true)
+    {
+        int clntSock = accept4(fd,addr,addrLen,SOCK_NONBLOCK);
+        if (clntSock != -1 || (errno != EAGAIN && errno != EWOULDBLOCK))
+        {
+            return clntSock;
+        }
+        errno = 0;
+        coro_wait(fd,EPOLLIN);
+    }
+}
+
+/**
+ * receives bytes like recv does on a blocking socket.
+ *
+ * @function   coro_recv
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       in a coroutine, {fd} must be non-blocking; the coroutine waits
+ *   instead of the thread. outside of a coroutine, it is plain recv.
+ *
+ * @signature  ssize_t coro_recv(int fd, void* buf, size_t len, int flags)
+ *
+ * @param      fd socket to receive from.
+ * @param      buf buffer to receive into.
+ * @param      len length of {buf}.
+ * @param      flags flags of recv.
+ *
+ * @return     bytes received; 0 once the peer has shut down; -1 on failure.
+ */
+ssize_t coro_recv(int fd, void* buf, size_t len, int flags)
+{
+    if (!coro_is_running())
+    {
+        return recv(fd,buf,len,flags);
+    }
+    while (true)
+    {
+        ssize_t bytesRead = recv(fd,buf,len,flags);
+        if (bytesRead != -1 || (errno != EAGAIN && errno != EWOULDBLOCK))
+        {
+            return bytesRead;
+        }
+        errno = 0;
+        coro_wait(fd,EPOLLIN);
+    }
+}
+
+/**
+ * sends bytes like send does on a blocking socket: all of them, unless the
+ *   connection fails.
+ *
+ * @function   coro_send
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       in a coroutine, {fd} must be non-blocking; the coroutine waits
+ *   for room in the send buffer instead of the thread. outside of a
+ *   coroutine, it is plain send.
+ *
+ * @signature  ssize_t coro_send(int fd, const void* buf, size_t len,
+ *   int flags)
+ *
+ * @param      fd socket to send on.
+ * @param      buf bytes to send.
+ * @param      len number of bytes to send.
+ * @param      flags flags of send.
+ *
+ * @return     {len}; -1 on failure.
+ */
+ssize_t coro_send(int fd, const void* buf, size_t len, int flags)
+{
+    if (!coro_is_running())
+    {
+        return send(fd,buf,len,flags);
+    }
+    size_t bytesSent = 0;
+    while (bytesSent < len)
+    {
+        ssize_t result = send(fd,(const char*) buf+bytesSent,len-bytesSent,flags);
+        if (result == -1)
+        {
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+                return -1;
+            }
+            errno = 0;
+            coro_wait(fd,EPOLLOUT);
+            continue;
+        }
+        bytesSent += result;
+    }
+    return len;
+}
+
+/**
+ * entry point of every coroutine; runs its routine, and marks it finished.
+ *
+ * @function   coro_trampoline
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       returning switches to the scheduler through uc_link. the
+ *   coroutine is found through the scheduler, because makecontext only
+ *   passes int arguments portably.
+ *
+ * @signature  static void coro_trampoline()
+ */
+static void coro_trampoline()
+{
+    struct coro_t* coro = runningScheduler->current;
+    coro->routine(coro->arg);
+    coro->isDone = true;
+}
+
+/**
+ * appends {coro} to the ready queue of {scheduler}.
+ *
+ * @function   ready
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  static void ready(struct coro_scheduler_t* scheduler,
+ *   struct coro_t* coro)
+ *
+ * @param      scheduler scheduler to resume the coroutine.
+ * @param      coro coroutine to resume.
+ */
+static void ready(struct coro_scheduler_t* scheduler, struct coro_t* coro)
+{
+    coro->next = 0;
+    if (scheduler->readyTail != 0)
+    {
+        scheduler->readyTail->next = coro;
+    }
+    else
+    {
+        scheduler->readyHead = coro;
+    }
+    scheduler->readyTail = coro;
+}
+
+/**
+ * prints the error message, then exits the program.
+ *
+ * @function   fatal_error
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  static void fatal_error(const char* errstr)
+ *
+ * @param      errstr string to print before exiting the program
+ */
+static void fatal_error(const char* errstr)
+{
+    fprintf(stderr,"%s: ",errstr);
+    perror(0);
+    exit(EX_OSERR);
+}
@@ -0,0 +1,61 @@
+#ifndef _CORO_HELPER_H_
+#define _CORO_HELPER_H_
+
+#include <stddef.h>
+#include <ucontext.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+
+/**
+ * default bytes of stack of a coroutine, not counting its guard page. a
+ *   coroutine's stack is only backed by memory as far as it is touched.
+ */
+#define CORO_DEFAULT_STACK_LEN 65536
+
+/**
+ * size of events array passed to epoll_wait by a scheduler.
+ */
+#define CORO_EPOLL_QUEUE_LEN 256
+
+/**
+ * a stackful coroutine.
+ */
+struct coro_t
+{
+    ucontext_t context;
+    char* stack;                    // mmap'd; its lowest page is the guard page
+    void* (*routine)(void*);
+    void* arg;
+    bool isDone;
+    struct coro_t* next;            // next in the ready queue or free list
+};
+
+/**
+ * runs the coroutines of one thread. a coroutine runs until it waits for a
+ *   file descriptor, which switches back to the scheduler; the scheduler
+ *   waits for the file descriptors with epoll, and resumes their coroutines
+ *   once they are ready.
+ */
+struct coro_scheduler_t
+{
+    ucontext_t context;             // context of the thread running the scheduler
+    int epoll;                      // events with a null data.ptr only wake it
+    size_t stackLen;
+    struct coro_t* current;         // coroutine running; 0 if none
+    struct coro_t* readyHead;       // coroutines to resume, in order
+    struct coro_t* readyTail;
+    struct coro_t* freeList;        // finished coroutines; reused with their stacks
+    int numCoros;                   // coroutines started and not finished
+};
+
+void coro_scheduler_init(struct coro_scheduler_t* scheduler, size_t stackLen);
+void coro_scheduler_destroy(struct coro_scheduler_t* scheduler);
+void coro_spawn(struct coro_scheduler_t* scheduler, void* (*routine)(void*), void* arg);
+int coro_run(struct coro_scheduler_t* scheduler, int timeout);
+void coro_wait(int fd, unsigned int events);
+bool coro_is_running();
+int coro_accept(int fd, struct sockaddr* addr, socklen_t* addrLen);
+ssize_t coro_recv(int fd, void* buf, size_t len, int flags);
+ssize_t coro_send(int fd, const void* buf, size_t len, int flags);
+
+#endif
@@ -0,0 +1,312 @@
+/**
+ * implementation of the echo server written with C++20 coroutines.
+ *
+ * @sourceFile coro_svr.cpp
+ *
+ * @program    coro_svr.out
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the echo loop of epoll_svr, written as straight-line code that
+ *   awaits its sockets; see async_helper.h.
+ */
+#include <ctype.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sysexits.h>
+#include "net_helper.h"
+#include "async_helper.h"
+
+/**
+ * size of buffer used to read bytes into from TCP/IP sockets.
+ */
+#define ECHO_BUFFER_LEN 1024
+
+/**
+ * prints the error message, then exits the program.
+ *
+ * @function   fatal_error
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  void fatal_error(const char* string)
+ *
+ * @param      string string to print before exiting the program
+ */
+void fatal_error(char const * string)
+{
+    fprintf(stderr,"%s: ",string);
+    perror(0);
+    exit(EX_OSERR);
+}
+
+/**
+ * echoes what the connection sends back to it, until it is closed.
+ *
+ * @function   echo_session
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the buffer lives in the coroutine's frame, so each connection
+ *   has its own; the frame is pooled by the reactor.
+ *
+ * @signature  async_task_t echo_session(int fd)
+ *
+ * @param      fd connected, non-blocking socket; closed once the session
+ *   ends.
+ *
+ * @return     task of the session.
+ */
+async_task_t echo_session(int fd)
+{
+    async_socket_t socket(fd);
+    char buf[ECHO_BUFFER_LEN];
+    ssize_t bytesRead;
+    while ((bytesRead = co_await socket.read(buf,ECHO_BUFFER_LEN)) > 0)
+    {
+        if (co_await socket.write(buf,bytesRead) == -1)
+        {
+            break;
+        }
+    }
+}
+
+/**
+ * accepts connections from the passed server socket, and starts an echo
+ *   session for each, until application termination.
+ *
+ * @function   accept_loop
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       a session runs until it first waits before the next connection
+ *   is accepted.
+ *
+ * @signature  async_task_t accept_loop(int serverSocket)
+ *
+ * @param      serverSocket non-blocking server socket, shared by every
+ *   thread.
+ *
+ * @return     task of the loop.
+ */
+async_task_t accept_loop(int serverSocket)
+{
+    async_listener_t listener(serverSocket);
+    while (true)
+    {
+        int newSocket = co_await listener.accept();
+        if (newSocket == -1)
+        {
+            // the connection was reset before it was accepted
+            if (errno == ECONNABORTED)
+            {
+                continue;
+            }
+            fatal_error("accept");
+        }
+        apply_sockopt_profile(newSocket);
+        async_spawn(echo_session(newSocket));
+    }
+}
+
+/**
+ * runs a reactor on the thread, which accepts connections and echoes them.
+ *
+ * @function   reactor_routine
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  void* reactor_routine(void* arg)
+ *
+ * @param      arg pointer to the server socket.
+ *
+ * @return     nothing; the accept loop never finishes.
+ */
+void* reactor_routine(void* arg)
+{
+    int serverSocket = *(int*) arg;
+
+    // the reactor is big because of its events array; keep it off the stack
+    struct async_reactor_t* reactor = new async_reactor_t;
+    async_reactor_init(reactor);
+    async_spawn(accept_loop(serverSocket));
+    async_reactor_run(reactor);
+    async_reactor_destroy(reactor);
+    delete reactor;
+    return 0;
+}
+
+/**
+ * main entry point of the application.
+ *
+ * parses command line arguments, then creates the server socket, and then
+ *   starts reactor threads to accept and service new connections until
+ *   application termination.
+ *
+ * @function   main
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  int main (int argc, char* argv[])
+ *
+ * @param      argc number of command line arguments.
+ * @param      argv array of c-style strings.
+ *
+ * @return     exit code of the application.
+ */
+int main (int argc, char* argv[])
+{
+    // file descriptor to a server socket
+    static int serverSocket;
+
+    // port for server socket to listen on
+    int listeningPort;
+
+    // number of reactor threads to create to serve connections
+    int numThreads;
+
+    // parse command line arguments
+    {
+        int option;
+        int portInitialized = false;
+        int numThreadsInitialized = false;
+        while ((option = getopt(argc,argv,"p:n:O:")) != -1)
+        {
+            switch (option)
+            {
+            case 'p':
+                {
+                    char* parsedCursor = optarg;
+                    listeningPort = (int) strtol(optarg,&parsedCursor,10);
+                    if (parsedCursor == optarg)
+                    {
+                        fprintf(stderr,"invalid argument for option -%c\n",option);
+                    }
+                    else
+                    {
+                        portInitialized = true;
+                    }
+                    break;
+                }
+            case 'n':
+                {
+                    char* parsedCursor = optarg;
+                    numThreads = (int) strtol(optarg,&parsedCursor,10);
+                    if (parsedCursor == optarg || numThreads < 1)
+                    {
+                        fprintf(stderr,"invalid argument for option -%c\n",option);
+                    }
+                    else
+                    {
+                        numThreadsInitialized = true;
+                    }
+                    break;
+                }
+            case 'O':
+                {
+                    struct sockopt_profile_t profile;
+                    if (!parse_sockopt_profile(optarg,&profile))
+                    {
+                        fprintf(stderr,"invalid argument for option -%c\n",option);
+                    }
+                    else
+                    {
+                        set_sockopt_profile(&profile);
+                    }
+                    break;
+                }
+            case '?':
+                {
+                    if (isprint(optopt))
+                    {
+                        fprintf(stderr,"unknown option \"-%c\".\n",optopt);
+                    }
+                    else
+                    {
+                        fprintf(stderr,"unknown option character \"%x\".\n",optopt);
+                    }
+                }
+                [[fallthrough]];
+            default:
+                {
+                    fatal_error("");
+                }
+            }
+        }
+
+        // print usage and abort if not all required arguments were provided
+        if (!portInitialized || !numThreadsInitialized)
+        {
+            fprintf(stderr,"usage: %s [-p server listening port] [-n number of reactor threads] [-O socket options, e.g. nodelay,quickack,sndbuf=N]\n",argv[0]);
+            return EX_USAGE;
+        }
+    }
+
+    // create server socket
+    serverSocket = make_tcp_server_socket(listeningPort,true).fd;
+    if (serverSocket == -1)
+    {
+        fatal_error("socket");
+    }
+
+    // start the reactor threads, each with its own epoll
+    pthread_t* threads = new pthread_t[numThreads];
+    for (int i = 0; i < numThreads; ++i)
+    {
+        if (pthread_create(threads+i,0,reactor_routine,&serverSocket) != 0)
+        {
+            fatal_error("pthread_create");
+        }
+    }
+    for (int i = 0; i < numThreads; ++i)
+    {
+        pthread_join(threads[i],0);
+    }
+    delete[] threads;
+    return EX_OK;
+}
@@ -0,0 +1,122 @@
+#include "cycle_helper.h"
+
+#include <time.h>
+#include <unistd.h>
+
+#ifdef CYCLE_PROBES
+
+/**
+ * cycles spent in each phase by each thread.
+ */
+__thread struct cycle_counters_t cycleCounters;
+
+/**
+ * names of the phases, as printed by cycle_probe_dump.
+ */
+static const char* phaseNames[CYCLE_PHASE_COUNT] =
+{
+    "epoll_wait",
+    "epoll_ctl",
+    "accept",
+    "fcntl",
+    "sockopt",
+    "connect",
+    "recv",
+    "send",
+    "close",
+};
+
+static double cycles_per_nanosecond();
+
+#endif
+
+/**
+ * prints the number of calls, and the mean, p50, p99, p99.9 and maximum
+ *   cycles per call of every phase timed by the calling thread.
+ *
+ * @function   cycle_probe_dump
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the counters are not reset. the mean is also given in
+ *   nanoseconds, using a time stamp counter rate measured against the
+ *   monotonic clock. when the program is built without cycle probes, prints
+ *   a note saying so instead.
+ *
+ * @signature  void cycle_probe_dump(FILE* file, const char* label)
+ *
+ * @param      file file to print to.
+ * @param      label label to print before the counters, e.g. "worker 0".
+ */
+void cycle_probe_dump(FILE* file, const char* label)
+{
+#ifdef CYCLE_PROBES
+    double rate = cycles_per_nanosecond();
+    char report[CYCLE_PHASE_COUNT*128+128];
+    int len = snprintf(report,sizeof(report),"[%d] %s cycles per call (%.2f cycles/ns):\n",getpid(),label,rate);
+    for (register int i = 0; i < CYCLE_PHASE_COUNT; ++i)
+    {
+        const struct histogram_t* histogram = &cycleCounters.histograms[i];
+        if (histogram->count == 0) continue;
+        double mean = (double) cycleCounters.totals[i]/histogram->count;
+        len += snprintf(report+len,sizeof(report)-len,
+            "    %-10s calls %10lu  mean %9.0f (%7.0f ns)  p50 %9lu  p99 %9lu  p99.9 %9lu  max %9lu\n",
+            phaseNames[i],histogram->count,mean,mean/rate,
+            histogram_percentile(histogram,50),histogram_percentile(histogram,99),
+            histogram_percentile(histogram,99.9),histogram->max);
+    }
+    fputs(report,file);
+    fflush(file);
+#else
+    fprintf(file,"[%d] %s: cycle probes are not compiled in; rebuild with \"make PROBES=1\"\n",getpid(),label);
+#endif
+}
+
+#ifdef CYCLE_PROBES
+
+/**
+ * measures how many time stamp counter ticks make a nanosecond, over 10 ms of
+ *   the monotonic clock.
+ *
+ * @function   cycles_per_nanosecond
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       measured once, on the first call.
+ *
+ * @signature  static double cycles_per_nanosecond()
+ *
+ * @return     time stamp counter ticks per nanosecond.
+ */
+static double cycles_per_nanosecond()
+{
+    static double rate = 0;
+    if (rate > 0) return rate;
+
+    struct timespec start;
+    struct timespec end;
+    struct timespec sleep = {0,10000000};
+    clock_gettime(CLOCK_MONOTONIC,&start);
+    unsigned long long startCycles = cycle_probe_now();
+    nanosleep(&sleep,0);
+    clock_gettime(CLOCK_MONOTONIC,&end);
+    unsigned long long endCycles = cycle_probe_now();
+
+    double elapsed = (end.tv_sec-start.tv_sec)*1e9+(end.tv_nsec-start.tv_nsec);
+    rate = (endCycles-startCycles)/elapsed;
+    return rate;
+}
+
+#endif
@@ -0,0 +1,98 @@
+#ifndef _CYCLE_HELPER_H_
+#define _CYCLE_HELPER_H_
+
+#include <stdio.h>
+#include "histogram_helper.h"
+
+/**
+ * system call sites of the event loops that are timed by cycle probes.
+ */
+enum cycle_phase_t
+{
+    CYCLE_EPOLL_WAIT,
+    CYCLE_EPOLL_CTL,
+    CYCLE_ACCEPT,
+    CYCLE_FCNTL,
+    CYCLE_SOCKOPT,
+    CYCLE_CONNECT,
+    CYCLE_RECV,
+    CYCLE_SEND,
+    CYCLE_CLOSE,
+    CYCLE_PHASE_COUNT
+};
+
+void cycle_probe_dump(FILE* file, const char* label);
+
+#ifdef CYCLE_PROBES
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <time.h>
+#endif
+
+/**
+ * cycles spent in each phase by the calling thread.
+ */
+struct cycle_counters_t
+{
+    struct histogram_t histograms[CYCLE_PHASE_COUNT];
+    unsigned long long totals[CYCLE_PHASE_COUNT];
+};
+
+extern __thread struct cycle_counters_t cycleCounters;
+
+/**
+ * returns the time stamp counter; nanoseconds where there is none.
+ */
+inline unsigned long long cycle_probe_now()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC,&now);
+    return (unsigned long long) now.tv_sec*1000000000ULL+now.tv_nsec;
+#endif
+}
+
+/**
+ * counts {cycles} spent in {phase} by the calling thread.
+ */
+inline void cycle_probe_record(int phase, unsigned long long cycles)
+{
+    histogram_record(&cycleCounters.histograms[phase],cycles);
+    cycleCounters.totals[phase] += cycles;
+}
+
+/**
+ * evaluates {expr}, counts the cycles it took in {phase}, and yields its
+ *   value. rdtsc does not serialize, so calls shorter than a few hundred
+ *   cycles are only roughly measured; system calls are not.
+ */
+#define CYCLE_PROBE(phase,expr) ({ \
+    unsigned long long cycleProbeStart = cycle_probe_now(); \
+    __typeof__(expr) cycleProbeResult = (expr); \
+    cycle_probe_record(phase,cycle_probe_now()-cycleProbeStart); \
+    cycleProbeResult; })
+
+/**
+ * runs {statement}, and counts the cycles it took in {phase}.
+ */
+#define CYCLE_PROBE_STMT(phase,statement) do { \
+    unsigned long long cycleProbeStart = cycle_probe_now(); \
+    statement; \
+    cycle_probe_record(phase,cycle_probe_now()-cycleProbeStart); } while (0)
+
+#else
+
+/**
+ * cycle probes compile to the bare expression or statement unless the
+ *   program is built with -DCYCLE_PROBES ("make PROBES=1").
+ */
+#define CYCLE_PROBE(phase,expr) (expr)
+#define CYCLE_PROBE_STMT(phase,statement) do { statement; } while (0)
+
+#endif
+
+#endif
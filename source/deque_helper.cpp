@@ -0,0 +1,182 @@
+#include "deque_helper.h"
+
+#include <stdlib.h>
+
+static struct deque_buffer_t* make_buffer(long len, struct deque_buffer_t* previous);
+
+/**
+ * initializes {deque} as an empty deque.
+ *
+ * @function   deque_init
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       to be called before the owner and thieves start.
+ *
+ * @signature  void deque_init(struct deque_t* deque)
+ *
+ * @param      deque deque to initialize.
+ */
+void deque_init(struct deque_t* deque)
+{
+    deque->top = 0;
+    deque->bottom = 0;
+    deque->buffer = make_buffer(DEQUE_INITIAL_LEN,0);
+}
+
+/**
+ * frees the buffers of {deque}.
+ *
+ * @function   deque_destroy
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       to be called once the owner and thieves have stopped.
+ *
+ * @signature  void deque_destroy(struct deque_t* deque)
+ *
+ * @param      deque deque to destroy.
+ */
+void deque_destroy(struct deque_t* deque)
+{
+    struct deque_buffer_t* buffer = deque->buffer;
+    while (buffer != 0)
+    {
+        struct deque_buffer_t* previous = buffer->previous;
+        free(buffer->tasks);
+        free(buffer);
+        buffer = previous;
+    }
+    deque->buffer = 0;
+}
+
+/**
+ * pushes {task} onto the bottom of {deque}.
+ *
+ * @function   deque_push
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       only the owner of the deque may push. the task is written
+ *   before bottom is released, so a thief that sees the new bottom sees the
+ *   task. when the buffer is full, it is replaced by one twice as long.
+ *
+ * @signature  void deque_push(struct deque_t* deque, long task)
+ *
+ * @param      deque deque to push onto.
+ * @param      task task to push.
+ */
+void deque_push(struct deque_t* deque, long task)
+{
+    long bottom = __atomic_load_n(&deque->bottom,__ATOMIC_RELAXED);
+    long top = __atomic_load_n(&deque->top,__ATOMIC_ACQUIRE);
+    struct deque_buffer_t* buffer = __atomic_load_n(&deque->buffer,__ATOMIC_RELAXED);
+    if (bottom-top > buffer->len-1)
+    {
+        struct deque_buffer_t* grown = make_buffer(buffer->len*2,buffer);
+        for (register long i = top; i < bottom; ++i)
+        {
+            grown->tasks[i&(grown->len-1)] = buffer->tasks[i&(buffer->len-1)];
+        }
+        __atomic_store_n(&deque->buffer,grown,__ATOMIC_RELEASE);
+        buffer = grown;
+    }
+    __atomic_store_n(&buffer->tasks[bottom&(buffer->len-1)],task,__ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    __atomic_store_n(&deque->bottom,bottom+1,__ATOMIC_RELAXED);
+}
+
+/**
+ * steals the task at the top of {deque}.
+ *
+ * @function   deque_steal
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       any thread may steal. a thief that loses the race for the top
+ *   task to another thief tries again for the next one, so false is only
+ *   returned when the deque was seen empty.
+ *
+ * @signature  bool deque_steal(struct deque_t* deque, long* task)
+ *
+ * @param      deque deque to steal from.
+ * @param      task set to the task stolen.
+ *
+ * @return     true if a task was stolen; false if the deque is empty.
+ */
+bool deque_steal(struct deque_t* deque, long* task)
+{
+    while (true)
+    {
+        long top = __atomic_load_n(&deque->top,__ATOMIC_ACQUIRE);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        long bottom = __atomic_load_n(&deque->bottom,__ATOMIC_ACQUIRE);
+        if (top >= bottom)
+        {
+            return false;
+        }
+        struct deque_buffer_t* buffer = __atomic_load_n(&deque->buffer,__ATOMIC_ACQUIRE);
+        long stolen = __atomic_load_n(&buffer->tasks[top&(buffer->len-1)],__ATOMIC_RELAXED);
+        if (__atomic_compare_exchange_n(&deque->top,&top,top+1,false,__ATOMIC_SEQ_CST,__ATOMIC_RELAXED))
+        {
+            *task = stolen;
+            return true;
+        }
+    }
+}
+
+/**
+ * allocates a buffer of {len} tasks.
+ *
+ * @function   make_buffer
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  static struct deque_buffer_t* make_buffer(long len,
+ *   struct deque_buffer_t* previous)
+ *
+ * @param      len number of tasks the buffer holds; a power of 2.
+ * @param      previous buffer the new one replaces; 0 if none.
+ *
+ * @return     the new buffer.
+ */
+static struct deque_buffer_t* make_buffer(long len, struct deque_buffer_t* previous)
+{
+    struct deque_buffer_t* buffer = (struct deque_buffer_t*) malloc(sizeof(struct deque_buffer_t));
+    buffer->len = len;
+    buffer->tasks = (long*) malloc(sizeof(long)*len);
+    buffer->previous = previous;
+    return buffer;
+}
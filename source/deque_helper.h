@@ -0,0 +1,44 @@
+#ifndef _DEQUE_HELPER_H_
+#define _DEQUE_HELPER_H_
+
+/**
+ * number of tasks a deque holds before it first grows.
+ */
+#define DEQUE_INITIAL_LEN 256
+
+/**
+ * size of a cache line; the ends of a deque get a line each, so the owner
+ *   pushing and the thieves stealing do not contend on the same line.
+ */
+#define DEQUE_CACHE_LINE_LEN 64
+
+/**
+ * circular buffer of a deque. grown buffers are kept until the deque is
+ *   destroyed, because a thief may still be reading from one.
+ */
+struct deque_buffer_t
+{
+    long len;                           // a power of 2
+    long* tasks;
+    struct deque_buffer_t* previous;    // buffer this one replaced
+};
+
+/**
+ * Chase-Lev work-stealing deque of tasks. the owner thread pushes tasks onto
+ *   the bottom, and any thread steals them off the top. no locks are taken;
+ *   thieves racing for the same task settle it with a compare and swap on
+ *   top.
+ */
+struct deque_t
+{
+    alignas(DEQUE_CACHE_LINE_LEN) long top;     // index of the next task to steal
+    alignas(DEQUE_CACHE_LINE_LEN) long bottom;  // index the next task is pushed at
+    struct deque_buffer_t* buffer;
+};
+
+void deque_init(struct deque_t* deque);
+void deque_destroy(struct deque_t* deque);
+void deque_push(struct deque_t* deque, long task);
+bool deque_steal(struct deque_t* deque, long* task);
+
+#endif
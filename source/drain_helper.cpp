@@ -0,0 +1,261 @@
+#include "drain_helper.h"
+
+#include <time.h>
+#include <stdio.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+#include <linux/sockios.h>
+
+/**
+ * initializes {drain} to track connections, with a table entry for every file
+ *   descriptor the process may open.
+ *
+ * @function   drain_init
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  void drain_init(struct drain_t* drain)
+ *
+ * @param      drain connection tracker to initialize.
+ */
+void drain_init(struct drain_t* drain)
+{
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE,&limit) == -1 || limit.rlim_cur == RLIM_INFINITY)
+    {
+        limit.rlim_cur = 65536;
+    }
+    drain->tableLen = (int) limit.rlim_cur;
+    drain->lastActiveTimes = (long*) calloc(drain->tableLen,sizeof(long));
+    drain->maxFd = -1;
+    drain->numConnections = 0;
+    drain->numHalfClosed = 0;
+    drain->startTime = 0;
+    drain->deadline = 0;
+    drain->nextReportTime = 0;
+}
+
+/**
+ * starts tracking the newly accepted connection {fd}.
+ *
+ * @function   drain_open
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  void drain_open(struct drain_t* drain, int fd)
+ *
+ * @param      drain connection tracker.
+ * @param      fd socket of the connection.
+ */
+void drain_open(struct drain_t* drain, int fd)
+{
+    __atomic_add_fetch(&drain->numConnections,1,__ATOMIC_RELAXED);
+    if (fd >= drain->tableLen) return;
+
+    __atomic_store_n(&drain->lastActiveTimes[fd],drain_current_time(),__ATOMIC_RELAXED);
+    int maxFd = __atomic_load_n(&drain->maxFd,__ATOMIC_RELAXED);
+    while (fd > maxFd && !__atomic_compare_exchange_n(&drain->maxFd,&maxFd,fd,true,__ATOMIC_RELAXED,__ATOMIC_RELAXED));
+}
+
+/**
+ * stops tracking the connection {fd}; called just before it is closed.
+ *
+ * @function   drain_close
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  void drain_close(struct drain_t* drain, int fd)
+ *
+ * @param      drain connection tracker.
+ * @param      fd socket of the connection.
+ */
+void drain_close(struct drain_t* drain, int fd)
+{
+    if (fd < drain->tableLen)
+    {
+        __atomic_store_n(&drain->lastActiveTimes[fd],0,__ATOMIC_RELAXED);
+    }
+    __atomic_sub_fetch(&drain->numConnections,1,__ATOMIC_RELAXED);
+}
+
+/**
+ * starts draining the tracked connections. the caller must have stopped
+ *   accepting new connections already.
+ *
+ * @function   drain_start
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       every open connection gets DRAIN_IDLE_TIME from now to show it
+ *   is busy before it is half-closed. SIGPIPE is ignored from now on, because
+ *   a client may still send to a connection after it has been half-closed.
+ *
+ * @signature  void drain_start(struct drain_t* drain, long timeout)
+ *
+ * @param      drain connection tracker.
+ * @param      timeout milliseconds to wait for the connections to close
+ *   before drain_step gives up on them.
+ */
+void drain_start(struct drain_t* drain, long timeout)
+{
+    if (drain_is_draining(drain)) return;
+    signal(SIGPIPE,SIG_IGN);
+
+    long now = drain_current_time();
+    int maxFd = __atomic_load_n(&drain->maxFd,__ATOMIC_RELAXED);
+    for (register int fd = 0; fd <= maxFd; ++fd)
+    {
+        long lastActiveTime = __atomic_load_n(&drain->lastActiveTimes[fd],__ATOMIC_RELAXED);
+        if (lastActiveTime > 0)
+        {
+            __atomic_compare_exchange_n(&drain->lastActiveTimes[fd],&lastActiveTime,now,false,__ATOMIC_RELAXED,__ATOMIC_RELAXED);
+        }
+    }
+    drain->deadline = now+timeout;
+    drain->nextReportTime = now+DRAIN_REPORT_INTERVAL;
+    __atomic_store_n(&drain->startTime,now,__ATOMIC_RELEASE);
+
+    fprintf(stderr,"[%d] draining %d connections; deadline in %ld ms\n",
+        getpid(),__atomic_load_n(&drain->numConnections,__ATOMIC_RELAXED),timeout);
+}
+
+/**
+ * moves the drain along: half-closes connections that have gone idle, and
+ *   reports progress every DRAIN_REPORT_INTERVAL. to be called whenever
+ *   {timeout} elapses, or a connection closes, until it returns false.
+ *
+ * @function   drain_step
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       a connection is idle when nothing was received on it for
+ *   DRAIN_IDLE_TIME, and its send queue is empty, so no echo is in flight.
+ *   the time the drain took, or the number of connections still open when
+ *   the deadline passed, is reported when it ends.
+ *
+ * @signature  bool drain_step(struct drain_t* drain, int* timeout)
+ *
+ * @param      drain connection tracker.
+ * @param      timeout set to the milliseconds to wait for before calling this
+ *   function again.
+ *
+ * @return     true while the drain goes on; false once all connections have
+ *   closed, or the deadline has passed.
+ */
+bool drain_step(struct drain_t* drain, int* timeout)
+{
+    long now = drain_current_time();
+    long elapsed = now-drain->startTime;
+    int numConnections = __atomic_load_n(&drain->numConnections,__ATOMIC_RELAXED);
+
+    // finish once all connections are closed, or time is up
+    if (numConnections <= 0)
+    {
+        fprintf(stderr,"[%d] drained in %ld ms; %d connections half-closed\n",
+            getpid(),elapsed,__atomic_load_n(&drain->numHalfClosed,__ATOMIC_RELAXED));
+        return false;
+    }
+    if (now >= drain->deadline)
+    {
+        fprintf(stderr,"[%d] drain deadline passed after %ld ms; closing %d connections\n",
+            getpid(),elapsed,numConnections);
+        return false;
+    }
+
+    // half-close the connections that are idle
+    int maxFd = __atomic_load_n(&drain->maxFd,__ATOMIC_RELAXED);
+    for (register int fd = 0; fd <= maxFd; ++fd)
+    {
+        long lastActiveTime = __atomic_load_n(&drain->lastActiveTimes[fd],__ATOMIC_RELAXED);
+        if (lastActiveTime <= 0 || now-lastActiveTime < DRAIN_IDLE_TIME) continue;
+
+        int unsentLen;
+        if (ioctl(fd,SIOCOUTQ,&unsentLen) == -1 || unsentLen > 0) continue;
+
+        if (__atomic_compare_exchange_n(&drain->lastActiveTimes[fd],&lastActiveTime,-1,false,__ATOMIC_RELAXED,__ATOMIC_RELAXED))
+        {
+            shutdown(fd,SHUT_WR);
+            __atomic_add_fetch(&drain->numHalfClosed,1,__ATOMIC_RELAXED);
+        }
+    }
+
+    // report progress
+    if (now >= drain->nextReportTime)
+    {
+        fprintf(stderr,"[%d] draining: %d connections open, %d half-closed, %ld ms left\n",
+            getpid(),numConnections,__atomic_load_n(&drain->numHalfClosed,__ATOMIC_RELAXED),drain->deadline-now);
+        drain->nextReportTime += DRAIN_REPORT_INTERVAL;
+    }
+
+    // come back when idle connections may need closing, or time is up
+    long wait = DRAIN_IDLE_TIME;
+    if (drain->deadline-now < wait) wait = drain->deadline-now;
+    *timeout = (int) wait;
+    return true;
+}
+
+/**
+ * returns the current time of the monotonic clock in milliseconds.
+ *
+ * @function   drain_current_time
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       never returns 0, which marks a drain that has not started.
+ *
+ * @signature  long drain_current_time()
+ *
+ * @return     current time in milliseconds.
+ */
+long drain_current_time()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC,&now);
+    return now.tv_sec*1000+now.tv_nsec/1000000+1;
+}
@@ -0,0 +1,69 @@
+#ifndef _DRAIN_HELPER_H_
+#define _DRAIN_HELPER_H_
+
+/**
+ * default time in milliseconds a server waits for its connections to close
+ *   after it starts draining, before it closes the rest.
+ */
+#define DRAIN_DEFAULT_TIMEOUT 30000
+
+/**
+ * milliseconds without any data received before a connection counts as idle
+ *   while draining, and is half-closed.
+ */
+#define DRAIN_IDLE_TIME 100
+
+/**
+ * milliseconds between drain progress reports.
+ */
+#define DRAIN_REPORT_INTERVAL 1000
+
+/**
+ * connections of a server, tracked so that they can be drained: once draining
+ *   starts, connections whose echoes have all been sent and that have been
+ *   idle for DRAIN_IDLE_TIME are half-closed, so their clients close them. all
+ *   counters and tables are accessed atomically, so connections may be
+ *   tracked from several threads while another thread drains them.
+ */
+struct drain_t
+{
+    long* lastActiveTimes;      // by file descriptor; time data was last received
+                                //   at, 0 if not open, -1 once half-closed
+    int tableLen;               // number of entries in lastActiveTimes
+    int maxFd;                  // biggest file descriptor tracked so far
+    int numConnections;         // number of connections open
+    int numHalfClosed;          // number of connections half-closed by the drain
+    long startTime;             // time the drain started at; 0 if not draining
+    long deadline;              // time the remaining connections are cut at
+    long nextReportTime;        // time to report progress at next
+};
+
+void drain_init(struct drain_t* drain);
+void drain_open(struct drain_t* drain, int fd);
+void drain_close(struct drain_t* drain, int fd);
+void drain_start(struct drain_t* drain, long timeout);
+bool drain_step(struct drain_t* drain, int* timeout);
+
+long drain_current_time();
+
+/**
+ * returns true once the drain has started.
+ */
+inline bool drain_is_draining(struct drain_t* drain)
+{
+    return __atomic_load_n(&drain->startTime,__ATOMIC_RELAXED) != 0;
+}
+
+/**
+ * records that data was received from the connection {fd}. only costs a load
+ *   until the drain starts.
+ */
+inline void drain_touch(struct drain_t* drain, int fd)
+{
+    if (drain_is_draining(drain) && fd < drain->tableLen)
+    {
+        __atomic_store_n(&drain->lastActiveTimes[fd],drain_current_time(),__ATOMIC_RELAXED);
+    }
+}
+
+#endif
@@ -19,7 +19,11 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <float.h>
+#include <poll.h>
+#include <signal.h>
 #include <stdio.h>
+#include <time.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
@@ -28,10 +32,25 @@
 #include <sys/mman.h>
 #include <sys/time.h>
 #include <sys/wait.h>
-#include <semaphore.h>
+#include <pthread.h>
+#include <new>
 #include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <sys/uio.h>
+#include <sys/signalfd.h>
+#include <sys/eventfd.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <netinet/udp.h>
 #include "net_helper.h"
+#include "payload_helper.h"
+#include "histogram_helper.h"
+#include "schedule_helper.h"
+#include "cycle_helper.h"
+#include "perf_helper.h"
+#include "frame_helper.h"
+#include "Semaphore.h"
 
 /**
  * size of events array passed to epoll_wait system function.
@@ -44,51 +63,237 @@
 #define ECHO_BUFFER_LEN 1024
 
 /**
- * pointer to a sem_t sized shared memory where a semaphore will be allocated
- * onto. used by children processes to ensure exclusion when printing statistics
- * upon termination.
+ * milliseconds between interval reports when -w is given without -i.
  */
-sem_t* printStatsLock = 0;
+#define DEFAULT_REPORT_INTERVAL 1000
 
 /**
- * duration of the shortest connection.
+ * milliseconds between ticks of the timer that drives the load schedule.
  */
-double minServiceTime = DBL_MAX;
+#define SCHEDULE_TICK_LEN 10
 
 /**
- * duration of the longest connection.
+ * size of a cache line; statistics slots of worker threads are aligned to it.
  */
-double maxServiceTime = 0;
+#define CACHE_LINE_LEN 64
 
 /**
- * duration of the average service time.
+ * maximum number of datagrams sent by one call to sendmmsg, or received by one
+ *   call to recvmmsg.
  */
-double avgServiceTime = 0;
+#define UDP_BATCH_LEN 64
 
 /**
- * total number of connections made.
+ * size of each datagram receive buffer. big enough for a GRO coalesced
+ *   datagram.
  */
-unsigned long totalSessionCount = 0;
+#define UDP_BUFFER_LEN 65536
 
 /**
- * highest number of concurrent connections in one moment.
+ * largest datagram payload that the UDP load mode will send.
  */
-unsigned long peakSessionCount = 0;
+#define UDP_DATAGRAM_MAX 1472
 
 /**
- * current number of concurrent connections.
+ * milliseconds without receiving any echo after which all datagrams in flight
+ *   are presumed lost, so that the send window opens up again.
  */
-unsigned long sessionCount = 0;
+#define UDP_LOSS_TIMEOUT 200
 
 /**
- * number of clients the process is managing (child process only).
+ * pointer to a Semaphore sized shared memory where a semaphore will be
+ * allocated onto. used by children processes to ensure exclusion when printing
+ * statistics upon termination.
  */
-unsigned long targetSessionCount = 0;
+Semaphore* printStatsLock = 0;
 
 /**
- * time stamp taken when child process started (child process only).
+ * statistics of one worker process or thread. every worker owns a slot, and is
+ *   the only one that writes to it, so recording statistics takes no locks.
+ *   slots are aligned to cache lines, so worker threads never share one.
  */
-long startTime = 0;
+struct alignas(CACHE_LINE_LEN) stats_t
+{
+    // duration of the shortest, longest and average connection
+    double minServiceTime;
+    double maxServiceTime;
+    double avgServiceTime;
+    // total number of connections made
+    unsigned long totalSessionCount;
+    // highest number of concurrent connections in one moment
+    unsigned long peakSessionCount;
+    // current number of concurrent connections
+    unsigned long sessionCount;
+    // number of clients the worker is managing
+    unsigned long targetSessionCount;
+    // time stamp taken when the worker started
+    long startTime;
+    // total number of connections attempted
+    unsigned long totalConnectCount;
+    // number of connections whose SYN carried data that the server accepted
+    unsigned long fastOpenCount;
+    // number of sessions closed before they were finished because the load
+    // schedule ramped down
+    unsigned long abortedSessionCount;
+    // number of sessions the server closed or reset before they were finished
+    unsigned long droppedSessionCount;
+    // longest echo request latency in microseconds since the current phase of
+    // the load schedule started
+    double phaseMaxRequestLatency;
+    // total number of echo requests echoed back completely
+    unsigned long totalRequestCount;
+    // shortest, longest and average echo request latency in microseconds
+    double minRequestLatency;
+    double maxRequestLatency;
+    double avgRequestLatency;
+    // number of sessions whose echoed bytes differed from the bytes they sent
+    unsigned long corruptSessionCount;
+    // true once the first mismatching echoed byte has been recorded
+    bool isMismatchFound;
+    // identifier of the connection, and offset into its stream of the first
+    // mismatching echoed byte, along with the byte expected and received
+    unsigned long firstMismatchConnection;
+    unsigned long long firstMismatchOffset;
+    unsigned char firstMismatchExpected;
+    unsigned char firstMismatchActual;
+    // number of datagrams sent, and echoed datagrams received (UDP mode only)
+    unsigned long udpSentCount;
+    unsigned long udpReceivedCount;
+    // number of echoed datagrams that arrived after a datagram that was sent
+    // later than them (UDP mode only)
+    unsigned long udpReorderedCount;
+    // number of times the send window was reset because no echo arrived
+    // within UDP_LOSS_TIMEOUT (UDP mode only)
+    unsigned long udpLossTimeoutCount;
+    // number of datagrams sent, but not yet echoed back or presumed lost (UDP
+    // mode only)
+    long udpInFlightCount;
+    // shortest, longest and average round trip time of a datagram in
+    // microseconds (UDP mode only)
+    double minRoundTripTime;
+    double maxRoundTripTime;
+    double avgRoundTripTime;
+    // every echo request latency, or datagram round trip time in microseconds
+    struct histogram_t latencies;
+    // hardware and software events counted while the worker ran
+    struct perf_counts_t perfCounts;
+};
+
+/**
+ * statistics slot of the calling worker process or thread.
+ */
+__thread struct stats_t* stats = 0;
+
+/**
+ * adds {delta} to {counter}, a counter of the statistics slot of the calling
+ *   worker that interval reports read while the worker runs. the worker is its
+ *   only writer, so a relaxed load and store do; on x86, they are plain moves.
+ */
+template<class T>
+inline void stats_add(T* counter, long delta)
+{
+    __atomic_store_n(counter,(T) (*counter+delta),__ATOMIC_RELAXED);
+}
+
+/**
+ * statistics slots of every worker of this process, and the number of them.
+ *   interval reports are made from all of them.
+ */
+struct stats_t* statsSlots = 0;
+int numStatsSlots = 0;
+
+/**
+ * false once the calling worker process or thread should stop its event loop.
+ */
+__thread bool isWorkerRunning = true;
+
+/**
+ * true if the calling thread is a worker thread, rather than a worker process
+ *   or the thread that reports for worker threads.
+ */
+__thread bool isWorkerThread = false;
+
+/**
+ * event file descriptor that the reporting thread makes readable to stop the
+ *   worker threads; -1 if workers are processes rather than threads.
+ */
+int stopFd = -1;
+
+/**
+ * event file descriptor that counts the worker threads that have stopped.
+ */
+int doneFd = -1;
+
+/**
+ * milliseconds between interval reports; 0 if none are made.
+ */
+long reportInterval = 0;
+
+/**
+ * file descriptor interval reports are written to, and true if they are
+ *   written as CSV rows instead of lines of text.
+ */
+int reportFd = STDOUT_FILENO;
+bool isReportCsv = false;
+
+/**
+ * timer file descriptor that expires every reportInterval milliseconds.
+ */
+int reportTimer = -1;
+
+/**
+ * signal file descriptor that reports SIGINT and SIGTERM.
+ */
+int signalFd = -1;
+
+/**
+ * time stamp taken, and statistics of all workers of this process when the
+ *   current report interval started.
+ */
+long intervalStartTime = 0;
+unsigned long intervalStartRequests = 0;
+unsigned long intervalStartSessions = 0;
+unsigned long intervalStartConnects = 0;
+struct histogram_t intervalStartLatencies;
+
+/**
+ * true if the process is generating UDP load instead of TCP sessions.
+ */
+bool udpMode = false;
+
+/**
+ * true if connections are made with TCP fast open.
+ */
+bool isFastOpen = false;
+
+/**
+ * true if every request is sent as a frame: a 4-byte big-endian length, then
+ *   that many bytes of message. for servers run with -a length.
+ */
+bool isFramed = false;
+
+/**
+ * header at the front of every datagram sent in UDP mode. the server echoes it
+ *   back untouched.
+ */
+struct udp_header_t
+{
+    // sequence number of the datagram within the sending process
+    uint64_t seq;
+    // monotonic time stamp in microseconds taken just before sending
+    uint64_t timeSent;
+};
+
+/**
+ * echo request that has been sent, but not yet echoed back completely.
+ */
+struct request_t
+{
+    // stream offset just past the last byte of the request
+    unsigned long long endOffset;
+    // monotonic time stamp in microseconds taken when sending started
+    long timeSent;
+};
 
 /**
  * structure associated with each client.
@@ -99,10 +304,79 @@ struct client_t
     int fd;
     // number of times we've made an echo request to the server
     unsigned int timesTransmitted;
-    // number of bytes received from the server for the current echo request
-    unsigned int bytesReceived;
+    // number of echo requests that have been echoed back completely
+    unsigned int timesEchoed;
+    // number of bytes of the latest echo request written to the socket
+    unsigned int bytesSent;
+    // number of bytes in the latest echo request
+    unsigned int requestLen;
+    // ring of pipelineDepth outstanding requests; request n is at n%depth
+    struct request_t* requests;
     // time stamp taken immediately before the call to connect
     long timeSynSent;
+    // identifier of the connection; unique within the run
+    unsigned long connectionId;
+    // offset into the payload pattern where this connection's stream starts
+    size_t streamBase;
+    // number of bytes of the stream sent, and received back so far
+    unsigned long long sendOffset;
+    unsigned long long recvOffset;
+    // true once an echoed byte has differed from the byte that was sent
+    bool isCorrupt;
+    // true once the connection has been checked for having used fast open
+    bool isFastOpenChecked;
+    // splits the bytes received into frames, the stream offset of the next
+    // frame, and the number of frames received (framed mode only)
+    struct frame_reader_t reader;
+    unsigned long long frameOffset;
+    unsigned int framesReceived;
+};
+
+/**
+ * state of a worker that manages a number of clients.
+ */
+struct worker_t
+{
+    // index of the worker among all workers of the run
+    int workerIndex;
+    // epoll file descriptor of the worker's event loop
+    int epoll;
+    // name and port of the remote host to connect to
+    char* remoteName;
+    int remotePort;
+    // payload that every client's stream is made of
+    const struct payload_t* payload;
+    // distribution of echo request sizes, and index of the next one to use
+    const struct size_dist_t* sizes;
+    unsigned long nextRequestIndex;
+    // number of echo requests to make for each connection
+    unsigned int timesToRetransmit;
+    // maximum number of echo requests in flight on each connection
+    unsigned int pipelineDepth;
+    // identifier of the next connection made by this worker
+    unsigned long nextConnectionId;
+    // client slots; the first openClients of them are in use
+    struct client_t* clients;
+    unsigned int openClients;
+    // this worker's share of the load schedule, and the current phase of it
+    struct schedule_t schedule;
+    size_t phaseIndex;
+    // timer file descriptor that drives the load schedule
+    int scheduleTimer;
+    // time stamps taken when the current phase started, and when its ramp
+    // finished (0 while still ramping)
+    long phaseStartTime;
+    long rampEndTime;
+    // number of open clients when the current phase started
+    unsigned int phaseStartClients;
+    // statistics when the current phase started
+    unsigned long phaseStartSessions;
+    unsigned long phaseStartConnects;
+    unsigned long phaseStartRequests;
+    unsigned long phaseStartAborted;
+    unsigned long phaseStartDropped;
+    unsigned long phaseStartCorrupt;
+    double phaseStartLatency;
 };
 
 /**
@@ -150,9 +424,9 @@ void fatal_error(char const * string)
  */
 void increment_session_count()
 {
-    sessionCount++;
-    if (peakSessionCount < sessionCount)
-        peakSessionCount = sessionCount;
+    stats_add(&stats->sessionCount,1);
+    if (stats->peakSessionCount < stats->sessionCount)
+        stats->peakSessionCount = stats->sessionCount;
 }
 
 /**
@@ -178,16 +452,16 @@ void increment_session_count()
  */
 void decrement_session_count(double instanceServiceTime)
 {
-    sessionCount--;
-    totalSessionCount++;
+    stats_add(&stats->sessionCount,-1);
+    stats_add(&stats->totalSessionCount,1);
 
     // update service times
-    if (minServiceTime > instanceServiceTime)
-        minServiceTime = instanceServiceTime;
-    if (maxServiceTime < instanceServiceTime)
-        maxServiceTime = instanceServiceTime;
-    double totalServiceTime = avgServiceTime*(totalSessionCount-1)+instanceServiceTime;
-    avgServiceTime = totalServiceTime/totalSessionCount;
+    if (stats->minServiceTime > instanceServiceTime)
+        stats->minServiceTime = instanceServiceTime;
+    if (stats->maxServiceTime < instanceServiceTime)
+        stats->maxServiceTime = instanceServiceTime;
+    double totalServiceTime = stats->avgServiceTime*(stats->totalSessionCount-1)+instanceServiceTime;
+    stats->avgServiceTime = totalServiceTime/stats->totalSessionCount;
 }
 
 /**
@@ -217,14 +491,156 @@ long current_timestamp()
 }
 
 /**
- * the SIGINT handler. acquires a inter-process lock, and prints the statistics
- *   for this process to stdout.
+ * returns a monotonic time stamp in microseconds, suitable for measuring short
+ *   intervals.
+ *
+ * @function   current_timestamp_us
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  long current_timestamp_us()
+ *
+ * @return     microseconds elapsed since an unspecified starting point.
+ */
+long current_timestamp_us()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return ts.tv_sec*1000000L + ts.tv_nsec/1000;
+}
+
+/**
+ * clears {slot}, so that a worker can start recording its statistics in it.
+ *
+ * @function   stats_init
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  void stats_init(struct stats_t* slot)
+ *
+ * @param      slot statistics slot to clear.
+ */
+void stats_init(struct stats_t* slot)
+{
+    memset(slot,0,sizeof(struct stats_t));
+    slot->minServiceTime = DBL_MAX;
+    slot->minRequestLatency = DBL_MAX;
+    slot->minRoundTripTime = DBL_MAX;
+    slot->startTime = current_timestamp();
+}
+
+/**
+ * adds the statistics of {other} to {totals}.
+ *
+ * @function   merge_stats
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       only used once the worker that owns {other} has stopped.
+ *   peakSessionCount becomes the sum of the workers' peaks, which is an upper
+ *   bound of the real peak.
+ *
+ * @signature  void merge_stats(struct stats_t* totals,
+ *   const struct stats_t* other)
+ *
+ * @param      totals statistics to add to.
+ * @param      other statistics to add.
+ */
+void merge_stats(struct stats_t* totals,const struct stats_t* other)
+{
+    // averages are weighted by the number of samples behind them
+    if (other->totalSessionCount > 0)
+        totals->avgServiceTime = (totals->avgServiceTime*totals->totalSessionCount+other->avgServiceTime*other->totalSessionCount)/(totals->totalSessionCount+other->totalSessionCount);
+    if (other->totalRequestCount > 0)
+        totals->avgRequestLatency = (totals->avgRequestLatency*totals->totalRequestCount+other->avgRequestLatency*other->totalRequestCount)/(totals->totalRequestCount+other->totalRequestCount);
+    if (other->udpReceivedCount > 0)
+        totals->avgRoundTripTime = (totals->avgRoundTripTime*totals->udpReceivedCount+other->avgRoundTripTime*other->udpReceivedCount)/(totals->udpReceivedCount+other->udpReceivedCount);
+
+    if (totals->minServiceTime > other->minServiceTime)
+        totals->minServiceTime = other->minServiceTime;
+    if (totals->maxServiceTime < other->maxServiceTime)
+        totals->maxServiceTime = other->maxServiceTime;
+    if (totals->minRequestLatency > other->minRequestLatency)
+        totals->minRequestLatency = other->minRequestLatency;
+    if (totals->maxRequestLatency < other->maxRequestLatency)
+        totals->maxRequestLatency = other->maxRequestLatency;
+    if (totals->minRoundTripTime > other->minRoundTripTime)
+        totals->minRoundTripTime = other->minRoundTripTime;
+    if (totals->maxRoundTripTime < other->maxRoundTripTime)
+        totals->maxRoundTripTime = other->maxRoundTripTime;
+    if (totals->startTime > other->startTime)
+        totals->startTime = other->startTime;
+
+    totals->totalSessionCount += other->totalSessionCount;
+    totals->peakSessionCount += other->peakSessionCount;
+    totals->sessionCount += other->sessionCount;
+    totals->targetSessionCount += other->targetSessionCount;
+    totals->totalConnectCount += other->totalConnectCount;
+    totals->fastOpenCount += other->fastOpenCount;
+    totals->abortedSessionCount += other->abortedSessionCount;
+    totals->droppedSessionCount += other->droppedSessionCount;
+    totals->totalRequestCount += other->totalRequestCount;
+    totals->corruptSessionCount += other->corruptSessionCount;
+    totals->udpSentCount += other->udpSentCount;
+    totals->udpReceivedCount += other->udpReceivedCount;
+    totals->udpReorderedCount += other->udpReorderedCount;
+    totals->udpLossTimeoutCount += other->udpLossTimeoutCount;
+    totals->udpInFlightCount += other->udpInFlightCount;
+    histogram_merge(&totals->latencies,&other->latencies);
+    perf_merge(&totals->perfCounts,&other->perfCounts);
+
+    if (!totals->isMismatchFound && other->isMismatchFound)
+    {
+        totals->isMismatchFound = true;
+        totals->firstMismatchConnection = other->firstMismatchConnection;
+        totals->firstMismatchOffset = other->firstMismatchOffset;
+        totals->firstMismatchExpected = other->firstMismatchExpected;
+        totals->firstMismatchActual = other->firstMismatchActual;
+    }
+}
+
+/**
+ * acquires a inter-process lock, and prints the statistics {totals} of this
+ *   process to stdout.
  *
  * @function   print_statistics
  *
  * @date       2016-02-14
  *
- * @revision   none
+ * @revision   2026-10-16 Eric Tsang - no longer the SIGINT handler; it is
+ *   called once SIGINT or SIGTERM is read from signalFd, and the workers of
+ *   the process have stopped.
+ *
+ * @revision   2026-10-16 Eric Tsang - prints the merged statistics of all
+ *   worker threads of the process.
+ *
+ * @revision   2026-10-16 Eric Tsang - prints the perf counters of the workers,
+ *   per echo and per connection.
+ *
+ * @revision   2026-10-16 Eric Tsang - prints the p99 request latency, from
+ *   the latency histogram of the workers.
  *
  * @designer   Eric Tsang
  *
@@ -232,38 +648,82 @@ long current_timestamp()
  *
  * @note       none
  *
- * @signature  void print_statistics(int)
+ * @signature  void print_statistics(const struct stats_t* totals,
+ *   int numThreads)
  *
- * @param      int unused!
+ * @param      totals statistics of every worker of the process.
+ * @param      numThreads number of worker threads that made them; 1 if the
+ *   process is the worker.
  */
-void print_statistics(int)
+void print_statistics(const struct stats_t* totals,int numThreads)
 {
-    sem_wait(printStatsLock);
+    printStatsLock->wait();
 
-    long totalRuntime = current_timestamp()-startTime;
+    long totalRuntime = current_timestamp()-totals->startTime;
 
-    printf("\n[%lu]\n",(unsigned long) getpid());
-    printf("    minServiceTime: %lf ms\n",minServiceTime);
-    printf("    maxServiceTime: %lf ms\n",maxServiceTime);
-    printf("    avgServiceTime: %lf ms\n",avgServiceTime);
-    printf(" totalSessionCount: %li\n",totalSessionCount);
-    printf("targetSessionCount: %li\n",targetSessionCount);
-    printf("  peakSessionCount: %li\n",peakSessionCount);
-    printf("      sessionsRate: %lf sessions served per second\n",(double) totalSessionCount/(totalRuntime/1000L));
+    if (numThreads > 1)
+        printf("\n[%lu] %d threads\n",(unsigned long) getpid(),numThreads);
+    else
+        printf("\n[%lu]\n",(unsigned long) getpid());
+    if (udpMode)
+    {
+        // datagrams still in flight at termination are not counted as lost
+        unsigned long settled = totals->udpSentCount-totals->udpInFlightCount;
+        unsigned long lost = settled > totals->udpReceivedCount ? settled-totals->udpReceivedCount : 0;
+        printf("  minRoundTripTime: %lf us\n",totals->minRoundTripTime);
+        printf("  maxRoundTripTime: %lf us\n",totals->maxRoundTripTime);
+        printf("  avgRoundTripTime: %lf us\n",totals->avgRoundTripTime);
+        printf("   datagramsWindow: %li\n",totals->targetSessionCount);
+        printf("     datagramsSent: %li\n",totals->udpSentCount);
+        printf(" datagramsReceived: %li\n",totals->udpReceivedCount);
+        printf("     datagramsLost: %li (%lf%%)\n",lost,totals->udpSentCount ? 100.0*lost/totals->udpSentCount : 0.0);
+        printf("datagramsReordered: %li\n",totals->udpReorderedCount);
+        printf(" lossTimeoutsCount: %li\n",totals->udpLossTimeoutCount);
+        printf("     datagramsRate: %lf datagrams echoed per second\n",(double) totals->udpReceivedCount*1000/totalRuntime);
+        printf("      totalRuntime: %li ms\n",totalRuntime);
+        perf_print(stdout,&totals->perfCounts,totals->udpReceivedCount,0);
+        printStatsLock->post();
+        return;
+    }
+    printf("    minServiceTime: %lf ms\n",totals->minServiceTime);
+    printf("    maxServiceTime: %lf ms\n",totals->maxServiceTime);
+    printf("    avgServiceTime: %lf ms\n",totals->avgServiceTime);
+    printf(" totalSessionCount: %li\n",totals->totalSessionCount);
+    printf("targetSessionCount: %li\n",totals->targetSessionCount);
+    printf("  peakSessionCount: %li\n",totals->peakSessionCount);
+    printf(" totalConnectCount: %li\n",totals->totalConnectCount);
+    if (isFastOpen)
+    {
+        printf("     fastOpenCount: %li\n",totals->fastOpenCount);
+    }
+    printf("abortedSessionCount: %li\n",totals->abortedSessionCount);
+    printf("droppedSessionCount: %li\n",totals->droppedSessionCount);
+    printf(" minRequestLatency: %lf us\n",totals->minRequestLatency);
+    printf(" maxRequestLatency: %lf us\n",totals->maxRequestLatency);
+    printf(" avgRequestLatency: %lf us\n",totals->avgRequestLatency);
+    printf(" p99RequestLatency: %lu us\n",histogram_percentile(&totals->latencies,99));
+    printf(" totalRequestCount: %li\n",totals->totalRequestCount);
+    printf("      requestsRate: %lf requests served per second\n",(double) totals->totalRequestCount*1000/totalRuntime);
+    printf("corruptSessionCount: %li\n",totals->corruptSessionCount);
+    if (totals->isMismatchFound)
+    {
+        printf("     firstMismatch: connection %lu, stream offset %llu, expected 0x%02x, received 0x%02x\n",
+            totals->firstMismatchConnection,totals->firstMismatchOffset,totals->firstMismatchExpected,totals->firstMismatchActual);
+    }
+    printf("      sessionsRate: %lf sessions served per second\n",(double) totals->totalSessionCount/(totalRuntime/1000L));
     printf("      totalRuntime: %li ms\n",totalRuntime);
+    perf_print(stdout,&totals->perfCounts,totals->totalRequestCount,totals->totalConnectCount);
 
-    sem_post(printStatsLock);
-
-    exit(0);
+    printStatsLock->post();
 }
 
 /**
- * manages a number of clients that continuously connect and make echo requests
- *   to the remote server.
+ * records the session of a client as corrupt, and the first mismatching byte
+ *   of the worker.
  *
- * @function   child_process
+ * @function   record_mismatch
  *
- * @date       2016-02-14
+ * @date       2026-10-16
  *
  * @revision   none
  *
@@ -271,119 +731,1094 @@ void print_statistics(int)
  *
  * @programmer Eric Tsang
  *
- * @note       none
- *
- * @signature  int child_process(char* remoteName,int remotePort,int numClients,
- *   char* data,unsigned int timesToRetransmit)
+ * @note       only the first mismatch of a session is recorded.
  *
- * @param      remoteName name of the remote host to connect to.
- * @param      remotePort port of the remote host to connect to.
- * @param      numClients number of clients to make to connect to the remote
- *   host simultaneously for this process.
- * @param      data data to send for the echo requests for each client.
- * @param      timesToRetransmit number of echo requests to make for each
- *   connection.
+ * @signature  void record_mismatch(struct client_t* clientPtr,
+ *   unsigned long long offset,char expected,char actual)
  *
- * @return     exit code of this process.
+ * @param      clientPtr client that received the byte.
+ * @param      offset offset of the byte into the client's stream.
+ * @param      expected byte that should have been received.
+ * @param      actual byte that was received.
  */
-int child_process(char* remoteName,int remotePort,int numClients,char* data,unsigned int timesToRetransmit)
+void record_mismatch(struct client_t* clientPtr,unsigned long long offset,char expected,char actual)
 {
-    targetSessionCount = numClients;
-    startTime = current_timestamp();
-
-    // set signal handler
-    signal(SIGINT,print_statistics);
+    clientPtr->isCorrupt = true;
+    stats->corruptSessionCount++;
+    if (!stats->isMismatchFound)
+    {
+        stats->isMismatchFound = true;
+        stats->firstMismatchConnection = clientPtr->connectionId;
+        stats->firstMismatchOffset = offset;
+        stats->firstMismatchExpected = (unsigned char) expected;
+        stats->firstMismatchActual = (unsigned char) actual;
+        fprintf(stderr,"[%lu] echo mismatch: connection %lu, stream offset %llu, expected 0x%02x, received 0x%02x\n",
+            (unsigned long) getpid(),stats->firstMismatchConnection,stats->firstMismatchOffset,stats->firstMismatchExpected,stats->firstMismatchActual);
+    }
+}
 
-    // create epoll file descriptor
-    int epoll = epoll_create(EPOLL_QUEUE_LEN);
-    if (epoll == -1)
+/**
+ * compares bytes echoed back to a client against the bytes of its stream that
+ *   they should be, and records the session as corrupt if they differ.
+ *
+ * @function   verify_echo
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       only the first mismatch of a session is recorded; once bytes go
+ *   missing or get reordered, everything after them mismatches too.
+ *
+ * @signature  void verify_echo(struct client_t* clientPtr,
+ *   const struct payload_t* payload,const char* buf,int len)
+ *
+ * @param      clientPtr client that received the bytes.
+ * @param      payload payload that the client's stream is made of.
+ * @param      buf bytes received, starting at the client's recvOffset.
+ * @param      len number of bytes received.
+ */
+void verify_echo(struct client_t* clientPtr,const struct payload_t* payload,const char* buf,int len)
+{
+    if (clientPtr->isCorrupt)
     {
-        fatal_error("epoll_create");
+        return;
     }
 
-    // create all clients, call connect, and add them to epoll loop
-    struct client_t clients[numClients];
-    memset(clients,0,sizeof(clients));
-    for (register int i = 0; i < numClients; ++i)
+    const char* expected = payload_at(payload,clientPtr->streamBase,clientPtr->recvOffset);
+    size_t mismatch = payload_compare(expected,buf,len);
+    if (mismatch == (size_t) len)
     {
-        // create client socket, and setup client_t structure
-        client_t* clientPtr = clients+i;
-        clientPtr->fd = make_tcp_client_socket(remoteName,0,remotePort,0,true).fd;
-        clientPtr->timeSynSent = current_timestamp();
+        return;
+    }
 
-        // add the client to the epoll event loop
-        struct epoll_event event = epoll_event();
-        event.events = EPOLLOUT|EPOLLERR|EPOLLHUP|EPOLLET;
-        event.data.ptr = clientPtr;
-        if (epoll_ctl(epoll,EPOLL_CTL_ADD,clients[i].fd,&event) == -1)
-        {
-            fatal_error("epoll_ctl");
-        }
+    record_mismatch(clientPtr,clientPtr->recvOffset+mismatch,expected[mismatch],buf[mismatch]);
+}
+
+/**
+ * splits bytes echoed back to a client into frames, and compares each against
+ *   the request it answers, recording the session as corrupt if they differ.
+ *
+ * @function   verify_frames
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       frames are parsed in place from {buf}; only a frame split across
+ *   reads is copied. the message of a frame starting at stream offset n is
+ *   the stream from n+FRAME_HEADER_LEN; the payload under its length prefix
+ *   is never sent.
+ *
+ * @signature  void verify_frames(struct worker_t* worker,
+ *   struct client_t* clientPtr,const char* buf,int len)
+ *
+ * @param      worker worker that manages the client.
+ * @param      clientPtr client that received the bytes.
+ * @param      buf bytes received, starting at the client's recvOffset.
+ * @param      len number of bytes received.
+ */
+void verify_frames(struct worker_t* worker,struct client_t* clientPtr,const char* buf,int len)
+{
+    if (clientPtr->isCorrupt)
+    {
+        return;
     }
 
-    // execute epoll event loop
-    while (true)
+    struct frame_t frame;
+    enum frame_result_t result;
+    frame_reader_feed(&clientPtr->reader,buf,len);
+    while ((result = frame_reader_next(&clientPtr->reader,&frame)) != FRAME_NEED_MORE)
     {
-        printf("current timestamp: %li\n",current_timestamp());
-        // wait for epoll to unblock to report socket activity
-        static struct epoll_event events[EPOLL_QUEUE_LEN];
-        static int eventCount;
-        eventCount = epoll_wait(epoll,events,EPOLL_QUEUE_LEN,-1);
-        if (eventCount < 0)
+        // the frame must be as long as the request it answers
+        struct request_t* request = clientPtr->requests+clientPtr->framesReceived%worker->pipelineDepth;
+        unsigned long long expectedLen = request->endOffset-clientPtr->frameOffset;
+        if (result == FRAME_TOO_LONG || frame.len != expectedLen)
         {
-            fatal_error("epoll_wait");
+            uint32_t header = htonl((uint32_t) (expectedLen-FRAME_HEADER_LEN));
+            register int i = 0;
+            while (i < FRAME_HEADER_LEN-1 && frame.data[i] == ((const char*) &header)[i]) ++i;
+            record_mismatch(clientPtr,clientPtr->frameOffset+i,((const char*) &header)[i],frame.data[i]);
+            return;
         }
 
-        // epoll unblocked; handle socket activity
-        for (register int i = 0; i < eventCount; i++)
+        // and its message must be the request's
+        const char* expected = payload_at(worker->payload,clientPtr->streamBase,clientPtr->frameOffset+FRAME_HEADER_LEN);
+        size_t mismatch = payload_compare(expected,frame.message,frame.messageLen);
+        if (mismatch != frame.messageLen)
         {
-            struct client_t* clientPtr = (struct client_t*) events[i].data.ptr;
+            record_mismatch(clientPtr,clientPtr->frameOffset+FRAME_HEADER_LEN+mismatch,expected[mismatch],frame.message[mismatch]);
+            return;
+        }
+        clientPtr->frameOffset += frame.len;
+        clientPtr->framesReceived++;
+    }
+}
 
-            // close connection if an error occurred
-            if (events[i].events&(EPOLLHUP|EPOLLERR))
-            {
-                // close connection
-                close(clientPtr->fd);
-                continue;
-            }
 
-            // handling case when client socket is available for writing
-            if (events[i].events&EPOLLOUT)
-            {
-                // write data to socket
-                send(clientPtr->fd,data,strlen(data),0);
+/**
+ * records the latency of an echo request, and updates minRequestLatency,
+ *   maxRequestLatency and avgRequestLatency accordingly.
+ *
+ * @function   record_request_latency
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  void record_request_latency(double requestLatency)
+ *
+ * @param      requestLatency time from starting to send the request to
+ *   receiving the last byte of its echo in microseconds.
+ */
+void record_request_latency(double requestLatency)
+{
+    stats_add(&stats->totalRequestCount,1);
+    if (stats->minRequestLatency > requestLatency)
+        stats->minRequestLatency = requestLatency;
+    if (stats->maxRequestLatency < requestLatency)
+        stats->maxRequestLatency = requestLatency;
+    if (stats->phaseMaxRequestLatency < requestLatency)
+        stats->phaseMaxRequestLatency = requestLatency;
+    double totalRequestLatency = stats->avgRequestLatency*(stats->totalRequestCount-1)+requestLatency;
+    stats->avgRequestLatency = totalRequestLatency/stats->totalRequestCount;
+    histogram_record(&stats->latencies,(unsigned long) requestLatency);
+}
 
-                // update statistics
-                if (clientPtr->timesTransmitted == 0)
-                    increment_session_count();
+/**
+ * records whether the connection of {clientPtr} was made with TCP fast open,
+ *   which is when the server acknowledged the data carried by its SYN.
+ *
+ * @function   record_fast_open
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       costs one getsockopt per connection, so it is only done when
+ *   fast open is in use.
+ *
+ * @signature  void record_fast_open(struct client_t* clientPtr)
+ *
+ * @param      clientPtr client whose connection is established.
+ */
+void record_fast_open(struct client_t* clientPtr)
+{
+    struct tcp_info info;
+    socklen_t infoLen = sizeof(info);
+    clientPtr->isFastOpenChecked = true;
+    if (getsockopt(clientPtr->fd,IPPROTO_TCP,TCP_INFO,&info,&infoLen) == 0 &&
+        (info.tcpi_options&TCPI_OPT_SYN_DATA))
+    {
+        stats->fastOpenCount++;
+    }
+}
 
-                // update client structure
-                clientPtr->timesTransmitted += 1;
+/**
+ * creates a non-blocking timer file descriptor that expires every {interval}
+ *   milliseconds.
+ *
+ * @function   make_timer_fd
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  int make_timer_fd(long interval)
+ *
+ * @param      interval milliseconds between expirations.
+ *
+ * @return     the timer file descriptor.
+ */
+int make_timer_fd(long interval)
+{
+    int timer = timerfd_create(CLOCK_MONOTONIC,TFD_NONBLOCK);
+    if (timer == -1)
+    {
+        fatal_error("timerfd_create");
+    }
 
-                // configure to wait for data to be available for reading
-                static struct epoll_event event = epoll_event();
-                event.events = EPOLLIN|EPOLLERR|EPOLLHUP|EPOLLET;
-                event.data.ptr = (void*) clientPtr;
-                epoll_ctl(epoll,EPOLL_CTL_MOD,clientPtr->fd,&event);
-                continue;
-            }
+    struct itimerspec spec;
+    spec.it_interval.tv_sec = interval/1000;
+    spec.it_interval.tv_nsec = interval%1000*1000000L;
+    spec.it_value = spec.it_interval;
+    if (timerfd_settime(timer,0,&spec,0) == -1)
+    {
+        fatal_error("timerfd_settime");
+    }
+    return timer;
+}
+
+/**
+ * creates a non-blocking signal file descriptor that reports {signals}, which
+ *   must already be blocked.
+ *
+ * @function   make_signal_fd
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  int make_signal_fd(const sigset_t* signals)
+ *
+ * @param      signals set of signals to report.
+ *
+ * @return     the signal file descriptor.
+ */
+int make_signal_fd(const sigset_t* signals)
+{
+    int fd = signalfd(-1,signals,SFD_NONBLOCK);
+    if (fd == -1)
+    {
+        fatal_error("signalfd");
+    }
+    return fd;
+}
+
+/**
+ * writes the statistics of the interval since the last report to reportFd as
+ *   a line of text, or a CSV row, and starts a new interval. the statistics of
+ *   every worker of the process are combined.
+ *
+ * @function   print_interval_statistics
+ *
+ * @date       2026-10-16
+ *
+ * @revision   2026-10-16 Eric Tsang - combines the statistics slots of every
+ *   worker thread, while they keep running.
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       each report is written with a single write, so reports of
+ *   different worker processes never interleave within a line. in UDP mode,
+ *   requests are echoed datagrams, and latencies are their round trip times.
+ *
+ * @signature  void print_interval_statistics()
+ */
+void print_interval_statistics()
+{
+    long now = current_timestamp();
+    double intervalRuntime = (double) (now-intervalStartTime);
+    if (intervalRuntime <= 0) intervalRuntime = 1;
+
+    // sum up the slots of every worker; each slot has a single writer, and
+    // relaxed atomic loads of its aligned counters never tear. its latency
+    // histogram is recorded with relaxed atomic stores, so it can be merged
+    // while the worker records into it
+    static struct histogram_t latencies;
+    static struct histogram_t intervalLatencies;
+    unsigned long requests = 0;
+    unsigned long sessions = 0;
+    unsigned long connects = 0;
+    long inFlight = 0;
+    histogram_reset(&latencies);
+    for (register int i = 0; i < numStatsSlots; ++i)
+    {
+        struct stats_t* slot = statsSlots+i;
+        requests += __atomic_load_n(udpMode ? &slot->udpReceivedCount : &slot->totalRequestCount,__ATOMIC_RELAXED);
+        sessions += __atomic_load_n(&slot->totalSessionCount,__ATOMIC_RELAXED);
+        connects += __atomic_load_n(&slot->totalConnectCount,__ATOMIC_RELAXED);
+        inFlight += udpMode ? __atomic_load_n(&slot->udpInFlightCount,__ATOMIC_RELAXED) : (long) __atomic_load_n(&slot->sessionCount,__ATOMIC_RELAXED);
+        histogram_merge(&latencies,&slot->latencies);
+    }
+    histogram_delta(&intervalLatencies,&latencies,&intervalStartLatencies);
+
+    double requestsRate = (requests-intervalStartRequests)*1000/intervalRuntime;
+    double sessionsRate = (sessions-intervalStartSessions)*1000/intervalRuntime;
+    double connectsRate = (connects-intervalStartConnects)*1000/intervalRuntime;
+    unsigned long p50 = histogram_percentile(&intervalLatencies,50);
+    unsigned long p90 = histogram_percentile(&intervalLatencies,90);
+    unsigned long p99 = histogram_percentile(&intervalLatencies,99);
+    unsigned long p999 = histogram_percentile(&intervalLatencies,99.9);
+    long runtime = now-statsSlots[0].startTime;
+
+    char line[256];
+    int lineLen;
+    if (isReportCsv)
+    {
+        lineLen = snprintf(line,sizeof(line),"%li,%lu,%.1lf,%.1lf,%.1lf,%li,%lu,%lu,%lu,%lu,%lu\n",
+            runtime,(unsigned long) getpid(),requestsRate,sessionsRate,connectsRate,inFlight,p50,p90,p99,p999,intervalLatencies.max);
+    }
+    else if (udpMode)
+    {
+        lineLen = snprintf(line,sizeof(line),"[%lu] %li ms: %.1lf datagrams/s, %li in flight, rtt p50 %lu p90 %lu p99 %lu p99.9 %lu max %lu us\n",
+            (unsigned long) getpid(),runtime,requestsRate,inFlight,p50,p90,p99,p999,intervalLatencies.max);
+    }
+    else
+    {
+        lineLen = snprintf(line,sizeof(line),"[%lu] %li ms: %.1lf requests/s, %.1lf sessions/s, %.1lf connects/s, %li in flight, latency p50 %lu p90 %lu p99 %lu p99.9 %lu max %lu us\n",
+            (unsigned long) getpid(),runtime,requestsRate,sessionsRate,connectsRate,inFlight,p50,p90,p99,p999,intervalLatencies.max);
+    }
+
+    // stdout is shared with the multi-line statistics of other processes
+    if (!isReportCsv)
+    {
+        printStatsLock->wait();
+        fflush(stdout);
+    }
+    if (write(reportFd,line,lineLen) == -1)
+    {
+        perror("write");
+    }
+    if (!isReportCsv)
+    {
+        printStatsLock->post();
+    }
+
+    // start the next interval
+    intervalStartTime = now;
+    intervalStartRequests = requests;
+    intervalStartSessions = sessions;
+    intervalStartConnects = connects;
+    memcpy(&intervalStartLatencies,&latencies,sizeof(latencies));
+}
+
+/**
+ * adds the file descriptors that control the calling worker to its epoll
+ *   event loop. worker threads watch stopFd; worker processes, and the thread
+ *   that reports for worker threads create and watch the signal file
+ *   descriptor, and the report timer if interval reports are made.
+ *
+ * @function   add_control_fds
+ *
+ * @date       2026-10-16
+ *
+ * @revision   2026-10-16 Eric Tsang - worker threads watch stopFd instead.
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the events of the file descriptors are identified by data.ptr
+ *   pointing to signalFd, reportTimer or stopFd.
+ *
+ * @signature  void add_control_fds(int epoll)
+ *
+ * @param      epoll epoll file descriptor of the worker's event loop.
+ */
+void add_control_fds(int epoll)
+{
+    struct epoll_event event = epoll_event();
+    event.events = EPOLLIN;
+
+    // worker threads are stopped by the reporting thread
+    if (isWorkerThread)
+    {
+        event.data.ptr = &stopFd;
+        if (epoll_ctl(epoll,EPOLL_CTL_ADD,stopFd,&event) == -1)
+        {
+            fatal_error("epoll_ctl");
+        }
+        return;
+    }
+
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals,SIGINT);
+    sigaddset(&signals,SIGTERM);
+    signalFd = make_signal_fd(&signals);
+
+    event.data.ptr = &signalFd;
+    if (epoll_ctl(epoll,EPOLL_CTL_ADD,signalFd,&event) == -1)
+    {
+        fatal_error("epoll_ctl");
+    }
+
+    if (reportInterval > 0)
+    {
+        intervalStartTime = statsSlots[0].startTime;
+        reportTimer = make_timer_fd(reportInterval);
+        event.data.ptr = &reportTimer;
+        if (epoll_ctl(epoll,EPOLL_CTL_ADD,reportTimer,&event) == -1)
+        {
+            fatal_error("epoll_ctl");
+        }
+    }
+}
+
+/**
+ * handles an event of the signal file descriptor, the report timer, or stopFd.
+ *
+ * @function   handle_control_event
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       SIGINT and SIGTERM are read from the signal file descriptor in
+ *   the event loop, rather than handled asynchronously, so the statistics are
+ *   printed from a known state once the event loop has stopped.
+ *
+ * @signature  bool handle_control_event(const struct epoll_event* event)
+ *
+ * @param      event event reported by epoll_wait.
+ *
+ * @return     true if the event was of a control file descriptor, and has
+ *   been handled; false otherwise.
+ */
+bool handle_control_event(const struct epoll_event* event)
+{
+    // stop on SIGINT or SIGTERM
+    if (event->data.ptr == &signalFd)
+    {
+        struct signalfd_siginfo info;
+        if (read(signalFd,&info,sizeof(info)) == sizeof(info))
+        {
+            isWorkerRunning = false;
+        }
+        errno = 0;
+        return true;
+    }
+
+    // stop when the reporting thread says so; stopFd is left readable, so
+    // that every worker thread sees it
+    if (event->data.ptr == &stopFd)
+    {
+        isWorkerRunning = false;
+        return true;
+    }
+
+    // report on the interval that just finished
+    if (event->data.ptr == &reportTimer)
+    {
+        uint64_t expirations;
+        if (read(reportTimer,&expirations,sizeof(expirations)) == sizeof(expirations))
+        {
+            print_interval_statistics();
+        }
+        errno = 0;
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * writes echo requests to a client's socket until the socket is full, the
+ *   pipeline is pipelineDepth requests deep, or all timesToRetransmit requests
+ *   of the session have been sent.
+ *
+ * @function   send_requests
+ *
+ * @date       2026-10-16
+ *
+ * @revision   2026-10-16 Eric Tsang - returns false instead of exiting if the
+ *   server closed or reset the connection.
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       each request is recorded in the client's ring of outstanding
+ *   requests when it is started, so its latency can be measured once the last
+ *   of its bytes has been echoed back. in framed mode, a request is a length
+ *   prefix and a message as long as the request size; the prefix and the
+ *   message go out with one call.
+ *
+ * @signature  bool send_requests(struct worker_t* worker,
+ *   struct client_t* clientPtr)
+ *
+ * @param      worker worker that manages the client.
+ * @param      clientPtr client to send requests for.
+ *
+ * @return     false if the server closed or reset the connection, true
+ *   otherwise.
+ */
+bool send_requests(struct worker_t* worker,struct client_t* clientPtr)
+{
+    while (true)
+    {
+        // start a new request if the last one was written out completely
+        if (clientPtr->bytesSent == clientPtr->requestLen)
+        {
+            if (clientPtr->timesTransmitted >= worker->timesToRetransmit ||
+                clientPtr->timesTransmitted-clientPtr->timesEchoed >= worker->pipelineDepth)
+            {
+                return true;
+            }
+
+            // update statistics
+            if (clientPtr->timesTransmitted == 0)
+                increment_session_count();
+
+            // update client structure
+            clientPtr->requestLen = size_dist_at(worker->sizes,worker->nextRequestIndex++);
+            if (isFramed) clientPtr->requestLen += FRAME_HEADER_LEN;
+            clientPtr->bytesSent = 0;
+            struct request_t* request = clientPtr->requests+clientPtr->timesTransmitted%worker->pipelineDepth;
+            request->endOffset = clientPtr->sendOffset+clientPtr->requestLen;
+            request->timeSent = current_timestamp_us();
+            clientPtr->timesTransmitted += 1;
+        }
+
+        // write as much of the request as the socket will take; a length
+        // prefix takes the place of the stream bytes under it
+        register int bytesSent;
+        if (isFramed && clientPtr->bytesSent < FRAME_HEADER_LEN)
+        {
+            uint32_t header = htonl(clientPtr->requestLen-FRAME_HEADER_LEN);
+            size_t headerLeft = FRAME_HEADER_LEN-clientPtr->bytesSent;
+            struct iovec iov[2];
+            iov[0].iov_base = (char*) &header+clientPtr->bytesSent;
+            iov[0].iov_len = headerLeft;
+            iov[1].iov_base = (void*) payload_at(worker->payload,clientPtr->streamBase,clientPtr->sendOffset+headerLeft);
+            iov[1].iov_len = clientPtr->requestLen-FRAME_HEADER_LEN;
+            struct msghdr message = msghdr();
+            message.msg_iov = iov;
+            message.msg_iovlen = 2;
+            bytesSent = CYCLE_PROBE(CYCLE_SEND,sendmsg(clientPtr->fd,&message,MSG_NOSIGNAL));
+        }
+        else
+        {
+            const char* data = payload_at(worker->payload,clientPtr->streamBase,clientPtr->sendOffset);
+            bytesSent = CYCLE_PROBE(CYCLE_SEND,send(clientPtr->fd,data,clientPtr->requestLen-clientPtr->bytesSent,MSG_NOSIGNAL));
+        }
+        if (bytesSent == -1)
+        {
+            // socket is full, or a fast open connect is still waiting for
+            // its SYN-ACK; EPOLLOUT will fire again once it can be written
+            if (errno == EWOULDBLOCK || errno == EAGAIN || errno == EINPROGRESS)
+            {
+                errno = 0;
+                return true;
+            }
+
+            // the server closed or reset the connection; the session is over
+            if (errno == ECONNRESET || errno == EPIPE)
+            {
+                errno = 0;
+                return false;
+            }
+            fatal_error("send");
+        }
+        clientPtr->bytesSent += bytesSent;
+        clientPtr->sendOffset += bytesSent;
+    }
+}
+
+/**
+ * creates a new client socket for {clientPtr}, connects it to the remote host,
+ *   and adds it to the worker's epoll event loop. both directions stay armed
+ *   until the connection is closed.
+ *
+ * @function   open_client
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       with fast open, the first requests are sent right away.
+ *
+ * @signature  void open_client(struct worker_t* worker,
+ *   struct client_t* clientPtr)
+ *
+ * @param      worker worker that manages the client.
+ * @param      clientPtr unused client slot to open a connection for.
+ */
+void open_client(struct worker_t* worker,struct client_t* clientPtr)
+{
+    // clear client data so the new client socket can make use of it
+    struct request_t* clientRequests = clientPtr->requests;
+    frame_reader_destroy(&clientPtr->reader);
+    memset(clientPtr,0,sizeof(struct client_t));
+    clientPtr->requests = clientRequests;
+    frame_reader_init(&clientPtr->reader,worker->sizes->maxSize);
+
+    // update statistics
+    clientPtr->timeSynSent = current_timestamp();
+    clientPtr->connectionId = worker->nextConnectionId++;
+    clientPtr->streamBase = payload_stream_base(worker->payload,clientPtr->connectionId);
+    stats_add(&stats->totalConnectCount,1);
+
+    // create and add a new client socket to event loop
+    struct epoll_event event = epoll_event();
+    event.events = EPOLLIN|EPOLLOUT|EPOLLERR|EPOLLHUP|EPOLLET;
+    event.data.ptr = (void*) clientPtr;
+    for (register int i = 0; i < 10; ++i)
+    {
+        clientPtr->fd = CYCLE_PROBE(CYCLE_CONNECT,make_tcp_client_socket(worker->remoteName,0,worker->remotePort,0,true)).fd;
+        if (clientPtr->fd >= 0) break;
+    }
+    if (CYCLE_PROBE(CYCLE_EPOLL_CTL,epoll_ctl(worker->epoll,EPOLL_CTL_ADD,clientPtr->fd,&event)) == -1)
+    {
+        fatal_error("epoll_ctl");
+    }
+
+    // with fast open, the SYN goes out with the first request, so send it now
+    // rather than waiting for EPOLLOUT; if the connection is refused or reset,
+    // epoll reports it
+    if (isFastOpen)
+    {
+        send_requests(worker,clientPtr);
+    }
+}
+
+/**
+ * closes the connection of {clientPtr} before its session is finished, and
+ *   leaves the slot unused.
+ *
+ * @function   abort_client
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       used when the load schedule ramps down.
+ *
+ * @signature  void abort_client(struct client_t* clientPtr)
+ *
+ * @param      clientPtr client slot to close the connection of.
+ */
+void abort_client(struct client_t* clientPtr)
+{
+    if (clientPtr->fd >= 0)
+    {
+        CYCLE_PROBE(CYCLE_CLOSE,close(clientPtr->fd));
+        clientPtr->fd = -1;
+    }
+    frame_reader_destroy(&clientPtr->reader);
+    if (clientPtr->timesTransmitted > 0)
+    {
+        stats_add(&stats->sessionCount,-1);
+        stats->abortedSessionCount++;
+    }
+}
+
+/**
+ * closes the connection of {clientPtr} that the server closed or reset before
+ *   its session was finished, and opens a new one in its place.
+ *
+ * @function   reopen_client
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the slot stays in use, so the worker keeps as many clients open
+ *   as the load schedule wants.
+ *
+ * @signature  void reopen_client(struct worker_t* worker,
+ *   struct client_t* clientPtr)
+ *
+ * @param      worker worker that manages the client.
+ * @param      clientPtr client slot whose connection ended.
+ */
+void reopen_client(struct worker_t* worker,struct client_t* clientPtr)
+{
+    CYCLE_PROBE(CYCLE_CLOSE,close(clientPtr->fd));
+    clientPtr->fd = -1;
+    if (clientPtr->timesTransmitted > 0)
+    {
+        stats_add(&stats->sessionCount,-1);
+        stats->droppedSessionCount++;
+    }
+    open_client(worker,clientPtr);
+}
+
+/**
+ * takes a snapshot of the statistics at the start of the worker's current
+ *   phase, so that print_phase_statistics can report on the phase alone.
+ *
+ * @function   start_phase
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  void start_phase(struct worker_t* worker)
+ *
+ * @param      worker worker that is starting its current phase.
+ */
+void start_phase(struct worker_t* worker)
+{
+    worker->phaseStartTime = current_timestamp();
+    worker->rampEndTime = 0;
+    worker->phaseStartClients = worker->openClients;
+    worker->phaseStartSessions = stats->totalSessionCount;
+    worker->phaseStartConnects = stats->totalConnectCount;
+    worker->phaseStartRequests = stats->totalRequestCount;
+    worker->phaseStartAborted = stats->abortedSessionCount;
+    worker->phaseStartDropped = stats->droppedSessionCount;
+    worker->phaseStartCorrupt = stats->corruptSessionCount;
+    worker->phaseStartLatency = stats->avgRequestLatency*stats->totalRequestCount;
+    stats->phaseMaxRequestLatency = 0;
+}
+
+/**
+ * prints the statistics of the worker's current phase to stdout.
+ *
+ * @function   print_phase_statistics
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  void print_phase_statistics(struct worker_t* worker)
+ *
+ * @param      worker worker whose current phase just finished.
+ */
+void print_phase_statistics(struct worker_t* worker)
+{
+    const struct phase_t* phase = worker->schedule.phases+worker->phaseIndex;
+    double phaseRuntime = (double) (current_timestamp()-worker->phaseStartTime);
+    if (phaseRuntime <= 0) phaseRuntime = 1;
+    unsigned long requests = stats->totalRequestCount-worker->phaseStartRequests;
+
+    printStatsLock->wait();
+
+    printf("\n[%lu] worker %d phase %lu/%lu: %u clients, ramp %lf per second, hold %li ms\n",(unsigned long) getpid(),worker->workerIndex,
+        (unsigned long) worker->phaseIndex+1,(unsigned long) worker->schedule.count,phase->targetClients,phase->rampRate,phase->holdTime);
+    printf("      phaseRuntime: %.0lf ms\n",phaseRuntime);
+    printf("      sessionsRate: %lf sessions served per second\n",(stats->totalSessionCount-worker->phaseStartSessions)*1000/phaseRuntime);
+    printf("      connectsRate: %lf connects per second\n",(stats->totalConnectCount-worker->phaseStartConnects)*1000/phaseRuntime);
+    printf("      requestsRate: %lf requests served per second\n",requests*1000/phaseRuntime);
+    printf(" avgRequestLatency: %lf us\n",requests ? (stats->avgRequestLatency*stats->totalRequestCount-worker->phaseStartLatency)/requests : 0.0);
+    printf(" maxRequestLatency: %lf us\n",stats->phaseMaxRequestLatency);
+    printf("abortedSessionCount: %li\n",stats->abortedSessionCount-worker->phaseStartAborted);
+    printf("droppedSessionCount: %li\n",stats->droppedSessionCount-worker->phaseStartDropped);
+    printf("corruptSessionCount: %li\n",stats->corruptSessionCount-worker->phaseStartCorrupt);
+    fflush(stdout);
+
+    printStatsLock->post();
+}
+
+/**
+ * opens or closes client connections as the worker's load schedule dictates,
+ *   and moves on to the next phase once the current one is over. the process
+ *   prints its statistics and exits once the last phase is over.
+ *
+ * @function   run_schedule
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       called on every tick of the worker's schedule timer. connections
+ *   are always opened and closed at the top of the clients array, so the
+ *   first openClients slots are the ones in use.
+ *
+ * @signature  void run_schedule(struct worker_t* worker)
+ *
+ * @param      worker worker to run the schedule of.
+ */
+void run_schedule(struct worker_t* worker)
+{
+    while (true)
+    {
+        const struct phase_t* phase = worker->schedule.phases+worker->phaseIndex;
+        long now = current_timestamp();
+
+        // work out how many clients should be open by now
+        unsigned int desiredClients = phase->targetClients;
+        if (phase->rampRate > 0)
+        {
+            unsigned long ramped = (unsigned long) (phase->rampRate*(now-worker->phaseStartTime)/1000);
+            if (worker->phaseStartClients < phase->targetClients)
+            {
+                if (worker->phaseStartClients+ramped < phase->targetClients)
+                    desiredClients = worker->phaseStartClients+ramped;
+            }
+            else
+            {
+                if (worker->phaseStartClients > phase->targetClients+ramped)
+                    desiredClients = worker->phaseStartClients-ramped;
+            }
+        }
+
+        // ramp up or down towards it
+        while (worker->openClients < desiredClients)
+        {
+            struct client_t* clientPtr = worker->clients+worker->openClients++;
+            open_client(worker,clientPtr);
+        }
+        while (worker->openClients > desiredClients)
+        {
+            struct client_t* clientPtr = worker->clients+--worker->openClients;
+            abort_client(clientPtr);
+        }
+
+        // hold the load once the ramp is done
+        if (desiredClients != phase->targetClients)
+        {
+            return;
+        }
+        if (worker->rampEndTime == 0)
+        {
+            worker->rampEndTime = now;
+        }
+        if (phase->holdTime < 0 || now-worker->rampEndTime < phase->holdTime)
+        {
+            return;
+        }
+
+        // phase is over; report on it and move on to the next one
+        print_phase_statistics(worker);
+        if (++worker->phaseIndex >= worker->schedule.count)
+        {
+            isWorkerRunning = false;
+            return;
+        }
+        start_phase(worker);
+    }
+}
+
+/**
+ * manages a number of clients that continuously connect and make echo requests
+ *   to the remote server.
+ *
+ * @function   child_process
+ *
+ * @date       2016-02-14
+ *
+ * @revision   2026-10-16 Eric Tsang - requests are pipelined; both EPOLLIN and
+ *   EPOLLOUT stay armed for the lifetime of each connection.
+ *
+ * @revision   2026-10-16 Eric Tsang - clients are opened and closed following
+ *   a load schedule, instead of all at once.
+ *
+ * @revision   2026-10-16 Eric Tsang - returns once the worker is stopped, so it
+ *   can also run in a worker thread; statistics are recorded into stats.
+ *
+ * @revision   2026-10-16 Eric Tsang - times its system calls with cycle
+ *   probes, and prints them before returning when built with them.
+ *
+ * @revision   2026-10-16 Eric Tsang - records perf counters into stats.
+ *
+ * @revision   2026-10-16 Eric Tsang - a connection that is reset is counted
+ *   as a dropped session, and a new one is opened in its place.
+ *
+ * @revision   2026-10-16 Eric Tsang - so is a connection the server closes
+ *   before its session is finished, instead of exiting.
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  int child_process(char* remoteName,int remotePort,
+ *   const struct schedule_t* schedule,const struct payload_t* payload,
+ *   const struct size_dist_t* sizes,unsigned int timesToRetransmit,
+ *   unsigned int pipelineDepth,int workerIndex,int numWorkers)
+ *
+ * @param      remoteName name of the remote host to connect to.
+ * @param      remotePort port of the remote host to connect to.
+ * @param      schedule load schedule of the whole run; this process runs its
+ *   share of it.
+ * @param      payload payload that each client's stream of echo requests is
+ *   made of.
+ * @param      sizes distribution of echo request sizes.
+ * @param      timesToRetransmit number of echo requests to make for each
+ *   connection.
+ * @param      pipelineDepth maximum number of echo requests in flight on each
+ *   connection.
+ * @param      workerIndex index of this worker; used to give every connection
+ *   of the run a unique identifier.
+ * @param      numWorkers number of worker processes or threads the schedule
+ *   is split between.
+ *
+ * @return     exit code of this process.
+ */
+int child_process(char* remoteName,int remotePort,const struct schedule_t* schedule,const struct payload_t* payload,const struct size_dist_t* sizes,unsigned int timesToRetransmit,unsigned int pipelineDepth,int workerIndex,int numWorkers)
+{
+    // set up the worker's state
+    struct worker_t worker;
+    memset(&worker,0,sizeof(worker));
+    worker.workerIndex = workerIndex;
+    worker.remoteName = remoteName;
+    worker.remotePort = remotePort;
+    worker.payload = payload;
+    worker.sizes = sizes;
+    // workers start evenly spread over the table of sizes, so they do not all
+    // send the same sequence of sizes in lockstep
+    worker.nextRequestIndex = (unsigned long) workerIndex*sizes->count/numWorkers;
+    worker.timesToRetransmit = timesToRetransmit;
+    worker.pipelineDepth = pipelineDepth;
+    worker.nextConnectionId = (unsigned long) workerIndex << 40;
+    schedule_share(schedule,&worker.schedule,workerIndex,numWorkers);
+
+    unsigned int numClients = schedule_max_clients(&worker.schedule);
+    stats->targetSessionCount = numClients;
+
+    // count the worker's hardware and software events
+    struct perf_group_t perfGroup;
+    perf_open(&perfGroup,false);
+
+    // create epoll file descriptor
+    worker.epoll = epoll_create(EPOLL_QUEUE_LEN);
+    if (worker.epoll == -1)
+    {
+        fatal_error("epoll_create");
+    }
+
+    // watch for shutdown signals, and interval reports
+    add_control_fds(worker.epoll);
+
+    // allocate every client slot, and its ring of outstanding requests up
+    // front; clients are opened into them as the schedule ramps up
+    worker.clients = (struct client_t*) calloc(numClients ? numClients : 1,sizeof(struct client_t));
+    struct request_t* requests = (struct request_t*) calloc((size_t) (numClients ? numClients : 1)*pipelineDepth,sizeof(struct request_t));
+    if (worker.clients == 0 || requests == 0)
+    {
+        fatal_error("calloc");
+    }
+    for (register unsigned int i = 0; i < numClients; ++i)
+    {
+        worker.clients[i].fd = -1;
+        worker.clients[i].requests = requests+(size_t) i*pipelineDepth;
+    }
+
+    // create the timer that drives the load schedule, and add it to the epoll
+    // event loop
+    worker.scheduleTimer = make_timer_fd(SCHEDULE_TICK_LEN);
+    {
+        struct epoll_event event = epoll_event();
+        event.events = EPOLLIN;
+        event.data.ptr = &worker.scheduleTimer;
+        if (epoll_ctl(worker.epoll,EPOLL_CTL_ADD,worker.scheduleTimer,&event) == -1)
+        {
+            fatal_error("epoll_ctl");
+        }
+    }
+
+    // start the first phase right away
+    start_phase(&worker);
+    run_schedule(&worker);
+
+    // execute epoll event loop until the schedule is over, or the worker is
+    // told to stop
+    while (isWorkerRunning)
+    {
+        // wait for epoll to unblock to report socket activity
+        struct epoll_event events[EPOLL_QUEUE_LEN];
+        int eventCount = CYCLE_PROBE(CYCLE_EPOLL_WAIT,epoll_wait(worker.epoll,events,EPOLL_QUEUE_LEN,-1));
+        if (eventCount < 0)
+        {
+            fatal_error("epoll_wait");
+        }
+
+        // epoll unblocked; handle socket activity
+        for (register int i = 0; i < eventCount; i++)
+        {
+            // handling case of a shutdown signal, or an interval report
+            if (handle_control_event(events+i))
+            {
+                continue;
+            }
+
+            // handling case when the schedule timer ticks
+            if (events[i].data.ptr == &worker.scheduleTimer)
+            {
+                uint64_t expirations;
+                if (read(worker.scheduleTimer,&expirations,sizeof(expirations)) == -1 && errno != EAGAIN)
+                {
+                    fatal_error("read");
+                }
+                errno = 0;
+                run_schedule(&worker);
+                continue;
+            }
+
+            struct client_t* clientPtr = (struct client_t*) events[i].data.ptr;
+
+            // ignore events of connections closed earlier in this batch
+            if (clientPtr->fd == -1)
+            {
+                continue;
+            }
+
+            // open a new connection in place of one that was reset
+            if (events[i].events&(EPOLLHUP|EPOLLERR))
+            {
+                reopen_client(&worker,clientPtr);
+                continue;
+            }
 
             // handling case when client socket is available for reading
             if (events[i].events&EPOLLIN)
             {
-                static char buf[ECHO_BUFFER_LEN];
+                char buf[ECHO_BUFFER_LEN];
                 register int bytesRead = 0;
+                bool isEnded = false;
 
                 // read until the socket is empty
                 while (true)
                 {
                     // read data from socket
-                    bytesRead = recv(clientPtr->fd,buf,ECHO_BUFFER_LEN,0);
+                    bytesRead = CYCLE_PROBE(CYCLE_RECV,recv(clientPtr->fd,buf,ECHO_BUFFER_LEN,0));
 
                     // update client structure
                     if (bytesRead > 0)
                     {
-                        clientPtr->bytesReceived += bytesRead;
+                        if (isFramed)
+                            verify_frames(&worker,clientPtr,buf,bytesRead);
+                        else
+                            verify_echo(clientPtr,payload,buf,bytesRead);
+                        clientPtr->recvOffset += bytesRead;
                     }
 
                     // ignore errors: EWOULDBLOCK and EAGAIN
@@ -393,78 +1828,659 @@ int child_process(char* remoteName,int remotePort,int numClients,char* data,unsi
                         break;
                     }
 
-                    // unexpected error or closed; fatal error!
+                    // the server closed or reset the connection
+                    else if (bytesRead == 0 || errno == ECONNRESET)
+                    {
+                        errno = 0;
+                        isEnded = true;
+                        break;
+                    }
+
+                    // unexpected error; fatal error!
                     else
                     {
                         fatal_error("recv");
                     }
                 }
 
-                // handle case when all data has been read, and we need to
-                // retransmit
-                if (clientPtr->bytesReceived >= strlen(data) &&
-                    clientPtr->timesTransmitted < timesToRetransmit)
+                // find out whether the connection's SYN carried data, once the
+                // server has answered
+                if (isFastOpen && !clientPtr->isFastOpenChecked)
                 {
-                    // update client structure
-                    clientPtr->bytesReceived = 0;
+                    record_fast_open(clientPtr);
+                }
+
+                // retire every request that has been echoed back completely
+                long now = current_timestamp_us();
+                while (clientPtr->timesEchoed < clientPtr->timesTransmitted)
+                {
+                    struct request_t* request = clientPtr->requests+clientPtr->timesEchoed%pipelineDepth;
+                    if (clientPtr->recvOffset < request->endOffset)
+                    {
+                        break;
+                    }
+                    record_request_latency((double) (now-request->timeSent));
+                    clientPtr->timesEchoed += 1;
+                }
+
+                // handle case when client should be closed, and a new one
+                // should be opened in its place
+                if (clientPtr->timesEchoed >= timesToRetransmit)
+                {
+                    // update statistics
+                    double serviceTime = (double) (current_timestamp()-clientPtr->timeSynSent);
+                    decrement_session_count(serviceTime);
+
+                    // close the socket
+                    if (CYCLE_PROBE(CYCLE_CLOSE,close(clientPtr->fd)) == -1)
+                    {
+                        fatal_error("close");
+                    }
+
+                    // open a new connection in its place
+                    open_client(&worker,clientPtr);
+                    continue;
+                }
 
-                    // configure to wait for data to be available for writing
-                    static struct epoll_event event = epoll_event();
-                    event.events = EPOLLOUT|EPOLLERR|EPOLLHUP|EPOLLET;
-                    event.data.ptr = (void*) clientPtr;
-                    epoll_ctl(epoll,EPOLL_CTL_MOD,clientPtr->fd,&event);
+                // the server ended the session before it was finished, e.g.
+                // because it is draining, or rejected a request; open a new
+                // connection in its place
+                if (isEnded)
+                {
+                    reopen_client(&worker,clientPtr);
                     continue;
                 }
+            }
+
+            // echoes retired above may have made room in the pipeline, and
+            // EPOLLOUT may have been reported; either way, keep sending
+            if (events[i].events&(EPOLLIN|EPOLLOUT))
+            {
+                if (!send_requests(&worker,clientPtr))
+                {
+                    reopen_client(&worker,clientPtr);
+                }
+            }
+        }
+    }
+
+    // close the connections that are still open
+    for (register unsigned int i = 0; i < worker.openClients; ++i)
+    {
+        if (worker.clients[i].fd >= 0)
+        {
+            close(worker.clients[i].fd);
+        }
+        frame_reader_destroy(&worker.clients[i].reader);
+    }
+    close(worker.scheduleTimer);
+    close(worker.epoll);
+    free(requests);
+    free(worker.clients);
+    free(worker.schedule.phases);
+    perf_read(&perfGroup,&stats->perfCounts);
+    perf_close(&perfGroup);
+
+    // print where the worker's time in system calls went
+#ifdef CYCLE_PROBES
+    char label[32];
+    sprintf(label,"worker %d",workerIndex);
+    cycle_probe_dump(stderr,label);
+#endif
+    return EX_OK;
+}
+
+/**
+ * records the round trip time of an echoed datagram, and updates
+ *   minRoundTripTime, maxRoundTripTime and avgRoundTripTime accordingly.
+ *
+ * @function   record_round_trip_time
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  void record_round_trip_time(double roundTripTime)
+ *
+ * @param      roundTripTime round trip time of the datagram in microseconds.
+ */
+void record_round_trip_time(double roundTripTime)
+{
+    stats_add(&stats->udpReceivedCount,1);
+    if (stats->minRoundTripTime > roundTripTime)
+        stats->minRoundTripTime = roundTripTime;
+    if (stats->maxRoundTripTime < roundTripTime)
+        stats->maxRoundTripTime = roundTripTime;
+    double totalRoundTripTime = stats->avgRoundTripTime*(stats->udpReceivedCount-1)+roundTripTime;
+    stats->avgRoundTripTime = totalRoundTripTime/stats->udpReceivedCount;
+    histogram_record(&stats->latencies,(unsigned long) roundTripTime);
+}
+
+/**
+ * keeps up to {window} datagrams in flight to the remote UDP echo server, and
+ *   accounts for datagrams that are lost or echoed back out of order.
+ *
+ * @function   udp_child_process
+ *
+ * @date       2026-10-16
+ *
+ * @revision   2026-10-16 Eric Tsang - records perf counters into stats.
+ *
+ * @revision   2026-10-16 Eric Tsang - echoes of datagrams sent before the
+ *   window was last reset no longer count against the new window.
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       every datagram starts with a udp_header_t carrying a sequence
+ *   number and a send time stamp. datagrams are sent in batches with sendmmsg
+ *   (or as one GSO super-datagram), and echoes are drained with recvmmsg.
+ *
+ * @signature  int udp_child_process(char* remoteName,int remotePort,
+ *   int window,const char* data,unsigned int dataLen,bool useSegmentOffload)
+ *
+ * @param      remoteName name of the remote host to send datagrams to.
+ * @param      remotePort port of the remote host to send datagrams to.
+ * @param      window maximum number of datagrams in flight for this process.
+ * @param      data data to send after the header of each datagram.
+ * @param      dataLen number of bytes of {data} to send in each datagram.
+ * @param      useSegmentOffload true to send batches with UDP GSO and receive
+ *   echoes with UDP GRO; false otherwise.
+ *
+ * @return     exit code of this process.
+ */
+int udp_child_process(char* remoteName,int remotePort,int window,const char* data,unsigned int dataLen,bool useSegmentOffload)
+{
+    udpMode = true;
+    stats->targetSessionCount = window;
+
+    // count the worker's hardware and software events
+    struct perf_group_t perfGroup;
+    perf_open(&perfGroup,false);
+
+    // every datagram is the header followed by as much data as will fit
+    unsigned int datagramLen = sizeof(udp_header_t)+dataLen;
+    if (datagramLen > UDP_DATAGRAM_MAX)
+    {
+        datagramLen = UDP_DATAGRAM_MAX;
+    }
+
+    // number of datagrams to send per system call
+    int batchLen = UDP_BATCH_LEN;
+    if (useSegmentOffload && batchLen > (int) (UINT16_MAX/2/datagramLen))
+    {
+        batchLen = UINT16_MAX/2/datagramLen;
+    }
+
+    // create the UDP socket connected to the server
+    int udpSocket = make_udp_client_socket(remoteName,0,remotePort,0,true).fd;
+    if (udpSocket == -1)
+    {
+        fatal_error("socket");
+    }
+
+    // let the kernel coalesce echoed datagrams into one buffer
+    if (useSegmentOffload)
+    {
+        int arg = 1;
+        if (setsockopt(udpSocket,SOL_UDP,UDP_GRO,&arg,sizeof(arg)) == -1)
+        {
+            fatal_error("setsockopt UDP_GRO");
+        }
+    }
+
+    // create epoll file descriptor
+    int epoll = epoll_create(EPOLL_QUEUE_LEN);
+    if (epoll == -1)
+    {
+        fatal_error("epoll_create");
+    }
+
+    // watch for shutdown signals, and interval reports
+    add_control_fds(epoll);
+
+    // add the socket to the epoll event loop
+    {
+        struct epoll_event event = epoll_event();
+        event.events = EPOLLIN|EPOLLOUT|EPOLLERR|EPOLLET;
+        event.data.ptr = &udpSocket;
+        if (epoll_ctl(epoll,EPOLL_CTL_ADD,udpSocket,&event) == -1)
+        {
+            fatal_error("epoll_ctl");
+        }
+    }
+
+    // lay out the outgoing datagrams back to back, so that a batch can also be
+    // handed to the kernel as a single GSO buffer
+    static char txBlock[UDP_BATCH_LEN*UDP_DATAGRAM_MAX];
+    static struct iovec txIovecs[UDP_BATCH_LEN];
+    static struct mmsghdr txMsgs[UDP_BATCH_LEN];
+    static char txControl[CMSG_SPACE(sizeof(uint16_t))];
+    for (register int i = 0; i < UDP_BATCH_LEN; ++i)
+    {
+        memcpy(txBlock+i*datagramLen+sizeof(udp_header_t),data,datagramLen-sizeof(udp_header_t));
+        txIovecs[i].iov_base = txBlock+i*datagramLen;
+        txIovecs[i].iov_len = datagramLen;
+        txMsgs[i].msg_hdr.msg_iov = txIovecs+i;
+        txMsgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    // pre-register the receive buffers
+    static char rxBufs[UDP_BATCH_LEN][UDP_BUFFER_LEN];
+    static struct iovec rxIovecs[UDP_BATCH_LEN];
+    static char rxControls[UDP_BATCH_LEN][CMSG_SPACE(sizeof(int))];
+    static struct mmsghdr rxMsgs[UDP_BATCH_LEN];
+    for (register int i = 0; i < UDP_BATCH_LEN; ++i)
+    {
+        rxIovecs[i].iov_base = rxBufs[i];
+        rxIovecs[i].iov_len = UDP_BUFFER_LEN;
+        rxMsgs[i].msg_hdr.msg_iov = rxIovecs+i;
+        rxMsgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    // sequence number of the next datagram to send
+    uint64_t nextSeq = 0;
+    // highest sequence number echoed back so far
+    uint64_t highestSeq = 0;
+    // sequence number of the first datagram sent since the window was last
+    // reset; those before it are no longer counted as in flight
+    uint64_t windowStartSeq = 0;
+    // time stamp taken when the last echo arrived, or the window was reset
+    long lastEchoTime = current_timestamp_us();
+
+    // execute epoll event loop until the worker is told to stop
+    while (isWorkerRunning)
+    {
+        // top up the send window
+        while (stats->udpInFlightCount < window)
+        {
+            int batch = window-stats->udpInFlightCount < batchLen ? window-stats->udpInFlightCount : batchLen;
+            uint64_t now = current_timestamp_us();
+            for (register int i = 0; i < batch; ++i)
+            {
+                struct udp_header_t header;
+                header.seq = nextSeq+i;
+                header.timeSent = now;
+                memcpy(txBlock+i*datagramLen,&header,sizeof(header));
+            }
+
+            // send the batch as one GSO buffer, or as a vector of datagrams
+            int sent;
+            if (useSegmentOffload)
+            {
+                struct iovec iov;
+                iov.iov_base = txBlock;
+                iov.iov_len = batch*datagramLen;
+                struct msghdr msg;
+                memset(&msg,0,sizeof(msg));
+                msg.msg_iov = &iov;
+                msg.msg_iovlen = 1;
+                msg.msg_control = txControl;
+                msg.msg_controllen = sizeof(txControl);
+                struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+                cmsg->cmsg_level = SOL_UDP;
+                cmsg->cmsg_type = UDP_SEGMENT;
+                cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+                uint16_t gsoSize = (uint16_t) datagramLen;
+                memcpy(CMSG_DATA(cmsg),&gsoSize,sizeof(gsoSize));
+                sent = sendmsg(udpSocket,&msg,0) == -1 ? -1 : batch;
+            }
+            else
+            {
+                sent = sendmmsg(udpSocket,txMsgs,batch,0);
+            }
+
+            // stop when the socket send buffer is full
+            if (sent == -1)
+            {
+                if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS || errno == ECONNREFUSED)
+                {
+                    errno = 0;
+                    break;
+                }
+                fatal_error("sendmmsg");
+            }
+
+            if (stats->udpInFlightCount == 0)
+            {
+                lastEchoTime = current_timestamp_us();
+            }
+            nextSeq += sent;
+            stats_add(&stats->udpInFlightCount,sent);
+            stats->udpSentCount += sent;
+            if (sent < batch)
+            {
+                break;
+            }
+        }
+
+        // wait for epoll to unblock to report socket activity
+        static struct epoll_event events[EPOLL_QUEUE_LEN];
+        static int eventCount;
+        eventCount = epoll_wait(epoll,events,EPOLL_QUEUE_LEN,UDP_LOSS_TIMEOUT);
+        if (eventCount < 0)
+        {
+            fatal_error("epoll_wait");
+        }
+
+        // handle shutdown signals, and interval reports
+        bool isSocketReady = false;
+        for (register int i = 0; i < eventCount; ++i)
+        {
+            if (!handle_control_event(events+i))
+            {
+                isSocketReady = true;
+            }
+        }
+
+        // nothing came back in time; presume everything in flight is lost
+        if (!isSocketReady)
+        {
+            if (stats->udpInFlightCount > 0 && current_timestamp_us()-lastEchoTime >= UDP_LOSS_TIMEOUT*1000L)
+            {
+                stats->udpLossTimeoutCount++;
+                __atomic_store_n(&stats->udpInFlightCount,0,__ATOMIC_RELAXED);
+                windowStartSeq = nextSeq;
+            }
+            continue;
+        }
+
+        // drain the socket one batch at a time
+        while (true)
+        {
+            // reset the fields that recvmmsg overwrites
+            for (register int i = 0; i < UDP_BATCH_LEN; ++i)
+            {
+                rxMsgs[i].msg_hdr.msg_control = useSegmentOffload ? rxControls[i] : 0;
+                rxMsgs[i].msg_hdr.msg_controllen = useSegmentOffload ? sizeof(rxControls[i]) : 0;
+            }
+
+            // receive a batch of datagrams
+            int received = recvmmsg(udpSocket,rxMsgs,UDP_BATCH_LEN,0,0);
+            if (received == -1)
+            {
+                // ICMP port unreachable is reported through the socket; the
+                // datagrams involved will be accounted for as lost
+                if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ECONNREFUSED)
+                {
+                    errno = 0;
+                    break;
+                }
+                fatal_error("recvmmsg");
+            }
+
+            // account for each echoed datagram, splitting up coalesced ones
+            uint64_t now = current_timestamp_us();
+            if (received > 0)
+            {
+                lastEchoTime = now;
+            }
+            for (register int i = 0; i < received; ++i)
+            {
+                unsigned int msgLen = rxMsgs[i].msg_len;
+                unsigned int segmentSize = msgLen;
+                struct msghdr* rx = &rxMsgs[i].msg_hdr;
+                for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(rx); cmsg != 0; cmsg = CMSG_NXTHDR(rx,cmsg))
+                {
+                    if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO)
+                    {
+                        int gsoSize;
+                        memcpy(&gsoSize,CMSG_DATA(cmsg),sizeof(gsoSize));
+                        segmentSize = gsoSize;
+                    }
+                }
+
+                for (unsigned int offset = 0; offset+sizeof(udp_header_t) <= msgLen; offset += segmentSize)
+                {
+                    struct udp_header_t header;
+                    memcpy(&header,rxBufs[i]+offset,sizeof(header));
+
+                    if (header.seq < highestSeq)
+                        stats->udpReorderedCount++;
+                    else
+                        highestSeq = header.seq;
+
+                    // an echo of a datagram presumed lost is still received,
+                    // but it is not in flight any more
+                    if (header.seq >= windowStartSeq && stats->udpInFlightCount > 0)
+                        stats_add(&stats->udpInFlightCount,-1);
+                    record_round_trip_time((double) (now-header.timeSent));
+                }
+            }
+
+            // a short batch means the socket was empty when we read it
+            if (received < UDP_BATCH_LEN)
+            {
+                break;
+            }
+        }
+    }
+    perf_read(&perfGroup,&stats->perfCounts);
+    perf_close(&perfGroup);
+    return EX_OK;
+}
+
+/**
+ * arguments of a worker thread; see child_process.
+ */
+struct worker_args_t
+{
+    char* remoteName;
+    int remotePort;
+    const struct schedule_t* schedule;
+    const struct payload_t* payload;
+    const struct size_dist_t* sizes;
+    unsigned int timesToRetransmit;
+    unsigned int pipelineDepth;
+    int workerIndex;
+    int numWorkers;
+    // statistics slot owned by the thread
+    struct stats_t* slot;
+};
+
+/**
+ * entry point of a worker thread. runs child_process until the reporting
+ *   thread stops it, or its share of the load schedule is over.
+ *
+ * @function   worker_thread
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  void* worker_thread(void* args)
+ *
+ * @param      args pointer to the worker_args_t of the thread.
+ *
+ * @return     nothing.
+ */
+void* worker_thread(void* args)
+{
+    struct worker_args_t* workerArgs = (struct worker_args_t*) args;
+    isWorkerThread = true;
+    stats = workerArgs->slot;
 
-                // handle case when client should be closed, and a new one
-                // should be opened in its place
-                if (clientPtr->bytesReceived >= strlen(data) &&
-                    clientPtr->timesTransmitted >= timesToRetransmit)
-                {
+    child_process(workerArgs->remoteName,workerArgs->remotePort,workerArgs->schedule,workerArgs->payload,workerArgs->sizes,
+        workerArgs->timesToRetransmit,workerArgs->pipelineDepth,workerArgs->workerIndex,workerArgs->numWorkers);
 
-                    // update statistics
-                    double serviceTime = (double) (current_timestamp()-clientPtr->timeSynSent);
-                    decrement_session_count(serviceTime);
+    // let the reporting thread know this worker has stopped
+    uint64_t one = 1;
+    if (write(doneFd,&one,sizeof(one)) == -1)
+    {
+        fatal_error("write");
+    }
+    return 0;
+}
 
-                    // close the socket
-                    if (close(clientPtr->fd) == -1)
-                    {
-                        fatal_error("close");
-                    }
+/**
+ * runs {numThreads} worker threads that each manage their own epoll event
+ *   loop and share of the clients, and reports for all of them.
+ *
+ * @function   thread_process
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       worker threads record their statistics into statsSlots without
+ *   locks. the calling thread merges them for interval reports as the threads
+ *   run, and for the final report once they have been joined.
+ *
+ * @signature  int thread_process(char* remoteName,int remotePort,
+ *   const struct schedule_t* schedule,const struct payload_t* payload,
+ *   const struct size_dist_t* sizes,unsigned int timesToRetransmit,
+ *   unsigned int pipelineDepth,int processIndex,int numWorkerProcesses,
+ *   int numThreads)
+ *
+ * @param      remoteName name of the remote host to connect to.
+ * @param      remotePort port of the remote host to connect to.
+ * @param      schedule load schedule of the whole run.
+ * @param      payload payload that each client's stream of echo requests is
+ *   made of.
+ * @param      sizes distribution of echo request sizes.
+ * @param      timesToRetransmit number of echo requests to make for each
+ *   connection.
+ * @param      pipelineDepth maximum number of echo requests in flight on each
+ *   connection.
+ * @param      processIndex index of this worker process.
+ * @param      numWorkerProcesses number of worker processes.
+ * @param      numThreads number of worker threads to run in this process.
+ *
+ * @return     exit code of this process.
+ */
+int thread_process(char* remoteName,int remotePort,const struct schedule_t* schedule,const struct payload_t* payload,const struct size_dist_t* sizes,unsigned int timesToRetransmit,unsigned int pipelineDepth,int processIndex,int numWorkerProcesses,int numThreads)
+{
+    // allocate a cache line aligned statistics slot for every worker thread
+    void* slots;
+    if (posix_memalign(&slots,CACHE_LINE_LEN,numThreads*sizeof(struct stats_t)) != 0)
+    {
+        fatal_error("posix_memalign");
+    }
+    statsSlots = (struct stats_t*) slots;
+    numStatsSlots = numThreads;
+    for (register int i = 0; i < numThreads; ++i)
+    {
+        stats_init(statsSlots+i);
+    }
 
-                    // clear client data so the new client socket can make use
-                    // of it
-                    memset(clientPtr,0,sizeof(struct client_t));
+    // create the event file descriptors that stop the worker threads, and
+    // count the ones that have stopped
+    stopFd = eventfd(0,EFD_NONBLOCK);
+    doneFd = eventfd(0,EFD_NONBLOCK);
+    if (stopFd == -1 || doneFd == -1)
+    {
+        fatal_error("eventfd");
+    }
 
-                    // update statistics
-                    clientPtr->timeSynSent = current_timestamp();
+    // create the reporting thread's own epoll event loop
+    int epoll = epoll_create(EPOLL_QUEUE_LEN);
+    if (epoll == -1)
+    {
+        fatal_error("epoll_create");
+    }
+    add_control_fds(epoll);
+    {
+        struct epoll_event event = epoll_event();
+        event.events = EPOLLIN;
+        event.data.ptr = &doneFd;
+        if (epoll_ctl(epoll,EPOLL_CTL_ADD,doneFd,&event) == -1)
+        {
+            fatal_error("epoll_ctl");
+        }
+    }
 
-                    // create and add a new client socket to event loop
-                    static struct epoll_event event = epoll_event();
-                    event.events = EPOLLOUT|EPOLLERR|EPOLLHUP|EPOLLET;
-                    event.data.ptr = (void*) clientPtr;
-                    for (register int i = 0; i < 10; ++i)
-                    {
-                        clientPtr->fd = make_tcp_client_socket(remoteName,0,remotePort,0,true).fd;
-                        if (clientPtr->fd >= 0) break;
-                    }
-                    if (epoll_ctl(epoll,EPOLL_CTL_ADD,clientPtr->fd,&event) == -1)
-                    {
-                        fatal_error("epoll_ctl");
-                    }
-                    continue;
-                }
+    // start the worker threads
+    pthread_t* threads = (pthread_t*) calloc(numThreads,sizeof(pthread_t));
+    struct worker_args_t* workerArgs = (struct worker_args_t*) calloc(numThreads,sizeof(struct worker_args_t));
+    if (threads == 0 || workerArgs == 0)
+    {
+        fatal_error("calloc");
+    }
+    for (register int i = 0; i < numThreads; ++i)
+    {
+        workerArgs[i].remoteName = remoteName;
+        workerArgs[i].remotePort = remotePort;
+        workerArgs[i].schedule = schedule;
+        workerArgs[i].payload = payload;
+        workerArgs[i].sizes = sizes;
+        workerArgs[i].timesToRetransmit = timesToRetransmit;
+        workerArgs[i].pipelineDepth = pipelineDepth;
+        workerArgs[i].workerIndex = processIndex*numThreads+i;
+        workerArgs[i].numWorkers = numWorkerProcesses*numThreads;
+        workerArgs[i].slot = statsSlots+i;
+        int result = pthread_create(threads+i,0,worker_thread,workerArgs+i);
+        if (result != 0)
+        {
+            errno = result;
+            fatal_error("pthread_create");
+        }
+    }
 
-                // handle case when there should be more data to read
-                if (clientPtr->bytesReceived < strlen(data))
+    // report until a shutdown signal arrives, or every worker thread stops
+    int numThreadsDone = 0;
+    while (isWorkerRunning && numThreadsDone < numThreads)
+    {
+        struct epoll_event events[4];
+        int eventCount = epoll_wait(epoll,events,4,-1);
+        if (eventCount < 0)
+        {
+            fatal_error("epoll_wait");
+        }
+        for (register int i = 0; i < eventCount; ++i)
+        {
+            if (events[i].data.ptr == &doneFd)
+            {
+                uint64_t count;
+                if (read(doneFd,&count,sizeof(count)) == sizeof(count))
                 {
-                    continue;
+                    numThreadsDone += (int) count;
                 }
-
-                fatal_error("should not reach this point in code!");
+                errno = 0;
+                continue;
             }
+            handle_control_event(events+i);
         }
     }
+
+    // stop the worker threads, and wait for them
+    uint64_t one = 1;
+    if (write(stopFd,&one,sizeof(one)) == -1)
+    {
+        fatal_error("write");
+    }
+    for (register int i = 0; i < numThreads; ++i)
+    {
+        pthread_join(threads[i],0);
+    }
+
+    // print the merged statistics of all worker threads
+    static struct stats_t totals;
+    stats_init(&totals);
+    for (register int i = 0; i < numThreads; ++i)
+    {
+        merge_stats(&totals,statsSlots+i);
+    }
+    print_statistics(&totals,numThreads);
+
+    free(threads);
+    free(workerArgs);
     return EX_OK;
 }
 
@@ -477,13 +2493,15 @@ int child_process(char* remoteName,int remotePort,int numClients,char* data,unsi
  *
  * @date       2016-02-14
  *
- * @revision   none
+ * @revision   2026-10-16 Eric Tsang - waits on a signal file descriptor, so
+ *   SIGINT or SIGTERM also terminate the application, and waits for the child
+ *   processes to print their statistics before returning.
  *
  * @designer   Eric Tsang
  *
  * @programmer Eric Tsang
  *
- * @note       none
+ * @note       SIGINT, SIGTERM and SIGCHLD must already be blocked.
  *
  * @signature  int server_process(int numWorkerProcesses,long timeout)
  *
@@ -495,22 +2513,66 @@ int child_process(char* remoteName,int remotePort,int numClients,char* data,unsi
  */
 int server_process(int numWorkerProcesses,long timeout)
 {
-    // kill all processes of process group after timeout
-    if (timeout > 0)
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals,SIGINT);
+    sigaddset(&signals,SIGTERM);
+    sigaddset(&signals,SIGCHLD);
+    int signalFd = make_signal_fd(&signals);
+
+    long deadline = timeout > 0 ? current_timestamp()+timeout : -1;
+    bool isTerminating = false;
+    int numRunning = numWorkerProcesses;
+    while (true)
     {
-        usleep(timeout*1000);
-        kill(0,SIGINT);
-    }
+        // reap the child processes that have terminated
+        while (numRunning > 0 && waitpid(-1,0,WNOHANG) > 0)
+        {
+            numRunning--;
+        }
+        if (numRunning == 0)
+        {
+            break;
+        }
 
-    // wait for all child processes to terminate
-    else
-    {
-        for (register int i = 0; i < numWorkerProcesses; ++i)
+        // kill all processes of process group after timeout
+        int pollTimeout = -1;
+        if (!isTerminating && deadline >= 0)
+        {
+            long remaining = deadline-current_timestamp();
+            if (remaining <= 0)
+            {
+                kill(0,SIGINT);
+                isTerminating = true;
+                continue;
+            }
+            pollTimeout = (int) remaining;
+        }
+
+        // wait for a signal, or the timeout
+        struct pollfd pollFd;
+        pollFd.fd = signalFd;
+        pollFd.events = POLLIN;
+        pollFd.revents = 0;
+        if (poll(&pollFd,1,pollTimeout) == -1)
+        {
+            fatal_error("poll");
+        }
+
+        // pass SIGINT and SIGTERM on to the child processes
+        struct signalfd_siginfo info;
+        while (read(signalFd,&info,sizeof(info)) == sizeof(info))
         {
-            wait(0);
+            if (info.ssi_signo != SIGCHLD && !isTerminating)
+            {
+                kill(0,SIGINT);
+                isTerminating = true;
+            }
         }
+        errno = 0;
     }
 
+    close(signalFd);
     return EX_OK;
 }
 
@@ -551,18 +2613,50 @@ int main (int argc, char* argv[])
     // number of worker process to create
     int numWorkerProcesses;
 
+    // number of worker threads to run in each worker process
+    int numThreads = 1;
+
     // number of clients to create on each worker process
     int numClients;
 
     // data to send to remote server
-    char* data;
+    char* data = 0;
+
+    // distribution of echo request sizes
+    struct size_dist_t sizes;
+    char* sizesSpec = 0;
+    char* sizesPath = 0;
+
+    // seed of the pseudo-random payload pattern, if one is used
+    unsigned long seed = 0;
+    bool seedInitialized = false;
+
+    // path to a file to load the payload pattern from, if one is used
+    char* payloadPath = 0;
 
     // number of times each client should send their data
     unsigned int timesToRetransmit;
 
+    // number of echo requests each client may have in flight
+    unsigned int pipelineDepth = 1;
+
+    // load schedule to run; by default all clients are held until the end
+    struct schedule_t schedule;
+    char* schedulePath = 0;
+    double rampRate = 0;
+
     // time in milliseconds that clients should run for
     long lifetime;
 
+    // true if the workers should generate UDP load instead of TCP sessions
+    bool isUdp = false;
+
+    // true if UDP workers should use GSO on send and GRO on receive
+    bool useSegmentOffload = false;
+
+    // path to a CSV file to append interval reports to, if one is used
+    char* reportPath = 0;
+
     // parse command line arguments
     {
         char option;
@@ -573,7 +2667,7 @@ int main (int argc, char* argv[])
         bool dataInitialized = false;
         bool timesToRetransmitInitialized = false;
         bool lifetimeInitialized = false;
-        while ((option = getopt(argc,argv,"h:p:n:c:d:r:t:")) != -1)
+        while ((option = getopt(argc,argv,"h:p:n:T:c:d:r:t:ugs:f:l:L:P:S:R:i:w:O:m")) != -1)
         {
             switch (option)
             {
@@ -659,6 +2753,118 @@ int main (int argc, char* argv[])
                     }
                     break;
                 }
+            case 's':
+                {
+                    char* parsedCursor = optarg;
+                    seed = strtoul(optarg,&parsedCursor,10);
+                    if (parsedCursor == optarg)
+                    {
+                        fprintf(stderr,"invalid argument for option -%c\n",option);
+                    }
+                    else
+                    {
+                        seedInitialized = true;
+                    }
+                    break;
+                }
+            case 'f':
+                {
+                    payloadPath = optarg;
+                    break;
+                }
+            case 'P':
+                {
+                    char* parsedCursor = optarg;
+                    pipelineDepth = (unsigned int) strtoul(optarg,&parsedCursor,10);
+                    if (parsedCursor == optarg || pipelineDepth == 0)
+                    {
+                        fprintf(stderr,"invalid argument for option -%c\n",option);
+                        pipelineDepth = 1;
+                    }
+                    break;
+                }
+            case 'T':
+                {
+                    char* parsedCursor = optarg;
+                    numThreads = (int) strtol(optarg,&parsedCursor,10);
+                    if (parsedCursor == optarg || numThreads < 1)
+                    {
+                        fprintf(stderr,"invalid argument for option -%c\n",option);
+                        numThreads = 1;
+                    }
+                    break;
+                }
+            case 'i':
+                {
+                    char* parsedCursor = optarg;
+                    reportInterval = strtol(optarg,&parsedCursor,10);
+                    if (parsedCursor == optarg || reportInterval <= 0)
+                    {
+                        fprintf(stderr,"invalid argument for option -%c\n",option);
+                        reportInterval = 0;
+                    }
+                    break;
+                }
+            case 'w':
+                {
+                    reportPath = optarg;
+                    break;
+                }
+            case 'S':
+                {
+                    schedulePath = optarg;
+                    break;
+                }
+            case 'R':
+                {
+                    char* parsedCursor = optarg;
+                    rampRate = strtod(optarg,&parsedCursor);
+                    if (parsedCursor == optarg || rampRate < 0)
+                    {
+                        fprintf(stderr,"invalid argument for option -%c\n",option);
+                        rampRate = 0;
+                    }
+                    break;
+                }
+            case 'l':
+                {
+                    sizesSpec = optarg;
+                    break;
+                }
+            case 'L':
+                {
+                    sizesPath = optarg;
+                    break;
+                }
+            case 'u':
+                {
+                    isUdp = true;
+                    break;
+                }
+            case 'g':
+                {
+                    useSegmentOffload = true;
+                    break;
+                }
+            case 'm':
+                {
+                    isFramed = true;
+                    break;
+                }
+            case 'O':
+                {
+                    struct sockopt_profile_t profile;
+                    if (!parse_sockopt_profile(optarg,&profile))
+                    {
+                        fprintf(stderr,"invalid argument for option -%c\n",option);
+                    }
+                    else
+                    {
+                        set_sockopt_profile(&profile);
+                        isFastOpen = profile.isFastOpenConnect;
+                    }
+                    break;
+                }
             case '?':
                 {
                     if (isprint (optopt))
@@ -684,49 +2890,189 @@ int main (int argc, char* argv[])
         if (!remoteNameInitialized ||
             !remotePortInitialized ||
             !numWorkerProcessesInitialized ||
-            !numClientsInitialized ||
-            !dataInitialized ||
-            !timesToRetransmitInitialized)
+            (!numClientsInitialized && (schedulePath == 0 || isUdp)) ||
+            (!dataInitialized && sizesSpec == 0 && sizesPath == 0) ||
+            (!timesToRetransmitInitialized && !isUdp))
         {
-            fprintf(stderr,"usage: %s [-h server name] [-p server port] [-n number of worker processes] [-c number of clients] [-d data to send] [-r times to retransmit per client] [-t timeout]\n",argv[0]);
+            fprintf(stderr,"usage: %s [-h server name] [-p server port] [-n number of worker processes] [-T worker threads per process] [-c number of clients] [-d data to send] [-r times to retransmit per client] [-t timeout] [-u send UDP datagrams; -c is datagrams in flight] [-g use UDP GSO/GRO] [-s seed of generated payload] [-f file to load payload from] [-l request size N or A:B] [-L file of request sizes and weights] [-P requests in flight per client] [-R connections opened per second] [-S load schedule file] [-i report interval] [-w report CSV file] [-O socket options, e.g. nodelay,quickack,sndbuf=N] [-m send length-prefixed frames]\n",argv[0]);
             return EX_USAGE;
         }
     }
 
-    // setup IPC
-    printStatsLock = (sem_t*) mmap(0,sizeof(sem_t),PROT_READ|PROT_WRITE,MAP_SHARED|MAP_ANONYMOUS,-1,0);
+    // set up the distribution of echo request sizes. without -l or -L, every
+    // request is as long as the -d text
+    if (sizesPath != 0)
+    {
+        if (!size_dist_init_file(&sizes,sizesPath,seed))
+        {
+            fprintf(stderr,"invalid request sizes file \"%s\"\n",sizesPath);
+            return EX_USAGE;
+        }
+    }
+    else if (sizesSpec != 0)
+    {
+        if (!size_dist_init_spec(&sizes,sizesSpec,seed))
+        {
+            fprintf(stderr,"invalid request size \"%s\"\n",sizesSpec);
+            return EX_USAGE;
+        }
+    }
+    else
+    {
+        char fixedSpec[32];
+        snprintf(fixedSpec,sizeof(fixedSpec),"%lu",(unsigned long) strlen(data));
+        if (!size_dist_init_spec(&sizes,fixedSpec,seed))
+        {
+            fprintf(stderr,"data to send must not be empty\n");
+            return EX_USAGE;
+        }
+    }
 
-    if (printStatsLock == MAP_FAILED)
+    // set up the payload that echo requests are cut from: the -d text, or else
+    // a file (-f), or else a pattern generated from the seed (-s)
+    struct payload_t payload;
     {
-        fatal_error("mmap");
+        size_t sliceLen = sizes.maxSize > ECHO_BUFFER_LEN ? sizes.maxSize : ECHO_BUFFER_LEN;
+        if (payloadPath != 0)
+        {
+            if (!payload_init_file(&payload,payloadPath,seed,sliceLen))
+            {
+                fatal_error(payloadPath);
+            }
+        }
+        else if (seedInitialized || data == 0 || *data == 0)
+        {
+            payload_init_seeded(&payload,seed,sliceLen);
+        }
+        else
+        {
+            payload_init_literal(&payload,data,sliceLen);
+        }
+    }
+
+    // set up the load schedule
+    if (schedulePath != 0)
+    {
+        int badLine;
+        if (!schedule_init_file(&schedule,schedulePath,&badLine))
+        {
+            if (badLine != 0)
+                fprintf(stderr,"invalid load schedule file \"%s\": bad phase on line %d\n",schedulePath,badLine);
+            else
+                fprintf(stderr,"invalid load schedule file \"%s\"\n",schedulePath);
+            return EX_USAGE;
+        }
+    }
+    else
+    {
+        schedule_init_single(&schedule,numClients,rampRate);
+    }
+
+    // datagrams must all be the same size
+    if (isUdp && sizes.count != 1)
+    {
+        fprintf(stderr,"UDP mode needs a fixed request size\n");
+        return EX_USAGE;
+    }
+
+    // datagrams are framed by the network already
+    if (isUdp && isFramed)
+    {
+        fprintf(stderr,"UDP mode does not support framed requests\n");
+        return EX_USAGE;
+    }
+
+    // each UDP worker process drives one socket
+    if (isUdp && numThreads > 1)
+    {
+        fprintf(stderr,"UDP mode does not support worker threads\n");
+        return EX_USAGE;
+    }
+
+    // open the CSV file for interval reports; rows are appended with single
+    // writes, so the worker processes can share it
+    if (reportPath != 0)
+    {
+        reportFd = open(reportPath,O_WRONLY|O_CREAT|O_APPEND,0644);
+        if (reportFd == -1)
+        {
+            fatal_error("open");
+        }
+        isReportCsv = true;
+        if (reportInterval == 0)
+        {
+            reportInterval = DEFAULT_REPORT_INTERVAL;
+        }
+        if (lseek(reportFd,0,SEEK_END) == 0)
+        {
+            const char* header = "time_ms,pid,requests_per_s,sessions_per_s,connects_per_s,in_flight,p50_us,p90_us,p99_us,p999_us,max_us\n";
+            if (write(reportFd,header,strlen(header)) == -1)
+            {
+                fatal_error("write");
+            }
+        }
+    }
+
+    // shutdown signals are read from signal file descriptors, so block them
+    // before any worker process is forked
+    {
+        sigset_t signals;
+        sigemptyset(&signals);
+        sigaddset(&signals,SIGINT);
+        sigaddset(&signals,SIGTERM);
+        sigaddset(&signals,SIGCHLD);
+        if (sigprocmask(SIG_BLOCK,&signals,0) == -1)
+        {
+            fatal_error("sigprocmask");
+        }
     }
 
-    if (sem_init(printStatsLock,1,1) < 0)
+    // setup IPC
+    void* printStatsLockMemory = mmap(0,sizeof(Semaphore),PROT_READ|PROT_WRITE,MAP_SHARED|MAP_ANONYMOUS,-1,0);
+
+    if (printStatsLockMemory == MAP_FAILED)
     {
-        fatal_error("sem_init");
+        fatal_error("mmap");
     }
 
+    printStatsLock = new (printStatsLockMemory) Semaphore(true,1);
+
     // start the worker processes
     for(register int i = 0; i < numWorkerProcesses; ++i)
     {
         // if this is worker process, run worker process code
         if (fork() == 0)
         {
-            if (i == 0)
+            if (numThreads > 1)
+            {
+                return thread_process(remoteName,remotePort,&schedule,&payload,&sizes,timesToRetransmit,pipelineDepth,i,numWorkerProcesses,numThreads);
+            }
+
+            // the worker process records its statistics in a slot of its own
+            static struct stats_t slot;
+            stats_init(&slot);
+            stats = statsSlots = &slot;
+            numStatsSlots = 1;
+
+            int returnValue;
+            if (isUdp)
             {
-                return child_process(remoteName,remotePort,(numClients/numWorkerProcesses)+(numClients%numWorkerProcesses),data,timesToRetransmit);
+                int window = numClients/numWorkerProcesses+(i == 0 ? numClients%numWorkerProcesses : 0);
+                returnValue = udp_child_process(remoteName,remotePort,window,payload_at(&payload,0,0),sizes.maxSize,useSegmentOffload);
             }
             else
             {
-                return child_process(remoteName,remotePort,numClients/numWorkerProcesses,data,timesToRetransmit);
+                returnValue = child_process(remoteName,remotePort,&schedule,&payload,&sizes,timesToRetransmit,pipelineDepth,i,numWorkerProcesses);
             }
+            print_statistics(stats,1);
+            return returnValue;
         }
     }
     int returnValue = server_process(numWorkerProcesses,lifetime);
 
     // tear down IPC
-    sem_destroy(printStatsLock);
-    munmap(printStatsLock,sizeof(sem_t));
+    printStatsLock->~Semaphore();
+    munmap(printStatsLock,sizeof(Semaphore));
 
     return returnValue;
 }
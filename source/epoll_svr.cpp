@@ -20,14 +20,25 @@
 #include <fcntl.h>
 #include <stdio.h>
 #include <assert.h>
+#include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <strings.h>
 #include <sysexits.h>
 #include <sys/wait.h>
 #include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/signalfd.h>
 #include <netinet/in.h>
+#include <netinet/udp.h>
 #include "net_helper.h"
+#include "supervisor_helper.h"
+#include "drain_helper.h"
+#include "rebalance_helper.h"
+#include "cycle_helper.h"
+#include "perf_helper.h"
+#include "handler_helper.h"
 
 /**
  * size of events array passed to epoll_wait system function.
@@ -35,9 +46,15 @@
 #define EPOLL_QUEUE_LEN 2048
 
 /**
- * size of buffer used to read bytes into from TCP/IP sockets.
+ * maximum number of datagrams received by one call to recvmmsg, and echoed
+ *   back by one call to sendmmsg.
  */
-#define ECHO_BUFFER_LEN 1024
+#define UDP_BATCH_LEN 64
+
+/**
+ * size of each datagram buffer. big enough for a GRO coalesced datagram.
+ */
+#define UDP_BUFFER_LEN 65536
 
 /**
  * prints the error message, then exits the program.
@@ -65,8 +82,227 @@ void fatal_error(char const * string)
     exit(EX_OSERR);
 }
 
-int child_process(int serverSocket)
+/**
+ * watches the connection {fd} for bytes to read or, while output of it is
+ *   pending, for room to send it instead.
+ *
+ * @function   watch_connection
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the connection is not read while output of it is pending, so a
+ *   client that does not read what it is sent cannot make the worker buffer
+ *   without bound.
+ *
+ * @signature  void watch_connection(int epoll, int fd, bool isSendPending)
+ *
+ * @param      epoll epoll file descriptor of this worker.
+ * @param      fd connection to watch; already in the epoll loop.
+ * @param      isSendPending true to wait for room to send.
+ */
+void watch_connection(int epoll, int fd, bool isSendPending)
+{
+    struct epoll_event event = epoll_event();
+    event.events = (isSendPending ? EPOLLOUT : EPOLLIN)|EPOLLERR|EPOLLHUP|EPOLLET;
+    event.data.fd = fd;
+    if (CYCLE_PROBE(CYCLE_EPOLL_CTL,epoll_ctl(epoll,EPOLL_CTL_MOD,fd,&event)) == -1)
+    {
+        fatal_error("epoll_ctl");
+    }
+}
+
+/**
+ * hands connections to the least loaded worker if this worker carries more
+ *   than its share, once every REBALANCE_INTERVAL.
+ *
+ * @function   migrate_connections
+ *
+ * @date       2026-10-16
+ *
+ * @revision   2026-10-16 Eric Tsang - closes the handler state of the
+ *   connections handed off.
+ * @revision   2026-10-16 Eric Tsang - connections pinned by their handler
+ *   state or pending output are not picked.
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       each connection is removed from the epoll loop before it is
+ *   sent, so no event is lost: bytes that arrive meanwhile are reported by the
+ *   target's epoll loop once it adds the connection. connections the target
+ *   has no room for stay in this worker. the handler state of a connection
+ *   does not go with it; the target starts it afresh, so only connections
+ *   whose handler state is idle, and that have no output pending, are
+ *   picked; see rebalance_pin.
+ *
+ * @signature  template<class Handler> void migrate_connections(
+ *   struct rebalancer_t* rebalancer, int epoll, struct drain_t* drain,
+ *   typename Handler::conn_t* conns)
+ *
+ * @param      rebalancer rebalancer of this worker.
+ * @param      epoll epoll file descriptor of this worker.
+ * @param      drain connections tracked for draining.
+ * @param      conns handler state of each connection, by file descriptor.
+ */
+template<class Handler>
+void migrate_connections(struct rebalancer_t* rebalancer, int epoll, struct drain_t* drain, typename Handler::conn_t* conns)
+{
+    static int fds[REBALANCE_BATCH_LEN];
+    int target;
+    int count = rebalance_pick(rebalancer,fds,REBALANCE_BATCH_LEN,&target);
+
+    int numMigrated = 0;
+    for (register int i = 0; i < count; ++i)
+    {
+        epoll_ctl(epoll,EPOLL_CTL_DEL,fds[i],0);
+        if (rebalance_send(rebalancer,target,fds[i]))
+        {
+            Handler::on_close(conns+fds[i]);
+            drain_close(drain,fds[i]);
+            close(fds[i]);
+            numMigrated++;
+            continue;
+        }
+
+        // the target is full, or started draining; keep the connection
+        struct epoll_event event = epoll_event();
+        event.events = EPOLLIN|EPOLLERR|EPOLLHUP|EPOLLET;
+        event.data.fd = fds[i];
+        if (epoll_ctl(epoll,EPOLL_CTL_ADD,fds[i],&event) == -1)
+        {
+            fatal_error("epoll_ctl");
+        }
+        break;
+    }
+
+    if (numMigrated > 0)
+    {
+        fprintf(stderr,"[%d] worker %d handed %d connections to worker %d; %lu handed off, %lu taken over so far\n",
+            getpid(),rebalancer->workerIndex,numMigrated,target,rebalancer->migratedCount,rebalancer->adoptedCount);
+    }
+}
+
+/**
+ * takes over the connections other workers handed to this one.
+ *
+ * @function   adopt_connections
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       bytes that arrived meanwhile are reported by epoll once the
+ *   connection is added. connections taken over while draining are tracked by
+ *   the drain like any other, so they are half-closed once idle.
+ *
+ * @signature  template<class Handler> void adopt_connections(
+ *   struct rebalancer_t* rebalancer, int epoll, struct drain_t* drain,
+ *   typename Handler::conn_t* conns)
+ *
+ * @param      rebalancer rebalancer of this worker.
+ * @param      epoll epoll file descriptor of this worker.
+ * @param      drain connections tracked for draining.
+ * @param      conns handler state of each connection, by file descriptor.
+ */
+template<class Handler>
+void adopt_connections(struct rebalancer_t* rebalancer, int epoll, struct drain_t* drain, typename Handler::conn_t* conns)
 {
+    int newSocket;
+    while ((newSocket = rebalance_recv(rebalancer)) != -1)
+    {
+        struct epoll_event event = epoll_event();
+        event.events = EPOLLIN|EPOLLERR|EPOLLHUP|EPOLLET;
+        event.data.fd = newSocket;
+        if (epoll_ctl(epoll,EPOLL_CTL_ADD,newSocket,&event) == -1)
+        {
+            fatal_error("epoll_ctl");
+        }
+        drain_open(drain,newSocket);
+        Handler::on_accept(conns+newSocket,newSocket);
+    }
+}
+
+/**
+ * accepts connections from the passed server socket, and echoes what they send
+ *   back to them until application termination, or until the worker is told to
+ *   drain.
+ *
+ * @function   child_process
+ *
+ * @date       2016-02-14
+ *
+ * @revision   2026-10-16 Eric Tsang - on SUPERVISOR_DRAIN_SIGNAL, stops
+ *   accepting connections, and returns once the open ones are closed.
+ * @revision   2026-10-16 Eric Tsang - half-closes idle connections while
+ *   draining, and gives up on the rest after {drainTimeout}.
+ * @revision   2026-10-16 Eric Tsang - hands connections to less loaded
+ *   workers, and takes over the ones they hand to it.
+ * @revision   2026-10-16 Eric Tsang - times its system calls with cycle
+ *   probes, and prints them on SUPERVISOR_DUMP_SIGNAL.
+ * @revision   2026-10-16 Eric Tsang - counts hardware and software events
+ *   with perf, and prints them with the echoes and connections served on
+ *   SUPERVISOR_DUMP_SIGNAL, and once drained.
+ * @revision   2026-10-16 Eric Tsang - serves the protocol of {Handler}
+ *   instead of echoing; an echo counts one read it handled.
+ * @revision   2026-10-16 Eric Tsang - keeps output the socket does not take,
+ *   and stops reading the connection until EPOLLOUT lets it be sent.
+ * @revision   2026-10-16 Eric Tsang - reads as many bytes at once as
+ *   {Handler} asks for.
+ * @revision   2026-10-16 Eric Tsang - sends the output of a read the
+ *   handler rejects before closing the connection.
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       SUPERVISOR_DRAIN_SIGNAL and SUPERVISOR_DUMP_SIGNAL must already
+ *   be blocked. connections the drain closes are not passed to
+ *   Handler::on_close; the worker exits right after.
+ *
+ * @signature  template<class Handler> int child_process(int serverSocket,
+ *   long drainTimeout, struct rebalancer_t* rebalancer, int workerIndex)
+ *
+ * @param      serverSocket server socket on the local host to accept and
+ *   service connection requests from.
+ * @param      drainTimeout milliseconds to wait for connections to close once
+ *   draining, before closing them.
+ * @param      rebalancer rebalancer shared with the other workers; 0 to keep
+ *   every connection in the worker that accepted it.
+ * @param      workerIndex index of this worker.
+ *
+ * @return     exit code of the process.
+ */
+template<class Handler>
+int child_process(int serverSocket, long drainTimeout, struct rebalancer_t* rebalancer, int workerIndex)
+{
+    // connections open, tracked so they can be drained
+    struct drain_t drain;
+    drain_init(&drain);
+
+    // handler state, and output not yet sent, of each connection, by file
+    // descriptor
+    typename Handler::conn_t* conns = new typename Handler::conn_t[handler_table_len()];
+    struct pending_output_t* pendings = new pending_output_t[handler_table_len()]();
+
+    // hardware and software events of the worker, and what it served
+    char label[32];
+    sprintf(label,"worker %d",workerIndex);
+    struct perf_group_t perfGroup;
+    perf_open(&perfGroup,false);
+    unsigned long numEchoes = 0;
+    unsigned long numConnections = 0;
+
     // create epoll file descriptor
     int epoll = epoll_create(EPOLL_QUEUE_LEN);
     if (epoll == -1)
@@ -74,6 +310,28 @@ int child_process(int serverSocket)
         fatal_error("epoll_create");
     }
 
+    // add the drain and dump signals to epoll event loop
+    int drainFd;
+    {
+        sigset_t signals;
+        sigemptyset(&signals);
+        sigaddset(&signals,SUPERVISOR_DRAIN_SIGNAL);
+        sigaddset(&signals,SUPERVISOR_DUMP_SIGNAL);
+        drainFd = signalfd(-1,&signals,SFD_NONBLOCK|SFD_CLOEXEC);
+        if (drainFd == -1)
+        {
+            fatal_error("signalfd");
+        }
+
+        struct epoll_event event = epoll_event();
+        event.events = EPOLLIN;
+        event.data.fd = drainFd;
+        if (epoll_ctl(epoll,EPOLL_CTL_ADD,drainFd,&event) == -1)
+        {
+            fatal_error("epoll_ctl");
+        }
+    }
+
     // add server socket to epoll event loop
     {
         struct epoll_event event = epoll_event();
@@ -85,13 +343,44 @@ int child_process(int serverSocket)
         }
     }
 
-    // execute epoll event loop
+    // add the socket that other workers hand connections over on to epoll
+    // event loop
+    int inboxFd = -1;
+    if (rebalancer != 0)
+    {
+        inboxFd = rebalance_attach(rebalancer,workerIndex);
+
+        struct epoll_event event = epoll_event();
+        event.events = EPOLLIN|EPOLLET;
+        event.data.fd = inboxFd;
+        if (epoll_ctl(epoll,EPOLL_CTL_ADD,inboxFd,&event) == -1)
+        {
+            fatal_error("epoll_ctl");
+        }
+    }
+
+    // execute epoll event loop until drained
     while (true)
     {
+        // move the drain along, if draining
+        int timeout = -1;
+        if (drain_is_draining(&drain) && !drain_step(&drain,&timeout))
+        {
+            break;
+        }
+
+        // hand connections to a less loaded worker, if this one carries too
+        // many
+        if (rebalancer != 0 && !drain_is_draining(&drain))
+        {
+            migrate_connections<Handler>(rebalancer,epoll,&drain,conns);
+            timeout = rebalance_timeout(rebalancer);
+        }
+
         // wait for epoll to unblock to report socket activity
         static struct epoll_event events[EPOLL_QUEUE_LEN];
         static int eventCount;
-        eventCount = epoll_wait(epoll,events,EPOLL_QUEUE_LEN,-1);
+        eventCount = CYCLE_PROBE(CYCLE_EPOLL_WAIT,epoll_wait(epoll,events,EPOLL_QUEUE_LEN,timeout));
         if (eventCount < 0)
         {
             fatal_error("epoll_wait");
@@ -100,79 +389,412 @@ int child_process(int serverSocket)
         // epoll unblocked; handle socket activity
         for (register int i = 0; i < eventCount; i++)
         {
+            // print the cycle probes when told to dump; stop accepting
+            // connections when told to drain; the listening socket stays open
+            // in the server that took over
+            if (events[i].data.fd == drainFd)
+            {
+                struct signalfd_siginfo info;
+                while (read(drainFd,&info,sizeof(info)) == sizeof(info))
+                {
+                    if (info.ssi_signo == SUPERVISOR_DUMP_SIGNAL)
+                    {
+                        cycle_probe_dump(stderr,label);
+                        perf_report(stderr,label,&perfGroup,numEchoes,numConnections);
+                    }
+                    else if (!drain_is_draining(&drain))
+                    {
+                        epoll_ctl(epoll,EPOLL_CTL_DEL,serverSocket,0);
+                        close(serverSocket);
+                        drain_start(&drain,drainTimeout);
+
+                        // no more connections can be handed to this worker;
+                        // drain the ones already on their way with the rest
+                        if (rebalancer != 0)
+                        {
+                            rebalance_stop(rebalancer);
+                            adopt_connections<Handler>(rebalancer,epoll,&drain,conns);
+                        }
+                    }
+                }
+                errno = 0;
+                continue;
+            }
+
+            // take over the connections other workers handed to this one
+            if (events[i].data.fd == inboxFd)
+            {
+                adopt_connections<Handler>(rebalancer,epoll,&drain,conns);
+                continue;
+            }
+
             // close connection if an error occurred
             if (events[i].events&(EPOLLHUP|EPOLLERR))
             {
-                close(events[i].data.fd);
+                Handler::on_close(conns+events[i].data.fd);
+                handler_free_pending(pendings+events[i].data.fd);
+                drain_close(&drain,events[i].data.fd);
+                if (rebalancer != 0) rebalance_close(rebalancer,events[i].data.fd);
+                CYCLE_PROBE(CYCLE_CLOSE,close(events[i].data.fd));
                 continue;
             }
 
-            assert(events[i].events&EPOLLIN);
-
-            // handling case when client socket has data available for reading
+            // handling case when client socket has data available for reading,
+            // or room to send output that was pending
             if (events[i].data.fd != serverSocket)
             {
                 // read data from socket...
-                static char buf[ECHO_BUFFER_LEN];
-                register int bytesRead;
+                static char buf[Handler::readLen];
+                register int bytesRead = 0;
+                typename Handler::conn_t* conn = conns+events[i].data.fd;
+                struct pending_output_t* pending = pendings+events[i].data.fd;
+                struct handler_output_t output;
+                enum send_result_t sendResult = SEND_DONE;
 
-                // read and echo back to client
-                while ((bytesRead = recv(events[i].data.fd,buf,ECHO_BUFFER_LEN,0)) > 0)
+                // send what the socket did not take before; reading waits
+                // until it has
+                drain_touch(&drain,events[i].data.fd);
+                bool isWaitingToSend = pending->numSpans > 0;
+                if (isWaitingToSend)
                 {
-                    send(events[i].data.fd,buf,bytesRead,0);
+                    sendResult = CYCLE_PROBE(CYCLE_SEND,handler_flush(events[i].data.fd,pending));
+                    if (sendResult == SEND_DONE)
+                    {
+                        watch_connection(epoll,events[i].data.fd,false);
+                        isWaitingToSend = false;
+                    }
+                }
+
+                // read, and send back what the handler responds with; a
+                // connection the handler rejected is not read again, and closes
+                // once its last output is sent
+                bool isRejected = pending->isClosing;
+                while (!isRejected && sendResult == SEND_DONE && (bytesRead = CYCLE_PROBE(CYCLE_RECV,recv(events[i].data.fd,buf,Handler::readLen,0))) > 0)
+                {
+                    struct span_t data = {buf,(size_t) bytesRead};
+                    isRejected = !Handler::on_data(conn,data,&output);
+                    sendResult = CYCLE_PROBE(CYCLE_SEND,handler_send(events[i].data.fd,&output,pending,buf,bytesRead));
+                    numEchoes++;
+                    if (rebalancer != 0) rebalance_touch(rebalancer,events[i].data.fd,bytesRead);
+                }
+                if (rebalancer != 0) rebalance_pin(rebalancer,events[i].data.fd,pending->numSpans > 0 || !Handler::is_idle(conn));
+
+                // if the socket is full, carry on once EPOLLOUT reports room in
+                // it
+                if (sendResult == SEND_PENDING)
+                {
+                    pending->isClosing = isRejected;
+                    if (!isWaitingToSend)
+                    {
+                        watch_connection(epoll,events[i].data.fd,true);
+                    }
                 }
 
                 // if call would block, continue event loop
-                if (bytesRead == -1 && errno == EWOULDBLOCK)
+                else if (!isRejected && sendResult == SEND_DONE && bytesRead == -1 && errno == EWOULDBLOCK)
                 {
                     errno = 0;
                 }
 
-                // close socket if connection is closed or unexpected error
+                // close socket if connection is closed, unexpected error, or
+                // the handler rejected it and its output is sent
                 else
                 {
                     // close socket
-                    close(events[i].data.fd);
+                    Handler::on_close(conn);
+                    handler_free_pending(pending);
+                    drain_close(&drain,events[i].data.fd);
+                    if (rebalancer != 0) rebalance_close(rebalancer,events[i].data.fd);
+                    if (isRejected) handler_linger(events[i].data.fd);
+                    CYCLE_PROBE(CYCLE_CLOSE,close(events[i].data.fd));
                 }
                 continue;
             }
 
+            // ignore connection requests reported before the worker started
+            // draining
+            else if (drain_is_draining(&drain))
+            {
+                continue;
+            }
+
             // handling case when server socket receives a connection request
             else
             {
-                // accept the remote connection
-                int newSocket = accept(serverSocket,0,0);
-
-                // ignore EAGAIN because this socket is shared, and connection
-                // may have been accepted by another process
-                if (newSocket == -1 && errno != EAGAIN)
+                // accept every queued connection; the listening socket is
+                // edge triggered, so connections left in the queue would
+                // not be reported again
+                while (true)
                 {
-                    fatal_error("accept");
+                    // accept the remote connection
+                    int newSocket = CYCLE_PROBE(CYCLE_ACCEPT,accept(serverSocket,0,0));
+
+                    // ignore EAGAIN because this socket is shared, and connection
+                    // may have been accepted by another process
+                    if (newSocket == -1 && errno != EAGAIN)
+                    {
+                        fatal_error("accept");
+                    }
+
+                    // propagate error if it is unexpected
+                    else if (errno == EAGAIN)
+                    {
+                        errno = 0;
+                        break;
+                    }
+
+                    // configure new socket to be non-blocking
+                    int existingFlags = CYCLE_PROBE(CYCLE_FCNTL,fcntl(newSocket,F_GETFL,0));
+                    if (CYCLE_PROBE(CYCLE_FCNTL,fcntl(newSocket,F_SETFL,O_NONBLOCK|existingFlags)) == -1)
+                    {
+                        fatal_error("fcntl");
+                    }
+
+                    // apply the socket options profile to the new socket
+                    CYCLE_PROBE_STMT(CYCLE_SOCKOPT,apply_sockopt_profile(newSocket));
+
+                    // add new socket to epoll loop
+                    static struct epoll_event event = epoll_event();
+                    event.events = EPOLLIN|EPOLLERR|EPOLLHUP|EPOLLET;
+                    event.data.fd = newSocket;
+                    if (CYCLE_PROBE(CYCLE_EPOLL_CTL,epoll_ctl(epoll,EPOLL_CTL_ADD,newSocket,&event)) == -1)
+                    {
+                        fatal_error("epoll_ctl");
+                    }
+                    drain_open(&drain,newSocket);
+                    Handler::on_accept(conns+newSocket,newSocket);
+                    if (rebalancer != 0) rebalance_open(rebalancer,newSocket);
+                    numConnections++;
                 }
+                continue;
+            }
+        }
+    }
+    perf_report(stderr,label,&perfGroup,numEchoes,numConnections);
+    perf_close(&perfGroup);
+    delete[] conns;
+    delete[] pendings;
+    return EX_OK;
+}
+
+/**
+ * binds this worker's own UDP socket to {listeningPort}, and echoes every
+ *   datagram it receives back to its sender until application termination.
+ *
+ * @function   udp_child_process
+ *
+ * @date       2026-10-16
+ *
+ * @revision   2026-10-16 Eric Tsang - returns on SUPERVISOR_DRAIN_SIGNAL;
+ *   datagrams have no connections to drain.
+ * @revision   2026-10-16 Eric Tsang - prints its perf counters on return.
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       datagrams are drained with recvmmsg into a pre-registered iovec
+ *   array, and the whole batch is echoed with sendmmsg straight out of the same
+ *   buffers. datagrams that cannot be echoed because the socket send buffer is
+ *   full are dropped, just as the network would.
+ *
+ * @signature  int udp_child_process(int listeningPort,bool useSegmentOffload)
+ *
+ * @param      listeningPort port to bind this worker's UDP socket to.
+ * @param      useSegmentOffload true to enable UDP GRO on receive and echo
+ *   coalesced datagrams back with UDP GSO; false otherwise.
+ *
+ * @return     exit code of the process.
+ */
+int udp_child_process(int listeningPort,bool useSegmentOffload)
+{
+    // create this worker's own UDP socket. SO_REUSEPORT makes the kernel
+    // spread datagrams across the sockets of all worker processes
+    int udpSocket = make_udp_server_socket(listeningPort,true,true).fd;
+    if (udpSocket == -1)
+    {
+        fatal_error("socket");
+    }
+
+    // hardware and software events of the worker, and what it served
+    struct perf_group_t perfGroup;
+    perf_open(&perfGroup,false);
+    unsigned long numEchoes = 0;
 
-                // propagate error if it is unexpected
-                else if (errno == EAGAIN)
+    // let the kernel coalesce datagrams of the same flow into one buffer
+    if (useSegmentOffload)
+    {
+        int arg = 1;
+        if (setsockopt(udpSocket,SOL_UDP,UDP_GRO,&arg,sizeof(arg)) == -1)
+        {
+            fatal_error("setsockopt UDP_GRO");
+        }
+    }
+
+    // create epoll file descriptor
+    int epoll = epoll_create(EPOLL_QUEUE_LEN);
+    if (epoll == -1)
+    {
+        fatal_error("epoll_create");
+    }
+
+    // add UDP socket to epoll event loop
+    {
+        struct epoll_event event = epoll_event();
+        event.events = EPOLLIN|EPOLLERR|EPOLLET;
+        event.data.fd = udpSocket;
+        if (epoll_ctl(epoll,EPOLL_CTL_ADD,udpSocket,&event) == -1)
+        {
+            fatal_error("epoll_ctl");
+        }
+    }
+
+    // add the drain signal to epoll event loop
+    int drainFd;
+    {
+        sigset_t signals;
+        sigemptyset(&signals);
+        sigaddset(&signals,SUPERVISOR_DRAIN_SIGNAL);
+        drainFd = signalfd(-1,&signals,SFD_NONBLOCK|SFD_CLOEXEC);
+        if (drainFd == -1)
+        {
+            fatal_error("signalfd");
+        }
+
+        struct epoll_event event = epoll_event();
+        event.events = EPOLLIN;
+        event.data.fd = drainFd;
+        if (epoll_ctl(epoll,EPOLL_CTL_ADD,drainFd,&event) == -1)
+        {
+            fatal_error("epoll_ctl");
+        }
+    }
+
+    // pre-register the receive and send message arrays; both point into the
+    // same datagram buffers so echoing never copies
+    static char bufs[UDP_BATCH_LEN][UDP_BUFFER_LEN];
+    static struct sockaddr_storage addrs[UDP_BATCH_LEN];
+    static struct iovec rxIovecs[UDP_BATCH_LEN];
+    static struct iovec txIovecs[UDP_BATCH_LEN];
+    static char rxControls[UDP_BATCH_LEN][CMSG_SPACE(sizeof(int))];
+    static char txControls[UDP_BATCH_LEN][CMSG_SPACE(sizeof(uint16_t))];
+    static struct mmsghdr rxMsgs[UDP_BATCH_LEN];
+    static struct mmsghdr txMsgs[UDP_BATCH_LEN];
+    for (register int i = 0; i < UDP_BATCH_LEN; ++i)
+    {
+        rxIovecs[i].iov_base = bufs[i];
+        rxIovecs[i].iov_len = UDP_BUFFER_LEN;
+        rxMsgs[i].msg_hdr.msg_iov = rxIovecs+i;
+        rxMsgs[i].msg_hdr.msg_iovlen = 1;
+        rxMsgs[i].msg_hdr.msg_name = addrs+i;
+
+        txIovecs[i].iov_base = bufs[i];
+        txMsgs[i].msg_hdr.msg_iov = txIovecs+i;
+        txMsgs[i].msg_hdr.msg_iovlen = 1;
+        txMsgs[i].msg_hdr.msg_name = addrs+i;
+    }
+
+    // execute epoll event loop
+    while (true)
+    {
+        // wait for epoll to unblock to report socket activity
+        static struct epoll_event events[EPOLL_QUEUE_LEN];
+        static int eventCount;
+        eventCount = epoll_wait(epoll,events,EPOLL_QUEUE_LEN,-1);
+        if (eventCount < 0)
+        {
+            fatal_error("epoll_wait");
+        }
+
+        // stop when told to drain
+        for (register int i = 0; i < eventCount; ++i)
+        {
+            if (events[i].data.fd == drainFd)
+            {
+                close(udpSocket);
+                perf_report(stderr,"udp worker",&perfGroup,numEchoes,0);
+                perf_close(&perfGroup);
+                return EX_OK;
+            }
+        }
+
+        // drain the socket one batch at a time
+        while (true)
+        {
+            // reset the fields that recvmmsg overwrites
+            for (register int i = 0; i < UDP_BATCH_LEN; ++i)
+            {
+                rxMsgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+                rxMsgs[i].msg_hdr.msg_control = useSegmentOffload ? rxControls[i] : 0;
+                rxMsgs[i].msg_hdr.msg_controllen = useSegmentOffload ? sizeof(rxControls[i]) : 0;
+            }
+
+            // receive a batch of datagrams
+            int received = recvmmsg(udpSocket,rxMsgs,UDP_BATCH_LEN,0,0);
+            if (received == -1)
+            {
+                if (errno == EAGAIN || errno == EWOULDBLOCK)
                 {
                     errno = 0;
-                    continue;
+                    break;
                 }
+                fatal_error("recvmmsg");
+            }
+
+            numEchoes += received;
+
+            // echo each datagram back to its sender; coalesced datagrams are
+            // re-segmented by the kernel using the size they arrived with
+            for (register int i = 0; i < received; ++i)
+            {
+                struct msghdr* rx = &rxMsgs[i].msg_hdr;
+                struct msghdr* tx = &txMsgs[i].msg_hdr;
+                txIovecs[i].iov_len = rxMsgs[i].msg_len;
+                tx->msg_namelen = rx->msg_namelen;
+                tx->msg_control = 0;
+                tx->msg_controllen = 0;
 
-                // configure new socket to be non-blocking
-                int existingFlags = fcntl(newSocket,F_GETFL,0);
-                if (fcntl(newSocket,F_SETFL,O_NONBLOCK|existingFlags) == -1)
+                for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(rx); cmsg != 0; cmsg = CMSG_NXTHDR(rx,cmsg))
                 {
-                    fatal_error("fcntl");
+                    if (cmsg->cmsg_level != SOL_UDP || cmsg->cmsg_type != UDP_GRO) continue;
+
+                    int segmentSize;
+                    memcpy(&segmentSize,CMSG_DATA(cmsg),sizeof(segmentSize));
+                    if ((unsigned int) segmentSize >= rxMsgs[i].msg_len) break;
+
+                    tx->msg_control = txControls[i];
+                    tx->msg_controllen = sizeof(txControls[i]);
+                    struct cmsghdr* txCmsg = CMSG_FIRSTHDR(tx);
+                    txCmsg->cmsg_level = SOL_UDP;
+                    txCmsg->cmsg_type = UDP_SEGMENT;
+                    txCmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+                    uint16_t gsoSize = (uint16_t) segmentSize;
+                    memcpy(CMSG_DATA(txCmsg),&gsoSize,sizeof(gsoSize));
+                    break;
                 }
+            }
 
-                // add new socket to epoll loop
-                static struct epoll_event event = epoll_event();
-                event.events = EPOLLIN|EPOLLERR|EPOLLHUP|EPOLLET;
-                event.data.fd = newSocket;
-                if (epoll_ctl(epoll,EPOLL_CTL_ADD,newSocket,&event) == -1)
+            // send the batch back; drop whatever does not fit
+            for (register int sent = 0; sent < received;)
+            {
+                int result = sendmmsg(udpSocket,txMsgs+sent,received-sent,0);
+                if (result == -1)
                 {
-                    fatal_error("epoll_ctl");
+                    if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS)
+                    {
+                        errno = 0;
+                        break;
+                    }
+                    fatal_error("sendmmsg");
                 }
-                continue;
+                sent += result;
+            }
+
+            // a short batch means the socket was empty when we read it; new
+            // datagrams will trigger another edge
+            if (received < UDP_BATCH_LEN)
+            {
+                break;
             }
         }
     }
@@ -180,11 +802,65 @@ int child_process(int serverSocket)
 }
 
 /**
- * waits for all child processes to terminate before terminating itself.
+ * arguments shared by all worker processes.
+ */
+struct worker_args_t
+{
+    int serverSocket;           // listening socket of TCP workers
+    int listeningPort;          // port UDP workers bind their sockets to
+    bool useSegmentOffload;     // true if UDP workers use GRO/GSO
+    long drainTimeout;          // milliseconds TCP workers drain for
+    struct rebalancer_t* rebalancer;    // shared by TCP workers; 0 if disabled
+    enum handler_kind_t handler;        // protocol TCP workers serve
+    int argc;                   // command line of the server, used to start
+    char** argv;                //   a new server on upgrade
+};
+
+/**
+ * entry point of the supervised TCP worker processes.
  *
- * @function   server_process
+ * @function   tcp_worker_main
  *
- * @date       2016-02-14
+ * @date       2026-10-16
+ *
+ * @revision   2026-10-16 Eric Tsang - runs the worker with the handler of
+ *   the server.
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  int tcp_worker_main(int workerIndex, void* arg)
+ *
+ * @param      workerIndex slot of the worker.
+ * @param      arg pointer to the worker_args_t of the server.
+ *
+ * @return     exit code of the process.
+ */
+int tcp_worker_main(int workerIndex, void* arg)
+{
+    struct worker_args_t* args = (struct worker_args_t*) arg;
+    switch (args->handler)
+    {
+    case HANDLER_DISCARD:
+        return child_process<discard_handler_t>(args->serverSocket,args->drainTimeout,args->rebalancer,workerIndex);
+    case HANDLER_CHARGEN:
+        return child_process<chargen_handler_t>(args->serverSocket,args->drainTimeout,args->rebalancer,workerIndex);
+    case HANDLER_LENGTH:
+        return child_process<length_handler_t>(args->serverSocket,args->drainTimeout,args->rebalancer,workerIndex);
+    default:
+        return child_process<echo_handler_t>(args->serverSocket,args->drainTimeout,args->rebalancer,workerIndex);
+    }
+}
+
+/**
+ * entry point of the supervised UDP worker processes.
+ *
+ * @function   udp_worker_main
+ *
+ * @date       2026-10-16
  *
  * @revision   none
  *
@@ -194,17 +870,106 @@ int child_process(int serverSocket)
  *
  * @note       none
  *
- * @signature  int server_process(int numWorkerProcesses)
+ * @signature  int udp_worker_main(int workerIndex, void* arg)
  *
- * @param      numWorkerProcesses number of child processes to wait for before
- *   terminating.
+ * @param      workerIndex slot of the worker.
+ * @param      arg pointer to the worker_args_t of the server.
  *
  * @return     exit code of the process.
  */
-int server_process(int numWorkerProcesses)
+int udp_worker_main(int workerIndex, void* arg)
 {
-    for (register int i = 0; i < numWorkerProcesses; ++i) wait(0);
-    return EX_OK;
+    (void) workerIndex;
+    struct worker_args_t* args = (struct worker_args_t*) arg;
+    return udp_child_process(args->listeningPort,args->useSegmentOffload);
+}
+
+/**
+ * starts a new server from the binary on disk, and hands the listening socket
+ *   over to it, so that connection requests keep being accepted while the
+ *   workers of this server drain.
+ *
+ * @function   upgrade_server
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the new server is started with the same command line, plus a
+ *   hidden "-U [fd]" option naming the unix domain socket it receives the
+ *   listening socket from with SCM_RIGHTS. it writes one byte back once it
+ *   has the socket. connection requests that arrive in between wait in the
+ *   accept queue of the listening socket instead of being refused.
+ *
+ * @signature  bool upgrade_server(void* arg)
+ *
+ * @param      arg pointer to the worker_args_t of the server.
+ *
+ * @return     true once the new server has the listening socket; false if it
+ *   could not be started.
+ */
+bool upgrade_server(void* arg)
+{
+    struct worker_args_t* args = (struct worker_args_t*) arg;
+
+    // make the unix domain socket the listening socket is handed over on
+    int sockets[2];
+    if (socketpair(AF_UNIX,SOCK_STREAM|SOCK_CLOEXEC,0,sockets) == -1)
+    {
+        perror("socketpair");
+        return false;
+    }
+
+    pid_t pid = fork();
+    if (pid == -1)
+    {
+        perror("fork");
+        close(sockets[0]);
+        close(sockets[1]);
+        return false;
+    }
+
+    // run the new binary with the same command line, minus any "-U [fd]" this
+    // server was started with
+    if (pid == 0)
+    {
+        char fdArg[16];
+        snprintf(fdArg,sizeof(fdArg),"%d",sockets[1]);
+        char** argv = (char**) malloc((args->argc+3)*sizeof(char*));
+        int argc = 0;
+        for (register int i = 0; i < args->argc; ++i)
+        {
+            if (strcmp(args->argv[i],"-U") == 0) { ++i; continue; }
+            if (strncmp(args->argv[i],"-U",2) == 0) continue;
+            argv[argc++] = args->argv[i];
+        }
+        argv[argc++] = (char*) "-U";
+        argv[argc++] = fdArg;
+        argv[argc] = 0;
+
+        // only the unix domain socket is passed on; the new server starts
+        // with no signals blocked
+        fcntl(sockets[1],F_SETFD,0);
+        fcntl(args->serverSocket,F_SETFD,FD_CLOEXEC);
+        sigset_t signals;
+        sigemptyset(&signals);
+        sigprocmask(SIG_SETMASK,&signals,0);
+
+        execvp(argv[0],argv);
+        perror("execvp");
+        _exit(EX_OSERR);
+    }
+
+    // hand the listening socket over, and wait for the new server to take it
+    close(sockets[1]);
+    char ack = 0;
+    bool isReady = send_fd(sockets[0],args->serverSocket,&ack,1) && read(sockets[0],&ack,1) == 1;
+    close(sockets[0]);
+    return isReady;
 }
 
 /**
@@ -218,7 +983,16 @@ int server_process(int numWorkerProcesses)
  *
  * @date       2016-02-14
  *
- * @revision   none
+ * @revision   2026-10-16 Eric Tsang - worker processes are supervised, and
+ *   respawned when they terminate.
+ * @revision   2026-10-16 Eric Tsang - SIGUSR2 hands the listening socket
+ *   over to a new server started from the binary on disk.
+ * @revision   2026-10-16 Eric Tsang - SIGTERM drains the workers; -D sets how
+ *   long for.
+ * @revision   2026-10-16 Eric Tsang - -b evens out connections between
+ *   workers.
+ * @revision   2026-10-16 Eric Tsang - -a picks the protocol TCP workers
+ *   serve.
  *
  * @designer   Eric Tsang
  *
@@ -244,12 +1018,31 @@ int main (int argc, char* argv[])
     // number of worker process to create to server connections
     int numWorkerProcesses;
 
+    // true if workers should echo UDP datagrams instead of TCP streams
+    bool isUdp = false;
+
+    // true if UDP workers should use GRO on receive and GSO on send
+    bool useSegmentOffload = false;
+
+    // unix domain socket to receive the listening socket from, when started
+    // by upgrade_server; -1 otherwise
+    int upgradeSocket = -1;
+
+    // milliseconds to wait for connections to close when draining
+    long drainTimeout = DRAIN_DEFAULT_TIMEOUT;
+
+    // true if TCP workers should even out their connections
+    bool isRebalancing = false;
+
+    // protocol TCP workers serve
+    enum handler_kind_t handler = HANDLER_ECHO;
+
     // parse command line arguments
     {
         char option;
         int portInitialized = false;
         int numWorkerProcessesInitialized = false;
-        while ((option = getopt(argc,argv,"p:n:")) != -1)
+        while ((option = getopt(argc,argv,"p:n:ugO:U:D:ba:")) != -1)
         {
             switch (option)
             {
@@ -281,6 +1074,64 @@ int main (int argc, char* argv[])
                     }
                     break;
                 }
+            case 'u':
+                {
+                    isUdp = true;
+                    break;
+                }
+            case 'g':
+                {
+                    useSegmentOffload = true;
+                    break;
+                }
+            case 'b':
+                {
+                    isRebalancing = true;
+                    break;
+                }
+            case 'a':
+                {
+                    if (!parse_handler(optarg,&handler))
+                    {
+                        fprintf(stderr,"invalid argument for option -%c\n",option);
+                    }
+                    break;
+                }
+            case 'D':
+                {
+                    char* parsedCursor = optarg;
+                    drainTimeout = strtol(optarg,&parsedCursor,10);
+                    if (parsedCursor == optarg || drainTimeout < 0)
+                    {
+                        fprintf(stderr,"invalid argument for option -%c\n",option);
+                        drainTimeout = DRAIN_DEFAULT_TIMEOUT;
+                    }
+                    break;
+                }
+            case 'O':
+                {
+                    struct sockopt_profile_t profile;
+                    if (!parse_sockopt_profile(optarg,&profile))
+                    {
+                        fprintf(stderr,"invalid argument for option -%c\n",option);
+                    }
+                    else
+                    {
+                        set_sockopt_profile(&profile);
+                    }
+                    break;
+                }
+            case 'U':
+                {
+                    char* parsedCursor = optarg;
+                    upgradeSocket = (int) strtol(optarg,&parsedCursor,10);
+                    if (parsedCursor == optarg)
+                    {
+                        fprintf(stderr,"invalid argument for option -%c\n",option);
+                        upgradeSocket = -1;
+                    }
+                    break;
+                }
             case '?':
                 {
                     if (isprint(optopt))
@@ -303,26 +1154,59 @@ int main (int argc, char* argv[])
         if (!portInitialized &&
             !numWorkerProcessesInitialized)
         {
-            fprintf(stderr,"usage: %s [-p server listening port] [-n number of worker processes]\n",argv[0]);
+            fprintf(stderr,"usage: %s [-p server listening port] [-n number of worker processes] [-u echo UDP datagrams] [-g use UDP GRO/GSO] [-O socket options, e.g. nodelay,quickack,sndbuf=N] [-D drain timeout in ms] [-b rebalance connections between workers] [-a protocol: echo, discard, chargen or length]\n",argv[0]);
             return EX_USAGE;
         }
     }
 
-    // create server socket
-    serverSocket = make_tcp_server_socket(listeningPort,true).fd;
-    if (serverSocket == -1)
+    struct worker_args_t workerArgs;
+    workerArgs.serverSocket = -1;
+    workerArgs.listeningPort = listeningPort;
+    workerArgs.useSegmentOffload = useSegmentOffload;
+    workerArgs.drainTimeout = drainTimeout;
+    workerArgs.rebalancer = 0;
+    workerArgs.handler = handler;
+    workerArgs.argc = argc;
+    workerArgs.argv = argv;
+
+    // start and supervise the UDP worker processes; each binds its own socket
+    // to the port
+    if (isUdp)
     {
-        fatal_error("socket");
+        return supervise_workers(numWorkerProcesses,udp_worker_main,0,&workerArgs);
     }
 
-    // start the worker processes
-    for(register int i = 0; i < numWorkerProcesses; ++i)
+    // take the listening socket over from the server that started this one,
+    // or create server socket
+    if (upgradeSocket != -1)
     {
-        // if this is worker process, run worker process code
-        if (fork() == 0)
+        char ack;
+        serverSocket = recv_fd(upgradeSocket,&ack,1);
+        if (serverSocket == -1 || write(upgradeSocket,"",1) != 1)
         {
-            return child_process(serverSocket);
+            fatal_error("recv_fd");
         }
+        close(upgradeSocket);
+        fcntl(serverSocket,F_SETFD,0);
+    }
+    else
+    {
+        serverSocket = make_tcp_server_socket(listeningPort,true).fd;
     }
-    return server_process(numWorkerProcesses);
+    if (serverSocket == -1)
+    {
+        fatal_error("socket");
+    }
+
+    // set up the load table and socket pairs shared by the workers
+    static struct rebalancer_t rebalancer;
+    if (isRebalancing)
+    {
+        rebalance_init(&rebalancer,numWorkerProcesses);
+        workerArgs.rebalancer = &rebalancer;
+    }
+
+    // start the worker processes, and respawn them if they terminate
+    workerArgs.serverSocket = serverSocket;
+    return supervise_workers(numWorkerProcesses,tcp_worker_main,upgrade_server,&workerArgs);
 }
@@ -0,0 +1,995 @@
+/**
+ * readiness notification micro-benchmark. creates N eventfds or socket pairs,
+ *   makes K of them ready over and over, and measures what it costs each
+ *   event mechanism to report them: the select_helper Files path, poll, epoll
+ *   level and edge triggered, and io_uring poll.
+ *
+ * @sourceFile evbench.cpp
+ *
+ * @program    evbench.out
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       only the call that waits for readiness and the scan for the
+ *   ready descriptors are timed; making descriptors ready and clearing them
+ *   again is not. no TCP is involved, so the numbers are the cost of the
+ *   mechanism alone.
+ */
+#include <ctype.h>
+#include <errno.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sysexits.h>
+#include <sys/mman.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#include "select_helper.h"
+
+/**
+ * most values a comma separated list option takes.
+ */
+#define EVBENCH_LIST_LEN 16
+
+/**
+ * nanoseconds of timed waits to run per measurement.
+ */
+#define EVBENCH_BUDGET 200000000L
+
+/**
+ * fewest and most waits per measurement.
+ */
+#define EVBENCH_MIN_WAITS 5
+#define EVBENCH_MAX_WAITS 200000
+
+/**
+ * descriptors to watch, and the means to make them ready and clear them.
+ */
+struct fds_t
+{
+    int* watched;       // descriptors the mechanisms wait on
+    int* peers;         // descriptors written to make them ready; same as
+                        //   watched for eventfds
+    int count;
+    bool isSocketPair;
+};
+
+/**
+ * a raw io_uring, set up without liburing.
+ */
+struct ring_t
+{
+    int fd;
+    unsigned* sqHead;
+    unsigned* sqTail;
+    unsigned* sqMask;
+    unsigned* sqArray;
+    struct io_uring_sqe* sqes;
+    unsigned sqEntries;
+    unsigned* cqHead;
+    unsigned* cqTail;
+    unsigned* cqMask;
+    struct io_uring_cqe* cqes;
+    void* sqRing;
+    size_t sqRingLen;
+    void* cqRing;
+    size_t cqRingLen;
+    unsigned numPending;    // submission queue entries not yet submitted
+};
+
+/**
+ * prints the error message, then exits the program.
+ *
+ * @function   fatal_error
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  void fatal_error(const char* string)
+ *
+ * @param      string string to print before exiting the program
+ */
+void fatal_error(char const * string)
+{
+    fprintf(stderr,"%s: ",string);
+    perror(0);
+    exit(EX_OSERR);
+}
+
+/**
+ * returns a monotonic time stamp in nanoseconds.
+ *
+ * @function   current_time_ns
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  long current_time_ns()
+ *
+ * @return     monotonic time stamp in nanoseconds.
+ */
+long current_time_ns()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC,&now);
+    return now.tv_sec*1000000000L+now.tv_nsec;
+}
+
+/**
+ * parses a comma separated list of positive integers.
+ *
+ * @function   parse_list
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  int parse_list(const char* spec, long* values)
+ *
+ * @param      spec list to parse, e.g. "10,100,1000".
+ * @param      values set to the values of the list; EVBENCH_LIST_LEN long.
+ *
+ * @return     number of values parsed; 0 if {spec} is invalid.
+ */
+int parse_list(const char* spec, long* values)
+{
+    int count = 0;
+    const char* cursor = spec;
+    while (count < EVBENCH_LIST_LEN)
+    {
+        char* parsedCursor;
+        values[count] = strtol(cursor,&parsedCursor,10);
+        if (parsedCursor == cursor || values[count] <= 0)
+        {
+            return 0;
+        }
+        count++;
+        if (*parsedCursor == '\0')
+        {
+            return count;
+        }
+        if (*parsedCursor != ',')
+        {
+            return 0;
+        }
+        cursor = parsedCursor+1;
+    }
+    return 0;
+}
+
+/**
+ * creates {count} eventfds or socket pairs.
+ *
+ * @function   fds_open
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       all descriptors are non-blocking.
+ *
+ * @signature  bool fds_open(struct fds_t* fds, int count, bool isSocketPair)
+ *
+ * @param      fds set to the new descriptors.
+ * @param      count number of descriptors to watch.
+ * @param      isSocketPair true for socket pairs; false for eventfds.
+ *
+ * @return     false if the descriptors ran out; none are left open then.
+ */
+bool fds_open(struct fds_t* fds, int count, bool isSocketPair)
+{
+    fds->watched = (int*) malloc(sizeof(int)*count);
+    fds->peers = (int*) malloc(sizeof(int)*count);
+    fds->count = 0;
+    fds->isSocketPair = isSocketPair;
+    for (register int i = 0; i < count; ++i)
+    {
+        if (isSocketPair)
+        {
+            int pair[2];
+            if (socketpair(AF_UNIX,SOCK_STREAM|SOCK_NONBLOCK,0,pair) == -1)
+            {
+                break;
+            }
+            fds->watched[i] = pair[0];
+            fds->peers[i] = pair[1];
+        }
+        else
+        {
+            int fd = eventfd(0,EFD_NONBLOCK);
+            if (fd == -1)
+            {
+                break;
+            }
+            fds->watched[i] = fds->peers[i] = fd;
+        }
+        fds->count++;
+    }
+    if (fds->count < count)
+    {
+        for (register int i = 0; i < fds->count; ++i)
+        {
+            close(fds->watched[i]);
+            if (isSocketPair)
+            {
+                close(fds->peers[i]);
+            }
+        }
+        free(fds->watched);
+        free(fds->peers);
+        errno = 0;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * closes the descriptors of {fds}.
+ *
+ * @function   fds_close
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  void fds_close(struct fds_t* fds)
+ *
+ * @param      fds descriptors to close.
+ */
+void fds_close(struct fds_t* fds)
+{
+    for (register int i = 0; i < fds->count; ++i)
+    {
+        close(fds->watched[i]);
+        if (fds->isSocketPair)
+        {
+            close(fds->peers[i]);
+        }
+    }
+    free(fds->watched);
+    free(fds->peers);
+    fds->count = 0;
+}
+
+/**
+ * makes the {numReady} descriptors of {fds} at the indices {readyIndices}
+ *   ready to read.
+ *
+ * @function   fds_make_ready
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  void fds_make_ready(const struct fds_t* fds,
+ *   const int* readyIndices, int numReady)
+ *
+ * @param      fds descriptors.
+ * @param      readyIndices indices of the descriptors to make ready.
+ * @param      numReady number of descriptors to make ready.
+ */
+void fds_make_ready(const struct fds_t* fds, const int* readyIndices, int numReady)
+{
+    uint64_t one = 1;
+    for (register int i = 0; i < numReady; ++i)
+    {
+        if (write(fds->peers[readyIndices[i]],&one,fds->isSocketPair ? 1 : sizeof(one)) == -1)
+        {
+            fatal_error("write");
+        }
+    }
+}
+
+/**
+ * clears the readiness of the {numReady} descriptors of {fds} at the indices
+ *   {readyIndices}.
+ *
+ * @function   fds_clear
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  void fds_clear(const struct fds_t* fds,
+ *   const int* readyIndices, int numReady)
+ *
+ * @param      fds descriptors.
+ * @param      readyIndices indices of the descriptors to clear.
+ * @param      numReady number of descriptors to clear.
+ */
+void fds_clear(const struct fds_t* fds, const int* readyIndices, int numReady)
+{
+    uint64_t value;
+    for (register int i = 0; i < numReady; ++i)
+    {
+        if (read(fds->watched[readyIndices[i]],&value,fds->isSocketPair ? 1 : sizeof(value)) == -1)
+        {
+            fatal_error("read");
+        }
+    }
+}
+
+/**
+ * returns true once enough waits have been timed for a steady measurement.
+ *
+ * @function   is_measured
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  static inline bool is_measured(int numWaits, long elapsed)
+ *
+ * @param      numWaits number of waits timed so far.
+ * @param      elapsed nanoseconds the timed waits took altogether.
+ *
+ * @return     true if the measurement is done.
+ */
+static inline bool is_measured(int numWaits, long elapsed)
+{
+    return numWaits >= EVBENCH_MAX_WAITS || (numWaits >= EVBENCH_MIN_WAITS && elapsed >= EVBENCH_BUDGET);
+}
+
+/**
+ * measures the select_helper Files path: files_select, then a walk of the
+ *   file set testing each descriptor, as select_svr does.
+ *
+ * @function   bench_select
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       select cannot watch descriptors from FD_SETSIZE on.
+ *
+ * @signature  double bench_select(const struct fds_t* fds,
+ *   const int* readyIndices, int numReady)
+ *
+ * @param      fds descriptors to watch.
+ * @param      readyIndices indices of the descriptors made ready.
+ * @param      numReady number of descriptors made ready per wait.
+ *
+ * @return     nanoseconds per wait; negative if not measurable.
+ */
+double bench_select(const struct fds_t* fds, const int* readyIndices, int numReady)
+{
+    Files files;
+    files_init(&files);
+    for (register int i = 0; i < fds->count; ++i)
+    {
+        if (fds->watched[i] >= FD_SETSIZE)
+        {
+            return -1;
+        }
+        files_add_file(&files,fds->watched[i]);
+    }
+
+    long elapsed = 0;
+    int numWaits = 0;
+    while (!is_measured(numWaits,elapsed))
+    {
+        fds_make_ready(fds,readyIndices,numReady);
+        long start = current_time_ns();
+        if (files_select(&files) == -1)
+        {
+            fatal_error("select");
+        }
+        int found = 0;
+        for (std::set<int>::iterator fd = files.fdSet.begin(); fd != files.fdSet.end(); ++fd)
+        {
+            if (FD_ISSET(*fd,&files.selectFds)) found++;
+        }
+        elapsed += current_time_ns()-start;
+        numWaits++;
+        if (found != numReady)
+        {
+            fprintf(stderr,"select reported %d of %d ready descriptors\n",found,numReady);
+        }
+        fds_clear(fds,readyIndices,numReady);
+    }
+    return (double) elapsed/numWaits;
+}
+
+/**
+ * measures poll over an array of every descriptor, followed by a scan of
+ *   the array for the ready ones.
+ *
+ * @function   bench_poll
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  double bench_poll(const struct fds_t* fds,
+ *   const int* readyIndices, int numReady)
+ *
+ * @param      fds descriptors to watch.
+ * @param      readyIndices indices of the descriptors made ready.
+ * @param      numReady number of descriptors made ready per wait.
+ *
+ * @return     nanoseconds per wait.
+ */
+double bench_poll(const struct fds_t* fds, const int* readyIndices, int numReady)
+{
+    struct pollfd* pollFds = (struct pollfd*) malloc(sizeof(struct pollfd)*fds->count);
+    for (register int i = 0; i < fds->count; ++i)
+    {
+        pollFds[i].fd = fds->watched[i];
+        pollFds[i].events = POLLIN;
+    }
+
+    long elapsed = 0;
+    int numWaits = 0;
+    while (!is_measured(numWaits,elapsed))
+    {
+        fds_make_ready(fds,readyIndices,numReady);
+        long start = current_time_ns();
+        if (poll(pollFds,fds->count,-1) == -1)
+        {
+            fatal_error("poll");
+        }
+        int found = 0;
+        for (register int i = 0; i < fds->count; ++i)
+        {
+            if (pollFds[i].revents&POLLIN) found++;
+        }
+        elapsed += current_time_ns()-start;
+        numWaits++;
+        if (found != numReady)
+        {
+            fprintf(stderr,"poll reported %d of %d ready descriptors\n",found,numReady);
+        }
+        fds_clear(fds,readyIndices,numReady);
+    }
+    free(pollFds);
+    return (double) elapsed/numWaits;
+}
+
+/**
+ * measures epoll_wait, level or edge triggered, until every ready descriptor
+ *   has been reported.
+ *
+ * @function   bench_epoll
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the events array holds every ready descriptor, so one call is
+ *   normally enough.
+ *
+ * @signature  double bench_epoll(const struct fds_t* fds,
+ *   const int* readyIndices, int numReady, bool isEdgeTriggered)
+ *
+ * @param      fds descriptors to watch.
+ * @param      readyIndices indices of the descriptors made ready.
+ * @param      numReady number of descriptors made ready per wait.
+ * @param      isEdgeTriggered true to register the descriptors with EPOLLET.
+ *
+ * @return     nanoseconds per wait.
+ */
+double bench_epoll(const struct fds_t* fds, const int* readyIndices, int numReady, bool isEdgeTriggered)
+{
+    int epoll = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll == -1)
+    {
+        fatal_error("epoll_create1");
+    }
+    for (register int i = 0; i < fds->count; ++i)
+    {
+        struct epoll_event event = epoll_event();
+        event.events = isEdgeTriggered ? EPOLLIN|EPOLLET : EPOLLIN;
+        event.data.u32 = i;
+        if (epoll_ctl(epoll,EPOLL_CTL_ADD,fds->watched[i],&event) == -1)
+        {
+            fatal_error("epoll_ctl");
+        }
+    }
+    struct epoll_event* events = (struct epoll_event*) malloc(sizeof(struct epoll_event)*numReady);
+
+    long elapsed = 0;
+    int numWaits = 0;
+    while (!is_measured(numWaits,elapsed))
+    {
+        fds_make_ready(fds,readyIndices,numReady);
+        long start = current_time_ns();
+        for (int found = 0; found < numReady;)
+        {
+            int eventCount = epoll_wait(epoll,events,numReady-found,-1);
+            if (eventCount == -1)
+            {
+                fatal_error("epoll_wait");
+            }
+            found += eventCount;
+        }
+        elapsed += current_time_ns()-start;
+        numWaits++;
+        fds_clear(fds,readyIndices,numReady);
+    }
+    free(events);
+    close(epoll);
+    return (double) elapsed/numWaits;
+}
+
+/**
+ * sets up an io_uring with raw system calls.
+ *
+ * @function   ring_open
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       fails where io_uring is not built in, or is disabled by
+ *   kernel.io_uring_disabled or a seccomp filter.
+ *
+ * @signature  bool ring_open(struct ring_t* ring, unsigned sqEntries,
+ *   unsigned cqEntries)
+ *
+ * @param      ring set to the new ring.
+ * @param      sqEntries number of submission queue entries.
+ * @param      cqEntries number of completion queue entries.
+ *
+ * @return     true on success.
+ */
+bool ring_open(struct ring_t* ring, unsigned sqEntries, unsigned cqEntries)
+{
+    struct io_uring_params params;
+    memset(&params,0,sizeof(params));
+    params.flags = IORING_SETUP_CQSIZE;
+    params.cq_entries = cqEntries;
+    ring->fd = (int) syscall(__NR_io_uring_setup,sqEntries,&params);
+    if (ring->fd == -1)
+    {
+        return false;
+    }
+
+    ring->sqRingLen = params.sq_off.array+params.sq_entries*sizeof(unsigned);
+    ring->cqRingLen = params.cq_off.cqes+params.cq_entries*sizeof(struct io_uring_cqe);
+    ring->sqRing = mmap(0,ring->sqRingLen,PROT_READ|PROT_WRITE,MAP_SHARED|MAP_POPULATE,ring->fd,IORING_OFF_SQ_RING);
+    ring->cqRing = mmap(0,ring->cqRingLen,PROT_READ|PROT_WRITE,MAP_SHARED|MAP_POPULATE,ring->fd,IORING_OFF_CQ_RING);
+    ring->sqes = (struct io_uring_sqe*) mmap(0,params.sq_entries*sizeof(struct io_uring_sqe),PROT_READ|PROT_WRITE,MAP_SHARED|MAP_POPULATE,ring->fd,IORING_OFF_SQES);
+    if (ring->sqRing == MAP_FAILED || ring->cqRing == MAP_FAILED || ring->sqes == MAP_FAILED)
+    {
+        fatal_error("mmap");
+    }
+
+    char* sq = (char*) ring->sqRing;
+    char* cq = (char*) ring->cqRing;
+    ring->sqHead = (unsigned*) (sq+params.sq_off.head);
+    ring->sqTail = (unsigned*) (sq+params.sq_off.tail);
+    ring->sqMask = (unsigned*) (sq+params.sq_off.ring_mask);
+    ring->sqArray = (unsigned*) (sq+params.sq_off.array);
+    ring->sqEntries = params.sq_entries;
+    ring->cqHead = (unsigned*) (cq+params.cq_off.head);
+    ring->cqTail = (unsigned*) (cq+params.cq_off.tail);
+    ring->cqMask = (unsigned*) (cq+params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe*) (cq+params.cq_off.cqes);
+    ring->numPending = 0;
+    return true;
+}
+
+/**
+ * tears down {ring}; polls still armed on it are cancelled.
+ *
+ * @function   ring_close
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  void ring_close(struct ring_t* ring)
+ *
+ * @param      ring ring to tear down.
+ */
+void ring_close(struct ring_t* ring)
+{
+    munmap(ring->sqes,ring->sqEntries*sizeof(struct io_uring_sqe));
+    munmap(ring->cqRing,ring->cqRingLen);
+    munmap(ring->sqRing,ring->sqRingLen);
+    close(ring->fd);
+}
+
+/**
+ * submits the submission queue entries queued on {ring}, and waits for at
+ *   least {minComplete} completions.
+ *
+ * @function   ring_enter
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  void ring_enter(struct ring_t* ring, unsigned minComplete)
+ *
+ * @param      ring ring to submit to.
+ * @param      minComplete completions to wait for; 0 not to wait.
+ */
+void ring_enter(struct ring_t* ring, unsigned minComplete)
+{
+    while (ring->numPending > 0 || minComplete > 0)
+    {
+        int result = (int) syscall(__NR_io_uring_enter,ring->fd,ring->numPending,minComplete,minComplete > 0 ? IORING_ENTER_GETEVENTS : 0,0,0);
+        if (result == -1)
+        {
+            if (errno == EINTR) continue;
+            fatal_error("io_uring_enter");
+        }
+        ring->numPending -= result;
+        break;
+    }
+}
+
+/**
+ * queues a multishot poll for {fd} on {ring}, submitting the queue first if
+ *   it is full.
+ *
+ * @function   ring_poll_add
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       a multishot poll posts a completion every time the descriptor
+ *   becomes ready, until it is cancelled.
+ *
+ * @signature  void ring_poll_add(struct ring_t* ring, int fd,
+ *   unsigned long long userData)
+ *
+ * @param      ring ring to queue the poll on.
+ * @param      fd descriptor to poll.
+ * @param      userData value the completions carry.
+ */
+void ring_poll_add(struct ring_t* ring, int fd, unsigned long long userData)
+{
+    if (ring->numPending == ring->sqEntries)
+    {
+        ring_enter(ring,0);
+    }
+    unsigned tail = *ring->sqTail;
+    unsigned index = tail&*ring->sqMask;
+    struct io_uring_sqe* sqe = ring->sqes+index;
+    memset(sqe,0,sizeof(*sqe));
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = fd;
+    sqe->poll32_events = POLLIN;
+    sqe->len = IORING_POLL_ADD_MULTI;
+    sqe->user_data = userData;
+    ring->sqArray[index] = index;
+    __atomic_store_n(ring->sqTail,tail+1,__ATOMIC_RELEASE);
+    ring->numPending++;
+}
+
+/**
+ * measures io_uring_enter waiting for the multishot polls of the ready
+ *   descriptors to complete, and the reaping of their completions.
+ *
+ * @function   bench_io_uring
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       a poll that completes for good, without IORING_CQE_F_MORE, is
+ *   armed again, and the rearming is timed as part of the wait.
+ *
+ * @signature  double bench_io_uring(const struct fds_t* fds,
+ *   const int* readyIndices, int numReady)
+ *
+ * @param      fds descriptors to watch.
+ * @param      readyIndices indices of the descriptors made ready.
+ * @param      numReady number of descriptors made ready per wait.
+ *
+ * @return     nanoseconds per wait; negative if io_uring is not available.
+ */
+double bench_io_uring(const struct fds_t* fds, const int* readyIndices, int numReady)
+{
+    unsigned cqEntries = 4096;
+    while (cqEntries < (unsigned) numReady*2) cqEntries *= 2;
+    struct ring_t ring;
+    if (!ring_open(&ring,1024,cqEntries))
+    {
+        errno = 0;
+        return -1;
+    }
+    for (register int i = 0; i < fds->count; ++i)
+    {
+        ring_poll_add(&ring,fds->watched[i],i);
+    }
+    ring_enter(&ring,0);
+
+    long elapsed = 0;
+    int numWaits = 0;
+    while (!is_measured(numWaits,elapsed))
+    {
+        fds_make_ready(fds,readyIndices,numReady);
+        long start = current_time_ns();
+        for (int found = 0; found < numReady;)
+        {
+            ring_enter(&ring,numReady-found);
+            unsigned head = *ring.cqHead;
+            unsigned tail = __atomic_load_n(ring.cqTail,__ATOMIC_ACQUIRE);
+            for (; head != tail; ++head)
+            {
+                struct io_uring_cqe* cqe = ring.cqes+(head&*ring.cqMask);
+                if (cqe->res < 0)
+                {
+                    errno = -cqe->res;
+                    fatal_error("IORING_OP_POLL_ADD");
+                }
+                if (!(cqe->flags&IORING_CQE_F_MORE))
+                {
+                    ring_poll_add(&ring,fds->watched[cqe->user_data],cqe->user_data);
+                }
+                found++;
+            }
+            __atomic_store_n(ring.cqHead,head,__ATOMIC_RELEASE);
+        }
+        elapsed += current_time_ns()-start;
+        numWaits++;
+        fds_clear(fds,readyIndices,numReady);
+    }
+    ring_close(&ring);
+    return (double) elapsed/numWaits;
+}
+
+/**
+ * prints one row of the results table.
+ *
+ * @function   print_row
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       mechanisms that could not be measured print n/a.
+ *
+ * @signature  void print_row(const char* mechanism, int numFds, int numReady,
+ *   double waitTime)
+ *
+ * @param      mechanism name of the mechanism.
+ * @param      numFds number of descriptors watched.
+ * @param      numReady number of descriptors ready per wait.
+ * @param      waitTime nanoseconds per wait; negative if not measured.
+ */
+void print_row(const char* mechanism, int numFds, int numReady, double waitTime)
+{
+    if (waitTime < 0)
+    {
+        printf("%-10s %8d %8d %14s %14s\n",mechanism,numFds,numReady,"n/a","n/a");
+    }
+    else
+    {
+        printf("%-10s %8d %8d %14.0f %14.1f\n",mechanism,numFds,numReady,waitTime,waitTime/numReady);
+    }
+    fflush(stdout);
+}
+
+/**
+ * main entry point of the application.
+ *
+ * parses command line arguments, then measures every mechanism for every
+ *   combination of descriptor count and ready count, printing a row each.
+ *
+ * @function   main
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the descriptor limit is raised as far as the hard limit allows;
+ *   descriptor counts beyond it are skipped.
+ *
+ * @signature  int main (int argc, char* argv[])
+ *
+ * @param      argc number of command line arguments.
+ * @param      argv array of c-style strings.
+ *
+ * @return     exit code of the application.
+ */
+int main (int argc, char* argv[])
+{
+    long fdCounts[EVBENCH_LIST_LEN] = {10,100,1000,10000,100000};
+    int numFdCounts = 5;
+    long readyCounts[EVBENCH_LIST_LEN] = {1,10,100};
+    int numReadyCounts = 3;
+    bool isSocketPair = false;
+
+    // parse command line arguments
+    {
+        int option;
+        while ((option = getopt(argc,argv,"n:k:s")) != -1)
+        {
+            switch (option)
+            {
+            case 'n':
+            case 'k':
+                {
+                    long* values = option == 'n' ? fdCounts : readyCounts;
+                    int* count = option == 'n' ? &numFdCounts : &numReadyCounts;
+                    long parsed[EVBENCH_LIST_LEN];
+                    int numParsed = parse_list(optarg,parsed);
+                    if (numParsed == 0)
+                    {
+                        fprintf(stderr,"invalid argument for option -%c\n",option);
+                    }
+                    else
+                    {
+                        memcpy(values,parsed,sizeof(parsed));
+                        *count = numParsed;
+                    }
+                    break;
+                }
+            case 's':
+                {
+                    isSocketPair = true;
+                    break;
+                }
+            case '?':
+                {
+                    if (isprint(optopt))
+                    {
+                        fprintf(stderr,"unknown option \"-%c\".\n",optopt);
+                    }
+                    else
+                    {
+                        fprintf(stderr,"unknown option character \"%x\".\n",optopt);
+                    }
+                }
+            default:
+                {
+                    fprintf(stderr,"usage: %s [-n descriptor counts, e.g. 10,1000,100000] [-k ready counts, e.g. 1,10,100] [-s use socket pairs instead of eventfds]\n",argv[0]);
+                    return EX_USAGE;
+                }
+            }
+        }
+    }
+
+    // allow as many descriptors as the hard limit does
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE,&limit) == 0)
+    {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE,&limit);
+    }
+
+    printf("# readiness notification cost over %s; times in ns\n",isSocketPair ? "socket pairs" : "eventfds");
+    printf("# %-8s %8s %8s %14s %14s\n","mechanism","fds","ready","per_wait","per_event");
+    for (register int n = 0; n < numFdCounts; ++n)
+    {
+        struct fds_t fds;
+        if (!fds_open(&fds,(int) fdCounts[n],isSocketPair))
+        {
+            fprintf(stderr,"cannot open %ld descriptors; skipping\n",fdCounts[n]);
+            continue;
+        }
+        for (register int k = 0; k < numReadyCounts; ++k)
+        {
+            if (readyCounts[k] > fdCounts[n]) continue;
+
+            // spread the ready descriptors evenly over the watched ones
+            int numReady = (int) readyCounts[k];
+            int* readyIndices = (int*) malloc(sizeof(int)*numReady);
+            for (register int i = 0; i < numReady; ++i)
+            {
+                readyIndices[i] = (int) ((long) i*fds.count/numReady);
+            }
+
+            print_row("select",fds.count,numReady,bench_select(&fds,readyIndices,numReady));
+            print_row("poll",fds.count,numReady,bench_poll(&fds,readyIndices,numReady));
+            print_row("epoll_lt",fds.count,numReady,bench_epoll(&fds,readyIndices,numReady,false));
+            print_row("epoll_et",fds.count,numReady,bench_epoll(&fds,readyIndices,numReady,true));
+            print_row("io_uring",fds.count,numReady,bench_io_uring(&fds,readyIndices,numReady));
+            free(readyIndices);
+        }
+        fds_close(&fds);
+    }
+    return EX_OK;
+}
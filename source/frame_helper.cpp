@@ -0,0 +1,433 @@
+#include "frame_helper.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sysexits.h>
+#include <arpa/inet.h>
+
+/**
+ * free reassembly buffers of one thread, by power-of-two class; each free
+ *   buffer links to the next through its first bytes. freed when the thread
+ *   exits.
+ */
+struct frame_pool_t
+{
+    char* freeLists[FRAME_POOL_MAX_SHIFT-FRAME_POOL_MIN_SHIFT+1];
+    int numFree[FRAME_POOL_MAX_SHIFT-FRAME_POOL_MIN_SHIFT+1];
+
+    ~frame_pool_t()
+    {
+        for (int i = 0; i <= FRAME_POOL_MAX_SHIFT-FRAME_POOL_MIN_SHIFT; ++i)
+        {
+            while (freeLists[i] != 0)
+            {
+                char* buf = freeLists[i];
+                memcpy(&freeLists[i],buf,sizeof(char*));
+                free(buf);
+            }
+        }
+    }
+};
+
+static thread_local struct frame_pool_t framePool;
+
+static enum frame_result_t too_long(const char* header, size_t messageLen, struct frame_t* frame);
+static char* acquire_buffer(size_t len, size_t* cap);
+static void release_buffer(char* buf, size_t cap);
+static void fatal_error(const char* errstr);
+
+/**
+ * initializes {reader} for a new connection.
+ *
+ * @function   frame_reader_init
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       {reader} may hold anything from a previous connection that was
+ *   destroyed.
+ *
+ * @signature  void frame_reader_init(struct frame_reader_t* reader,
+ *   size_t maxMessageLen)
+ *
+ * @param      reader reader to initialize.
+ * @param      maxMessageLen biggest message to accept.
+ */
+void frame_reader_init(struct frame_reader_t* reader, size_t maxMessageLen)
+{
+    memset(reader,0,sizeof(struct frame_reader_t));
+    reader->maxMessageLen = maxMessageLen;
+}
+
+/**
+ * gives the reassembly buffers of {reader} back to the pool of the thread.
+ *
+ * @function   frame_reader_destroy
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       a split frame that was never completed is dropped.
+ *
+ * @signature  void frame_reader_destroy(struct frame_reader_t* reader)
+ *
+ * @param      reader reader to destroy.
+ */
+void frame_reader_destroy(struct frame_reader_t* reader)
+{
+    if (reader->returned != 0)
+    {
+        release_buffer(reader->returned,reader->returnedCap);
+        reader->returned = 0;
+    }
+    if (reader->partial != 0)
+    {
+        release_buffer(reader->partial,reader->partialCap);
+        reader->partial = 0;
+    }
+}
+
+/**
+ * gives the next bytes of the stream to {reader}, to be split by
+ *   frame_reader_next.
+ *
+ * @function   frame_reader_feed
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       frames returned since the last feed become invalid: {data} is
+ *   expected to reuse the memory of the last feed, and the reassembly buffer
+ *   of a frame returned from it goes back to the pool.
+ *
+ * @signature  void frame_reader_feed(struct frame_reader_t* reader,
+ *   const char* data, size_t len)
+ *
+ * @param      reader reader of the connection.
+ * @param      data bytes read from the connection; must stay valid until the
+ *   next feed.
+ * @param      len number of bytes read.
+ */
+void frame_reader_feed(struct frame_reader_t* reader, const char* data, size_t len)
+{
+    if (reader->returned != 0)
+    {
+        release_buffer(reader->returned,reader->returnedCap);
+        reader->returned = 0;
+    }
+    reader->input = data;
+    reader->inputLen = len;
+}
+
+/**
+ * returns the next complete frame of the bytes fed to {reader}.
+ *
+ * @function   frame_reader_next
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       a frame that lies within the bytes of the last feed points into
+ *   them. a frame that started in an earlier feed is copied into a
+ *   reassembly buffer as its bytes arrive, so only the first frame of a feed
+ *   can be reassembled, and the frames after it are back to back in the fed
+ *   bytes. the length prefix of a frame may be split too; it is kept in the
+ *   reader until it is complete, so no buffer is taken before the length of
+ *   the frame is known.
+ *
+ * @signature  enum frame_result_t frame_reader_next(
+ *   struct frame_reader_t* reader, struct frame_t* frame)
+ *
+ * @param      reader reader of the connection.
+ * @param      frame set to the frame, if one is returned; valid until the next
+ *   feed. set to the length prefix alone if it is over the limit.
+ *
+ * @return     FRAME_READY if a frame was returned, FRAME_NEED_MORE once every
+ *   fed byte has been used, or FRAME_TOO_LONG if a length prefix is over the
+ *   limit, after which the connection should be closed.
+ */
+enum frame_result_t frame_reader_next(struct frame_reader_t* reader, struct frame_t* frame)
+{
+    // carry on with a length prefix split across feeds
+    if (reader->headerLen > 0)
+    {
+        size_t take = FRAME_HEADER_LEN-reader->headerLen;
+        if (take > reader->inputLen)
+        {
+            take = reader->inputLen;
+        }
+        memcpy(reader->header+reader->headerLen,reader->input,take);
+        reader->headerLen += take;
+        reader->input += take;
+        reader->inputLen -= take;
+        if (reader->headerLen < FRAME_HEADER_LEN)
+        {
+            return FRAME_NEED_MORE;
+        }
+
+        // the length is known; the rest of the frame goes into a buffer
+        uint32_t messageLen;
+        memcpy(&messageLen,reader->header,sizeof(messageLen));
+        messageLen = ntohl(messageLen);
+        if (messageLen > reader->maxMessageLen)
+        {
+            return too_long(reader->header,messageLen,frame);
+        }
+        reader->frameLen = FRAME_HEADER_LEN+(size_t) messageLen;
+        reader->partial = acquire_buffer(reader->frameLen,&reader->partialCap);
+        memcpy(reader->partial,reader->header,FRAME_HEADER_LEN);
+        reader->partialLen = FRAME_HEADER_LEN;
+        reader->headerLen = 0;
+    }
+
+    // carry on with a frame split across feeds
+    if (reader->partial != 0)
+    {
+        size_t take = reader->frameLen-reader->partialLen;
+        if (take > reader->inputLen)
+        {
+            take = reader->inputLen;
+        }
+        memcpy(reader->partial+reader->partialLen,reader->input,take);
+        reader->partialLen += take;
+        reader->input += take;
+        reader->inputLen -= take;
+        if (reader->partialLen < reader->frameLen)
+        {
+            return FRAME_NEED_MORE;
+        }
+
+        // complete; its buffer goes back to the pool on the next feed
+        reader->returned = reader->partial;
+        reader->returnedCap = reader->partialCap;
+        reader->partial = 0;
+        frame->data = reader->returned;
+        frame->len = reader->frameLen;
+        frame->message = frame->data+FRAME_HEADER_LEN;
+        frame->messageLen = frame->len-FRAME_HEADER_LEN;
+        frame->isReassembled = true;
+        return FRAME_READY;
+    }
+
+    // the fed bytes end with a split length prefix
+    if (reader->inputLen < FRAME_HEADER_LEN)
+    {
+        memcpy(reader->header,reader->input,reader->inputLen);
+        reader->headerLen = reader->inputLen;
+        reader->input += reader->inputLen;
+        reader->inputLen = 0;
+        return FRAME_NEED_MORE;
+    }
+
+    uint32_t messageLen;
+    memcpy(&messageLen,reader->input,sizeof(messageLen));
+    messageLen = ntohl(messageLen);
+    if (messageLen > reader->maxMessageLen)
+    {
+        return too_long(reader->input,messageLen,frame);
+    }
+    size_t frameLen = FRAME_HEADER_LEN+(size_t) messageLen;
+
+    // the fed bytes end with a split frame; copy its start into a buffer
+    if (reader->inputLen < frameLen)
+    {
+        reader->frameLen = frameLen;
+        reader->partial = acquire_buffer(frameLen,&reader->partialCap);
+        memcpy(reader->partial,reader->input,reader->inputLen);
+        reader->partialLen = reader->inputLen;
+        reader->input += reader->inputLen;
+        reader->inputLen = 0;
+        return FRAME_NEED_MORE;
+    }
+
+    // the frame lies within the fed bytes; return it in place
+    frame->data = reader->input;
+    frame->len = frameLen;
+    frame->message = frame->data+FRAME_HEADER_LEN;
+    frame->messageLen = messageLen;
+    frame->isReassembled = false;
+    reader->input += frameLen;
+    reader->inputLen -= frameLen;
+    return FRAME_READY;
+}
+
+/**
+ * sets {frame} to a length prefix that is over the limit, so the caller can
+ *   tell what was read.
+ *
+ * @function   too_long
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  static enum frame_result_t too_long(const char* header,
+ *   size_t messageLen, struct frame_t* frame)
+ *
+ * @param      header the length prefix.
+ * @param      messageLen the length it holds.
+ * @param      frame set to the length prefix, with no message.
+ *
+ * @return     FRAME_TOO_LONG.
+ */
+static enum frame_result_t too_long(const char* header, size_t messageLen, struct frame_t* frame)
+{
+    frame->data = header;
+    frame->len = FRAME_HEADER_LEN;
+    frame->message = 0;
+    frame->messageLen = messageLen;
+    frame->isReassembled = false;
+    return FRAME_TOO_LONG;
+}
+
+/**
+ * takes a buffer of at least {len} bytes from the pool of the thread.
+ *
+ * @function   acquire_buffer
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       buffers are sized up to a power of two, so a buffer can be
+ *   reused for any frame of its class. a frame bigger than the biggest class
+ *   gets a buffer of its own size.
+ *
+ * @signature  static char* acquire_buffer(size_t len, size_t* cap)
+ *
+ * @param      len bytes needed.
+ * @param      cap set to the bytes of the buffer.
+ *
+ * @return     the buffer.
+ */
+static char* acquire_buffer(size_t len, size_t* cap)
+{
+    int shift = FRAME_POOL_MIN_SHIFT;
+    while (shift <= FRAME_POOL_MAX_SHIFT && ((size_t) 1<<shift) < len)
+    {
+        ++shift;
+    }
+
+    char* buf;
+    if (shift > FRAME_POOL_MAX_SHIFT)
+    {
+        *cap = len;
+        buf = (char*) malloc(len);
+    }
+    else if (framePool.freeLists[shift-FRAME_POOL_MIN_SHIFT] != 0)
+    {
+        *cap = (size_t) 1<<shift;
+        buf = framePool.freeLists[shift-FRAME_POOL_MIN_SHIFT];
+        memcpy(&framePool.freeLists[shift-FRAME_POOL_MIN_SHIFT],buf,sizeof(char*));
+        framePool.numFree[shift-FRAME_POOL_MIN_SHIFT]--;
+    }
+    else
+    {
+        *cap = (size_t) 1<<shift;
+        buf = (char*) malloc(*cap);
+    }
+    if (buf == 0)
+    {
+        fatal_error("malloc");
+    }
+    return buf;
+}
+
+/**
+ * gives a buffer taken by acquire_buffer back to the pool of the thread.
+ *
+ * @function   release_buffer
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the buffer may have been taken on another thread; it joins the
+ *   pool of this one. freed instead once its class holds
+ *   FRAME_POOL_CLASS_LEN bytes of free buffers.
+ *
+ * @signature  static void release_buffer(char* buf, size_t cap)
+ *
+ * @param      buf buffer to give back.
+ * @param      cap bytes of the buffer, as set by acquire_buffer.
+ */
+static void release_buffer(char* buf, size_t cap)
+{
+    int shift = FRAME_POOL_MIN_SHIFT;
+    while (shift <= FRAME_POOL_MAX_SHIFT && ((size_t) 1<<shift) != cap)
+    {
+        ++shift;
+    }
+
+    int index = shift-FRAME_POOL_MIN_SHIFT;
+    if (shift > FRAME_POOL_MAX_SHIFT ||
+        (framePool.numFree[index] > 0 && (size_t) (framePool.numFree[index]+1)*cap > FRAME_POOL_CLASS_LEN))
+    {
+        free(buf);
+        return;
+    }
+    memcpy(buf,&framePool.freeLists[index],sizeof(char*));
+    framePool.freeLists[index] = buf;
+    framePool.numFree[index]++;
+}
+
+/**
+ * prints the error message, then exits the program.
+ *
+ * @function   fatal_error
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  static void fatal_error(const char* errstr)
+ *
+ * @param      errstr string to print before exiting the program
+ */
+static void fatal_error(const char* errstr)
+{
+    fprintf(stderr,"%s: ",errstr);
+    perror(0);
+    exit(EX_OSERR);
+}
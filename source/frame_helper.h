@@ -0,0 +1,84 @@
+#ifndef _FRAME_HELPER_H_
+#define _FRAME_HELPER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * bytes of the length prefix of a frame: the length of its message, as a
+ *   32-bit big-endian integer.
+ */
+#define FRAME_HEADER_LEN 4
+
+/**
+ * smallest and biggest reassembly buffers kept by the pool of a thread, as
+ *   powers of two; a buffer of a frame bigger than the biggest class is freed
+ *   instead of pooled.
+ */
+#define FRAME_POOL_MIN_SHIFT 12
+#define FRAME_POOL_MAX_SHIFT 25
+
+/**
+ * bytes of free buffers the pool of a thread keeps of each class; at least
+ *   one buffer is kept of every class.
+ */
+#define FRAME_POOL_CLASS_LEN (4*1024*1024)
+
+/**
+ * a complete frame: its length prefix, then its message. points either into
+ *   the bytes fed to the reader, or into its reassembly buffer.
+ */
+struct frame_t
+{
+    const char* data;               // the frame, length prefix first
+    size_t len;                     // bytes of the frame, prefix included
+    const char* message;            // data+FRAME_HEADER_LEN
+    size_t messageLen;
+    bool isReassembled;             // copied out of more than one feed
+};
+
+/**
+ * what frame_reader_next found.
+ */
+enum frame_result_t
+{
+    FRAME_READY,                    // a frame was returned
+    FRAME_NEED_MORE,                // every fed byte was used; feed more
+    FRAME_TOO_LONG                  // a length prefix is over the limit
+};
+
+/**
+ * splits a stream of bytes into length-prefixed frames. frames that lie
+ *   within the bytes of one feed are returned in place, without copying; only
+ *   a frame that is split across feeds is copied, into a reassembly buffer
+ *   taken from a pool of the thread. one reader per connection.
+ */
+struct frame_reader_t
+{
+    size_t maxMessageLen;           // biggest message accepted
+    const char* input;              // bytes fed, and not yet split
+    size_t inputLen;
+    char header[FRAME_HEADER_LEN];  // start of a split length prefix
+    size_t headerLen;
+    char* partial;                  // reassembly buffer of a split frame
+    size_t partialLen;              // bytes of the split frame in it
+    size_t partialCap;
+    size_t frameLen;                // bytes of the split frame, prefix included
+    char* returned;                 // reassembly buffer returned by this feed
+    size_t returnedCap;
+};
+
+void frame_reader_init(struct frame_reader_t* reader, size_t maxMessageLen);
+void frame_reader_destroy(struct frame_reader_t* reader);
+void frame_reader_feed(struct frame_reader_t* reader, const char* data, size_t len);
+enum frame_result_t frame_reader_next(struct frame_reader_t* reader, struct frame_t* frame);
+
+/**
+ * returns true if {reader} holds no part of a frame, split across feeds.
+ */
+inline bool frame_reader_is_empty(const struct frame_reader_t* reader)
+{
+    return reader->headerLen == 0 && reader->partial == 0;
+}
+
+#endif
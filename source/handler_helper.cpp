@@ -0,0 +1,426 @@
+#include "handler_helper.h"
+
+#include <errno.h>
+#include <sys/uio.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+
+static bool make_chargen_pattern(char* pattern);
+static enum send_result_t send_spans(int fd, const struct span_t* spans, int numSpans, size_t* bytesSent);
+static int skip_spans(struct span_t* spans, int numSpans, size_t len);
+
+/**
+ * parses the name of a handler, as given to -a.
+ *
+ * @function   parse_handler
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  bool parse_handler(const char* name,
+ *   enum handler_kind_t* kind)
+ *
+ * @param      name one of echo, discard, chargen or length.
+ * @param      kind set to the handler named.
+ *
+ * @return     false if {name} names no handler.
+ */
+bool parse_handler(const char* name, enum handler_kind_t* kind)
+{
+    static const char* names[] = {"echo","discard","chargen","length"};
+    for (int i = 0; i < (int) (sizeof(names)/sizeof(names[0])); ++i)
+    {
+        if (strcmp(name,names[i]) == 0)
+        {
+            *kind = (enum handler_kind_t) i;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * returns the number of entries of a table indexed by file descriptor, such as
+ *   the conn_t of every connection.
+ *
+ * @function   handler_table_len
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       sized like the table of drain_t.
+ *
+ * @signature  int handler_table_len()
+ *
+ * @return     the limit on open file descriptors.
+ */
+int handler_table_len()
+{
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE,&limit) == -1 || limit.rlim_cur == RLIM_INFINITY)
+    {
+        limit.rlim_cur = 65536;
+    }
+    return (int) limit.rlim_cur;
+}
+
+/**
+ * returns two cycles of the chargen pattern.
+ *
+ * @function   chargen_pattern
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       made by the first call; the initialization of a function
+ *   local static is thread-safe.
+ *
+ * @signature  const char* chargen_pattern()
+ *
+ * @return     2*CHARGEN_CYCLE_LEN bytes of pattern.
+ */
+const char* chargen_pattern()
+{
+    static char pattern[2*CHARGEN_CYCLE_LEN];
+    static bool isMade = make_chargen_pattern(pattern);
+    (void) isMade;
+    return pattern;
+}
+
+/**
+ * sends what a handler responded with over the non-blocking socket {fd}, and
+ *   keeps what the socket does not take in {pending}.
+ *
+ * @function   handler_send
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the spans go out with one sendmsg. only the bytes left over that
+ *   lie in {readBuf} are copied; once this returns SEND_PENDING, the engine
+ *   stops reading the connection until handler_flush has sent them.
+ *
+ * @signature  enum send_result_t handler_send(int fd,
+ *   const struct handler_output_t* output, struct pending_output_t* pending,
+ *   const char* readBuf, size_t readLen)
+ *
+ * @param      fd connection to send on.
+ * @param      output what the handler responded with.
+ * @param      pending output of the connection not yet sent; must be empty.
+ * @param      readBuf read buffer of the engine, which may be reused once this
+ *   returns.
+ * @param      readLen bytes of {readBuf}.
+ *
+ * @return     SEND_DONE, SEND_PENDING, or SEND_FAILED if the connection
+ *   failed and should be closed.
+ */
+enum send_result_t handler_send(int fd, const struct handler_output_t* output,
+    struct pending_output_t* pending, const char* readBuf, size_t readLen)
+{
+    size_t bytesSent;
+    enum send_result_t result = send_spans(fd,output->spans,output->numSpans,&bytesSent);
+    if (result != SEND_PENDING)
+    {
+        return result;
+    }
+
+    // keep what is left over
+    memcpy(pending->spans,output->spans,output->numSpans*sizeof(struct span_t));
+    pending->numSpans = skip_spans(pending->spans,output->numSpans,bytesSent);
+
+    // copy the spans that lie in the read buffer
+    size_t copyLen = 0;
+    for (int i = 0; i < pending->numSpans; ++i)
+    {
+        if (pending->spans[i].data >= readBuf && pending->spans[i].data < readBuf+readLen)
+        {
+            copyLen += pending->spans[i].len;
+        }
+    }
+    if (copyLen > pending->copyCap)
+    {
+        pending->copy = (char*) realloc(pending->copy,copyLen);
+        pending->copyCap = copyLen;
+    }
+    char* cursor = pending->copy;
+    for (int i = 0; i < pending->numSpans; ++i)
+    {
+        if (pending->spans[i].data >= readBuf && pending->spans[i].data < readBuf+readLen)
+        {
+            memcpy(cursor,pending->spans[i].data,pending->spans[i].len);
+            pending->spans[i].data = cursor;
+            cursor += pending->spans[i].len;
+        }
+    }
+    return SEND_PENDING;
+}
+
+/**
+ * sends output of a connection that the socket did not take before.
+ *
+ * @function   handler_flush
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       called once the socket has room again.
+ *
+ * @signature  enum send_result_t handler_flush(int fd,
+ *   struct pending_output_t* pending)
+ *
+ * @param      fd connection to send on.
+ * @param      pending output of the connection not yet sent.
+ *
+ * @return     SEND_DONE once nothing is pending any more, SEND_PENDING, or
+ *   SEND_FAILED if the connection failed and should be closed.
+ */
+enum send_result_t handler_flush(int fd, struct pending_output_t* pending)
+{
+    size_t bytesSent;
+    enum send_result_t result = send_spans(fd,pending->spans,pending->numSpans,&bytesSent);
+    pending->numSpans = result == SEND_PENDING ? skip_spans(pending->spans,pending->numSpans,bytesSent) : 0;
+    return result;
+}
+
+/**
+ * drops the output of a connection not yet sent, and frees its copies.
+ *
+ * @function   handler_free_pending
+ *
+ * @date       2026-10-16
+ *
+ * @revision   2026-10-16 Eric Tsang - clears isClosing too.
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the connection is closing.
+ *
+ * @signature  void handler_free_pending(struct pending_output_t* pending)
+ *
+ * @param      pending output of the connection not yet sent.
+ */
+void handler_free_pending(struct pending_output_t* pending)
+{
+    free(pending->copy);
+    pending->copy = 0;
+    pending->copyCap = 0;
+    pending->numSpans = 0;
+    pending->isClosing = false;
+}
+
+/**
+ * prepares a connection the handler rejected to be closed without losing the
+ *   output its socket still holds.
+ *
+ * @function   handler_linger
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       sockets of the servers are set not to linger, so closing one
+ *   resets the connection, and drops the bytes it has not sent yet; so does
+ *   closing one that has bytes left to read. this lets the socket linger, and
+ *   reads and drops what has arrived, so the close sends the rest of the
+ *   output before it ends the connection. bytes that arrive later still reset
+ *   it.
+ *
+ * @signature  void handler_linger(int fd)
+ *
+ * @param      fd connection about to be closed.
+ */
+void handler_linger(int fd)
+{
+    struct linger linger;
+    memset(&linger,0,sizeof(linger));
+    setsockopt(fd,SOL_SOCKET,SO_LINGER,(char*) &linger,sizeof(linger));
+    char discard[HANDLER_READ_LEN];
+    while (recv(fd,discard,sizeof(discard),MSG_DONTWAIT) > 0);
+    shutdown(fd,SHUT_WR);
+    errno = 0;
+}
+
+/**
+ * sends {spans} over the non-blocking socket {fd} until they are sent, or the
+ *   socket is full.
+ *
+ * @function   send_spans
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       MSG_NOSIGNAL, so a connection reset by the peer fails instead
+ *   of raising SIGPIPE.
+ *
+ * @signature  static enum send_result_t send_spans(int fd,
+ *   const struct span_t* spans, int numSpans, size_t* bytesSent)
+ *
+ * @param      fd socket to send on.
+ * @param      spans bytes to send, in order.
+ * @param      numSpans number of entries in {spans}.
+ * @param      bytesSent set to the number of bytes sent.
+ *
+ * @return     SEND_DONE, SEND_PENDING, or SEND_FAILED.
+ */
+static enum send_result_t send_spans(int fd, const struct span_t* spans, int numSpans, size_t* bytesSent)
+{
+    struct iovec iov[HANDLER_MAX_SPANS];
+    size_t totalLen = 0;
+    for (int i = 0; i < numSpans; ++i)
+    {
+        iov[i].iov_base = (void*) spans[i].data;
+        iov[i].iov_len = spans[i].len;
+        totalLen += spans[i].len;
+    }
+
+    *bytesSent = 0;
+    int first = 0;
+    while (*bytesSent < totalLen)
+    {
+        struct msghdr message = msghdr();
+        message.msg_iov = iov+first;
+        message.msg_iovlen = numSpans-first;
+        ssize_t result = sendmsg(fd,&message,MSG_NOSIGNAL);
+        if (result == -1)
+        {
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                errno = 0;
+                return SEND_PENDING;
+            }
+            return SEND_FAILED;
+        }
+
+        // move past what was sent
+        *bytesSent += result;
+        while (first < numSpans && (size_t) result >= iov[first].iov_len)
+        {
+            result -= iov[first].iov_len;
+            first++;
+        }
+        if (first < numSpans)
+        {
+            iov[first].iov_base = (char*) iov[first].iov_base+result;
+            iov[first].iov_len -= result;
+        }
+    }
+    return SEND_DONE;
+}
+
+/**
+ * drops the first {len} bytes of {spans}.
+ *
+ * @function   skip_spans
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the spans left are moved to the front.
+ *
+ * @signature  static int skip_spans(struct span_t* spans, int numSpans,
+ *   size_t len)
+ *
+ * @param      spans spans to drop bytes from.
+ * @param      numSpans number of entries in {spans}.
+ * @param      len number of bytes to drop.
+ *
+ * @return     number of spans left.
+ */
+static int skip_spans(struct span_t* spans, int numSpans, size_t len)
+{
+    int first = 0;
+    while (first < numSpans && len >= spans[first].len)
+    {
+        len -= spans[first].len;
+        first++;
+    }
+    if (first < numSpans)
+    {
+        spans[first].data += len;
+        spans[first].len -= len;
+    }
+    memmove(spans,spans+first,(numSpans-first)*sizeof(struct span_t));
+    return numSpans-first;
+}
+
+/**
+ * writes two cycles of the chargen pattern to {pattern}.
+ *
+ * @function   make_chargen_pattern
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  static bool make_chargen_pattern(char* pattern)
+ *
+ * @param      pattern 2*CHARGEN_CYCLE_LEN bytes to write to.
+ *
+ * @return     true.
+ */
+static bool make_chargen_pattern(char* pattern)
+{
+    char* cursor = pattern;
+    for (int cycle = 0; cycle < 2; ++cycle)
+    {
+        for (int line = 0; line < 95; ++line)
+        {
+            for (int i = 0; i < 72; ++i)
+            {
+                *cursor++ = (char) (' '+(line+i)%95);
+            }
+            *cursor++ = '\r';
+            *cursor++ = '\n';
+        }
+    }
+    return true;
+}
@@ -0,0 +1,332 @@
+#ifndef _HANDLER_HELPER_H_
+#define _HANDLER_HELPER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <arpa/inet.h>
+#include "frame_helper.h"
+
+/**
+ * most spans a handler can ask to send in response to one read.
+ */
+#define HANDLER_MAX_SPANS 8
+
+/**
+ * bytes engines read from a connection at once for most handlers, and the
+ *   most any handler may ask for.
+ */
+#define HANDLER_READ_LEN 1024
+#define HANDLER_MAX_READ_LEN (64*1024)
+
+/**
+ * bytes of one cycle of the chargen pattern (RFC 864): 95 lines of 72
+ *   printable characters and CR LF, each starting one character further than
+ *   the one before.
+ */
+#define CHARGEN_CYCLE_LEN (95*74)
+
+/**
+ * biggest message accepted by the length-prefixed handler; a bigger length
+ *   prefix closes the connection.
+ */
+#define LENGTH_MAX_MESSAGE_LEN (16*1024*1024)
+
+/**
+ * protocols the servers can serve; selected with -a.
+ */
+enum handler_kind_t
+{
+    HANDLER_ECHO,
+    HANDLER_DISCARD,
+    HANDLER_CHARGEN,
+    HANDLER_LENGTH
+};
+
+/**
+ * bytes that are not owned by the span.
+ */
+struct span_t
+{
+    const char* data;
+    size_t len;
+};
+
+/**
+ * what a handler asks to send back in response to one read. the spans must
+ *   stay valid until the handler is next called for the connection; they may
+ *   point into the bytes read, as engines send the output before they read
+ *   again.
+ */
+struct handler_output_t
+{
+    struct span_t spans[HANDLER_MAX_SPANS];
+    int numSpans;
+};
+
+/**
+ * output of a handler that the socket has not taken yet. spans that pointed
+ *   into the read buffer of the engine are copied, as the engine reads other
+ *   connections into it; the rest stay the handler's, which keeps them valid
+ *   since it is not called for the connection again until they are sent.
+ */
+struct pending_output_t
+{
+    struct span_t spans[HANDLER_MAX_SPANS];
+    int numSpans;
+    char* copy;                 // copies of spans from the read buffer
+    size_t copyCap;
+    bool isClosing;             // the handler rejected the connection; close
+                                // it once the output is sent
+};
+
+/**
+ * what became of output sent with handler_send or handler_flush.
+ */
+enum send_result_t
+{
+    SEND_DONE,                  // every byte was sent
+    SEND_PENDING,               // the socket is full; the rest is pending
+    SEND_FAILED                 // the connection failed
+};
+
+bool parse_handler(const char* name, enum handler_kind_t* kind);
+int handler_table_len();
+const char* chargen_pattern();
+enum send_result_t handler_send(int fd, const struct handler_output_t* output,
+    struct pending_output_t* pending, const char* readBuf, size_t readLen);
+enum send_result_t handler_flush(int fd, struct pending_output_t* pending);
+void handler_free_pending(struct pending_output_t* pending);
+void handler_linger(int fd);
+
+/*
+ * a handler is a class with a conn_t structure for the state of one
+ *   connection, the number of bytes to read from it at once, and static
+ *   member functions, which the server engines call for every connection:
+ *
+ *   static const size_t readLen;
+ *       bytes the engines read from the connection at once; at most
+ *       HANDLER_MAX_READ_LEN.
+ *
+ *   static void on_accept(conn_t* conn, int fd);
+ *       the connection {fd} was accepted; initializes {conn}, which may hold
+ *       anything from a previous connection.
+ *
+ *   static bool on_data(conn_t* conn, struct span_t data,
+ *       struct handler_output_t* output);
+ *       {data} was read from the connection; sets {output} to what to send
+ *       back, in order. {data} is only valid during the call. returns false
+ *       to close the connection once {output} has been sent.
+ *
+ *   static void on_close(conn_t* conn);
+ *       the connection is closing; frees what {conn} holds.
+ *
+ *   static bool is_idle(conn_t* conn);
+ *       returns true if {conn} holds nothing that on_accept would not set up
+ *       again, so the connection can move to another worker.
+ *
+ * engines are templates of the handler, so its calls are inlined; with the
+ *   echo handler, an engine compiles to the plain recv and send loop.
+ */
+
+/**
+ * sends back every byte read.
+ */
+class echo_handler_t
+{
+public:
+    static const size_t readLen = HANDLER_READ_LEN;
+
+    struct conn_t
+    {
+    };
+
+    static void on_accept(conn_t* conn, int fd)
+    {
+        (void) conn;
+        (void) fd;
+    }
+
+    static bool on_data(conn_t* conn, struct span_t data, struct handler_output_t* output)
+    {
+        (void) conn;
+        output->spans[0] = data;
+        output->numSpans = 1;
+        return true;
+    }
+
+    static void on_close(conn_t* conn)
+    {
+        (void) conn;
+    }
+
+    static bool is_idle(conn_t* conn)
+    {
+        (void) conn;
+        return true;
+    }
+};
+
+/**
+ * sends nothing back (RFC 863).
+ */
+class discard_handler_t
+{
+public:
+    static const size_t readLen = HANDLER_READ_LEN;
+
+    struct conn_t
+    {
+    };
+
+    static void on_accept(conn_t* conn, int fd)
+    {
+        (void) conn;
+        (void) fd;
+    }
+
+    static bool on_data(conn_t* conn, struct span_t data, struct handler_output_t* output)
+    {
+        (void) conn;
+        (void) data;
+        output->numSpans = 0;
+        return true;
+    }
+
+    static void on_close(conn_t* conn)
+    {
+        (void) conn;
+    }
+
+    static bool is_idle(conn_t* conn)
+    {
+        (void) conn;
+        return true;
+    }
+};
+
+/**
+ * sends back as many bytes of the chargen pattern (RFC 864) as were read,
+ *   carrying on from where the previous response left off.
+ */
+class chargen_handler_t
+{
+public:
+    static const size_t readLen = HANDLER_READ_LEN;
+
+    struct conn_t
+    {
+        size_t offset;              // offset into the pattern cycle
+    };
+
+    static void on_accept(conn_t* conn, int fd)
+    {
+        (void) fd;
+        conn->offset = 0;
+    }
+
+    /**
+     * the pattern is stored twice over, so up to a whole cycle starting
+     *   anywhere in it is one span.
+     */
+    static bool on_data(conn_t* conn, struct span_t data, struct handler_output_t* output)
+    {
+        const char* pattern = chargen_pattern();
+        size_t len = data.len;
+        output->numSpans = 0;
+        while (len > 0 && output->numSpans < HANDLER_MAX_SPANS)
+        {
+            size_t spanLen = len < CHARGEN_CYCLE_LEN ? len : CHARGEN_CYCLE_LEN;
+            output->spans[output->numSpans].data = pattern+conn->offset;
+            output->spans[output->numSpans].len = spanLen;
+            output->numSpans++;
+            conn->offset = (conn->offset+spanLen)%CHARGEN_CYCLE_LEN;
+            len -= spanLen;
+        }
+        return true;
+    }
+
+    static void on_close(conn_t* conn)
+    {
+        (void) conn;
+    }
+
+    /**
+     * only at the start of the pattern, where a new connection starts too.
+     */
+    static bool is_idle(conn_t* conn)
+    {
+        return conn->offset == 0;
+    }
+};
+
+/**
+ * serves requests made of a 4-byte big-endian length and that many bytes of
+ *   message; the response to each is the request itself, sent back once it
+ *   has been read in full.
+ */
+class length_handler_t
+{
+public:
+    /**
+     * enough for most requests to be read in one piece, and parsed in place.
+     */
+    static const size_t readLen = HANDLER_MAX_READ_LEN;
+
+    struct conn_t
+    {
+        struct frame_reader_t reader;
+    };
+
+    static void on_accept(conn_t* conn, int fd)
+    {
+        (void) fd;
+        frame_reader_init(&conn->reader,LENGTH_MAX_MESSAGE_LEN);
+    }
+
+    /**
+     * requests are parsed in place; only one split across reads is copied, and
+     *   it can only be the first to complete. so the response is at most two
+     *   spans: that request, then the requests after it, which lie back to
+     *   back in {data}. on a length prefix over the limit, the requests before
+     *   it are still sent back before the connection closes.
+     */
+    static bool on_data(conn_t* conn, struct span_t data, struct handler_output_t* output)
+    {
+        struct frame_t frame;
+        enum frame_result_t result;
+        output->numSpans = 0;
+        frame_reader_feed(&conn->reader,data.data,data.len);
+        while ((result = frame_reader_next(&conn->reader,&frame)) == FRAME_READY)
+        {
+            struct span_t* last = output->numSpans > 0 ? output->spans+output->numSpans-1 : 0;
+            if (last != 0 && last->data+last->len == frame.data)
+            {
+                last->len += frame.len;
+            }
+            else
+            {
+                output->spans[output->numSpans].data = frame.data;
+                output->spans[output->numSpans].len = frame.len;
+                output->numSpans++;
+            }
+        }
+        return result != FRAME_TOO_LONG;
+    }
+
+    static void on_close(conn_t* conn)
+    {
+        frame_reader_destroy(&conn->reader);
+    }
+
+    /**
+     * not while part of a request has been read.
+     */
+    static bool is_idle(conn_t* conn)
+    {
+        return frame_reader_is_empty(&conn->reader);
+    }
+};
+
+#endif
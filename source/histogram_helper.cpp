@@ -0,0 +1,180 @@
+#include "histogram_helper.h"
+
+#include <string.h>
+
+static unsigned long histogram_bucket_top(size_t index);
+
+/**
+ * removes every sample from {histogram}.
+ *
+ * @function   histogram_reset
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  void histogram_reset(struct histogram_t* histogram)
+ *
+ * @param      histogram histogram to reset.
+ */
+void histogram_reset(struct histogram_t* histogram)
+{
+    memset(histogram,0,sizeof(struct histogram_t));
+}
+
+/**
+ * adds every sample of {other} to {histogram}.
+ *
+ * @function   histogram_merge
+ *
+ * @date       2026-10-16
+ *
+ * @revision   2026-10-16 Eric Tsang - counts the samples of {other} from the
+ *   buckets it read, rather than from its count.
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       {other} is read with relaxed atomic loads, so it may be merged
+ *   while the one thread that records into it is running, which stores with
+ *   relaxed atomic stores. buckets are read one after the other, so a sample
+ *   recorded meanwhile may be in the result or not; the count of the result
+ *   is the sum of the buckets read, so percentiles of it stay consistent.
+ *
+ * @signature  void histogram_merge(struct histogram_t* histogram,
+ *   const struct histogram_t* other)
+ *
+ * @param      histogram histogram to add the samples to.
+ * @param      other histogram to add the samples of.
+ */
+void histogram_merge(struct histogram_t* histogram, const struct histogram_t* other)
+{
+    for (size_t i = 0; i < HISTOGRAM_LEN; ++i)
+    {
+        unsigned long count = __atomic_load_n(other->counts+i,__ATOMIC_RELAXED);
+        histogram->counts[i] += count;
+        histogram->count += count;
+    }
+    unsigned long max = __atomic_load_n(&other->max,__ATOMIC_RELAXED);
+    if (histogram->max < max)
+    {
+        histogram->max = max;
+    }
+}
+
+/**
+ * makes {delta} hold the samples that were recorded into a histogram between
+ *   when it was {before}, and when it was {after}.
+ *
+ * @function   histogram_delta
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the largest sample of {delta} is only known to be in its top
+ *   non-empty bucket, so the top of that bucket is used.
+ *
+ * @signature  void histogram_delta(struct histogram_t* delta,
+ *   const struct histogram_t* after, const struct histogram_t* before)
+ *
+ * @param      delta histogram to fill in.
+ * @param      after later snapshot of the histogram.
+ * @param      before earlier snapshot of the histogram.
+ */
+void histogram_delta(struct histogram_t* delta, const struct histogram_t* after, const struct histogram_t* before)
+{
+    delta->max = 0;
+    for (size_t i = 0; i < HISTOGRAM_LEN; ++i)
+    {
+        delta->counts[i] = after->counts[i]-before->counts[i];
+        if (delta->counts[i] > 0)
+        {
+            delta->max = histogram_bucket_top(i);
+        }
+    }
+    delta->count = after->count-before->count;
+    if (delta->max > after->max)
+    {
+        delta->max = after->max;
+    }
+}
+
+/**
+ * returns the value that {percentile} percent of the samples in {histogram}
+ *   are less than or equal to.
+ *
+ * @function   histogram_percentile
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the top of the bucket the percentile falls in is returned, so
+ *   the result never understates the percentile; it is capped at the largest
+ *   sample.
+ *
+ * @signature  unsigned long histogram_percentile(
+ *   const struct histogram_t* histogram, double percentile)
+ *
+ * @param      histogram histogram to inspect.
+ * @param      percentile percentile to find, from 0 to 100.
+ *
+ * @return     the value at {percentile}, or 0 if the histogram is empty.
+ */
+unsigned long histogram_percentile(const struct histogram_t* histogram, double percentile)
+{
+    if (histogram->count == 0)
+    {
+        return 0;
+    }
+
+    // number of samples at or below the percentile, rounded up
+    double rank = percentile/100*histogram->count;
+    unsigned long target = (unsigned long) rank;
+    if (target < rank || target == 0)
+    {
+        target++;
+    }
+
+    unsigned long seen = 0;
+    for (size_t i = 0; i < HISTOGRAM_LEN; ++i)
+    {
+        seen += histogram->counts[i];
+        if (seen >= target)
+        {
+            unsigned long top = histogram_bucket_top(i);
+            return top < histogram->max ? top : histogram->max;
+        }
+    }
+    return histogram->max;
+}
+
+/**
+ * returns the largest value counted in bucket {index}.
+ */
+static unsigned long histogram_bucket_top(size_t index)
+{
+    if (index < HISTOGRAM_SUB_BUCKETS)
+    {
+        return index;
+    }
+    size_t shift = index/(HISTOGRAM_SUB_BUCKETS/2)-1;
+    unsigned long base = index-shift*HISTOGRAM_SUB_BUCKETS/2;
+    return ((base+1) << shift)-1;
+}
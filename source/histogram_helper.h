@@ -0,0 +1,64 @@
+#ifndef _HISTOGRAM_HELPER_H_
+#define _HISTOGRAM_HELPER_H_
+
+#include <stddef.h>
+
+/**
+ * values below this are counted exactly; above it, each power of two is split
+ *   into HISTOGRAM_SUB_BUCKETS/2 buckets, so a value is known to within about
+ *   3% of itself.
+ */
+#define HISTOGRAM_SUB_BUCKETS 64
+
+/**
+ * number of buckets needed to cover every 64 bit value.
+ */
+#define HISTOGRAM_LEN ((64-6+1)*HISTOGRAM_SUB_BUCKETS/2+HISTOGRAM_SUB_BUCKETS/2)
+
+/**
+ * log-linear histogram of non-negative integer samples, such as latencies in
+ *   microseconds. recording a sample is a couple of instructions and never
+ *   allocates, so it can be done on every request.
+ */
+struct histogram_t
+{
+    unsigned long counts[HISTOGRAM_LEN];
+    unsigned long count;
+    unsigned long max;
+};
+
+void histogram_reset(struct histogram_t* histogram);
+void histogram_merge(struct histogram_t* histogram, const struct histogram_t* other);
+void histogram_delta(struct histogram_t* delta, const struct histogram_t* after, const struct histogram_t* before);
+unsigned long histogram_percentile(const struct histogram_t* histogram, double percentile);
+
+/**
+ * returns the index of the bucket that {value} is counted in.
+ */
+inline size_t histogram_bucket(unsigned long value)
+{
+    if (value < HISTOGRAM_SUB_BUCKETS)
+    {
+        return value;
+    }
+    int shift = 63-__builtin_clzl(value)-5;
+    return (size_t) shift*HISTOGRAM_SUB_BUCKETS/2+(value >> shift);
+}
+
+/**
+ * counts {value} in {histogram}. a histogram has a single thread recording
+ *   into it, which stores with relaxed atomic stores, so other threads may
+ *   read it with histogram_merge while it runs; on x86, they are plain moves.
+ */
+inline void histogram_record(struct histogram_t* histogram, unsigned long value)
+{
+    unsigned long* bucket = histogram->counts+histogram_bucket(value);
+    __atomic_store_n(bucket,*bucket+1,__ATOMIC_RELAXED);
+    __atomic_store_n(&histogram->count,histogram->count+1,__ATOMIC_RELAXED);
+    if (histogram->max < value)
+    {
+        __atomic_store_n(&histogram->max,value,__ATOMIC_RELAXED);
+    }
+}
+
+#endif
@@ -7,10 +7,186 @@
 #include <string.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <sys/socket.h>
+#include <netinet/tcp.h>
 
 #define LISTENQ 2048
 
 static void fatal_error(const char* errstr);
+static void apply_socket_options(int socket);
+
+/**
+ * socket options applied to every socket made by this module.
+ */
+static struct sockopt_profile_t sockoptProfile;
+
+/**
+ * parses a socket options profile from {spec}, a comma separated list of
+ *   "nodelay", "quickack", "sndbuf=N", "rcvbuf=N", "notsent_lowat=N",
+ *   "busy_poll=N", "user_timeout=N", "defer_accept=N", "fastopen=N" and
+ *   "fastopen_connect".
+ *
+ * @function   parse_sockopt_profile
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       options that are not listed are left at 0, so that they keep
+ *   the system default.
+ *
+ * @signature  bool parse_sockopt_profile(const char* spec,
+ *   struct sockopt_profile_t* profile)
+ *
+ * @param      spec profile to parse, e.g. "nodelay,sndbuf=262144".
+ * @param      profile profile structure to fill in.
+ *
+ * @return     true on success; false if {spec} holds an unknown option, or an
+ *   invalid value.
+ */
+bool parse_sockopt_profile(const char* spec, struct sockopt_profile_t* profile)
+{
+    memset(profile,0,sizeof(struct sockopt_profile_t));
+
+    char* specCopy = strdup(spec);
+    if (specCopy == 0)
+    {
+        fatal_error("strdup");
+    }
+
+    bool isValid = true;
+    char* savePtr = 0;
+    for (char* option = strtok_r(specCopy,",",&savePtr); option != 0 && isValid; option = strtok_r(0,",",&savePtr))
+    {
+        // flags
+        if (strcmp(option,"nodelay") == 0)
+        {
+            profile->isNoDelay = true;
+            continue;
+        }
+        if (strcmp(option,"quickack") == 0)
+        {
+            profile->isQuickAck = true;
+            continue;
+        }
+        if (strcmp(option,"fastopen_connect") == 0)
+        {
+            profile->isFastOpenConnect = true;
+            continue;
+        }
+
+        // options with a value
+        char* value = strchr(option,'=');
+        if (value == 0)
+        {
+            isValid = false;
+            break;
+        }
+        *value++ = 0;
+        char* parsedCursor = value;
+        long number = strtol(value,&parsedCursor,10);
+        if (parsedCursor == value || *parsedCursor != 0 || number <= 0 || number > 0x7fffffff)
+        {
+            isValid = false;
+            break;
+        }
+
+        if (strcmp(option,"sndbuf") == 0)
+            profile->sendBufferLen = (int) number;
+        else if (strcmp(option,"rcvbuf") == 0)
+            profile->recvBufferLen = (int) number;
+        else if (strcmp(option,"notsent_lowat") == 0)
+            profile->notSentLowWatermark = (int) number;
+        else if (strcmp(option,"busy_poll") == 0)
+            profile->busyPollTime = (int) number;
+        else if (strcmp(option,"user_timeout") == 0)
+            profile->userTimeout = (int) number;
+        else if (strcmp(option,"defer_accept") == 0)
+            profile->deferAcceptTime = (int) number;
+        else if (strcmp(option,"fastopen") == 0)
+            profile->fastOpenQueueLen = (int) number;
+        else
+            isValid = false;
+    }
+
+    free(specCopy);
+    return isValid;
+}
+
+/**
+ * sets the socket options profile that is applied to every socket made by
+ *   this module from now on.
+ *
+ * @function   set_sockopt_profile
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  void set_sockopt_profile(
+ *   const struct sockopt_profile_t* profile)
+ *
+ * @param      profile profile to use.
+ */
+void set_sockopt_profile(const struct sockopt_profile_t* profile)
+{
+    sockoptProfile = *profile;
+}
+
+/**
+ * applies the socket options profile to a TCP socket. sockets made by this
+ *   module already have it; servers call this on the sockets they accept.
+ *
+ * @function   apply_sockopt_profile
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       linux copies most options from a listening socket to the sockets
+ *   it accepts, but not all of them (TCP_QUICKACK is connection state), so
+ *   they are set again. options left at their defaults cost nothing.
+ *
+ * @signature  void apply_sockopt_profile(int socket)
+ *
+ * @param      socket TCP socket to apply the profile to.
+ */
+void apply_sockopt_profile(int socket)
+{
+    apply_socket_options(socket);
+
+    int arg = 1;
+    if (sockoptProfile.isNoDelay && setsockopt(socket,IPPROTO_TCP,TCP_NODELAY,&arg,sizeof(arg)) == -1)
+    {
+        fatal_error("failed to set sock opt TCP_NODELAY");
+    }
+    if (sockoptProfile.isQuickAck && setsockopt(socket,IPPROTO_TCP,TCP_QUICKACK,&arg,sizeof(arg)) == -1)
+    {
+        fatal_error("failed to set sock opt TCP_QUICKACK");
+    }
+    if (sockoptProfile.notSentLowWatermark && setsockopt(socket,IPPROTO_TCP,TCP_NOTSENT_LOWAT,&sockoptProfile.notSentLowWatermark,sizeof(int)) == -1)
+    {
+        fatal_error("failed to set sock opt TCP_NOTSENT_LOWAT");
+    }
+    if (sockoptProfile.userTimeout && setsockopt(socket,IPPROTO_TCP,TCP_USER_TIMEOUT,&sockoptProfile.userTimeout,sizeof(int)) == -1)
+    {
+        fatal_error("failed to set sock opt TCP_USER_TIMEOUT");
+    }
+}
 
 /**
  * creates a new server socket, and returns the new server socket's file
@@ -70,6 +246,22 @@ struct socket_t make_tcp_server_socket(short port, bool isNonBlocking)
         }
     }
 
+    // apply the socket options profile before listening, so that buffer sizes
+    // are taken into account when accepted connections negotiate windows
+    apply_sockopt_profile(svrSock);
+
+    // only wake up the server once a connection has data to read
+    if (sockoptProfile.deferAcceptTime && setsockopt(svrSock,IPPROTO_TCP,TCP_DEFER_ACCEPT,&sockoptProfile.deferAcceptTime,sizeof(int)) == -1)
+    {
+        fatal_error("failed to set sock opt TCP_DEFER_ACCEPT");
+    }
+
+    // accept data carried by SYNs of clients that have a fast open cookie
+    if (sockoptProfile.fastOpenQueueLen && setsockopt(svrSock,IPPROTO_TCP,TCP_FASTOPEN,&sockoptProfile.fastOpenQueueLen,sizeof(int)) == -1)
+    {
+        fatal_error("failed to set sock opt TCP_FASTOPEN");
+    }
+
     // make the server listening socket non-blocking
     if (isNonBlocking)
     {
@@ -170,6 +362,20 @@ struct socket_t make_tcp_client_socket(char* remoteName, long remoteAddr, short
         }
     }
 
+    // apply the socket options profile before connecting
+    apply_sockopt_profile(clntSock);
+
+    // defer the SYN until the first send, so it can carry the first bytes;
+    // connect then returns at once without sending anything
+    if (sockoptProfile.isFastOpenConnect)
+    {
+        int arg = 1;
+        if (setsockopt(clntSock,IPPROTO_TCP,TCP_FASTOPEN_CONNECT,&arg,sizeof(arg)) == -1)
+        {
+            fatal_error("failed to set sock opt TCP_FASTOPEN_CONNECT");
+        }
+    }
+
     // bind socket to local host if a local port is specified
     if(clntSock > 0 && localPort)
     {
@@ -221,6 +427,183 @@ struct socket_t make_tcp_client_socket(char* remoteName, long remoteAddr, short
     return socket;
 }
 
+/**
+ * creates a new UDP socket bound to the specified local port, and returns it.
+ *
+ * @function   make_udp_server_socket
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       when {isReusePort} is set, each worker process can bind its own
+ *   socket to the same port, and the kernel spreads incoming datagrams across
+ *   all of them.
+ *
+ * @signature  struct socket_t make_udp_server_socket(short port,
+ *   bool isNonBlocking, bool isReusePort)
+ *
+ * @param      port port number on local host to bind the new socket to.
+ * @param      isNonBlocking true if the socket should be put into non blocking
+ *   mode; false otherwise.
+ * @param      isReusePort true if SO_REUSEPORT should be set on the socket
+ *   before it is bound; false otherwise.
+ *
+ * @return     socket file descriptor to the new UDP socket. may return -1 on
+ *   binding error.
+ */
+struct socket_t make_udp_server_socket(short port, bool isNonBlocking, bool isReusePort)
+{
+    // local address that the socket is bound to
+    struct sockaddr localAddr;
+    // socket file descriptor to the new UDP socket
+    int svrSock;
+
+    // create UDP socket
+    if((svrSock = socket(AF_INET, SOCK_DGRAM, 0)) == -1)
+    {
+        fatal_error("failed to create UDP socket");
+    }
+
+    // set sock opt to reuse address
+    int arg = 1;
+    if(setsockopt(svrSock,SOL_SOCKET,SO_REUSEADDR,&arg,sizeof(arg)) == -1)
+    {
+        fatal_error("failed to set sock opt to reuse address");
+    }
+
+    // set sock opt to reuse port so other workers may bind to it as well
+    if(isReusePort && setsockopt(svrSock,SOL_SOCKET,SO_REUSEPORT,&arg,sizeof(arg)) == -1)
+    {
+        fatal_error("failed to set sock opt to reuse port");
+    }
+
+    // apply the socket level options of the profile
+    apply_socket_options(svrSock);
+
+    // make the socket non-blocking
+    if (isNonBlocking)
+    {
+        int existingFlags = fcntl(svrSock,F_GETFL,0);
+        if (existingFlags == -1 || fcntl(svrSock,F_SETFL,O_NONBLOCK|existingFlags) == -1)
+        {
+            fatal_error("fcntl");
+        }
+    }
+
+    // bind socket to local host
+    localAddr = make_sockaddr(0, INADDR_ANY, port);
+    if(bind(svrSock, (struct sockaddr*) &localAddr, sizeof(localAddr)) == -1)
+    {
+        perror("failed to bind UDP socket to address structure");
+        close(svrSock);
+        svrSock = -1;
+    }
+
+    // return...
+    struct socket_t socket;
+    memset(&socket,0,sizeof(socket));
+    socket.fd = svrSock;
+    socket.localAddr = localAddr;
+    return socket;
+}
+
+/**
+ * creates a new UDP socket that is connected to the specified remote host, so
+ *   that it may be used with send and recv, and only receives datagrams from
+ *   that host.
+ *
+ * @function   make_udp_client_socket
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  struct socket_t make_udp_client_socket(char* remoteName,
+ *   long remoteAddr, short remotePort, short localPort, bool isNonBlocking)
+ *
+ * @param      remoteName name of the remote host. either this, or {remoteAddr}
+ *   needs to be specified; one of them can be 0, but not both.
+ * @param      remoteAddr address in host byte ordering of the remote host.
+ *   either this, or {remoteName} needs to be specified; one of them can be 0,
+ *   but not both.
+ * @param      remotePort the remote host's port.
+ * @param      localPort the local port. can be 0 if you don't care.
+ * @param      isNonBlocking true if the socket should be put into non blocking
+ *   mode; false otherwise.
+ *
+ * @return     socket file descriptor to the new connected UDP socket. may
+ *   return -1 on error.
+ */
+struct socket_t make_udp_client_socket(char* remoteName, long remoteAddr, short remotePort, short localPort, bool isNonBlocking)
+{
+    // local address that client socket is bound to
+    struct sockaddr local;
+    // remote address that client socket should connect to
+    struct sockaddr remote;
+    // socket file descriptor to the new client socket
+    int clntSock;
+
+    // create UDP socket
+    if((clntSock = socket(AF_INET, SOCK_DGRAM, 0)) == -1)
+    {
+        fatal_error("failed to create UDP socket");
+    }
+
+    // apply the socket level options of the profile
+    apply_socket_options(clntSock);
+
+    // bind socket to local host if a local port is specified
+    memset(&local,0,sizeof(local));
+    if(clntSock > 0 && localPort)
+    {
+        local = make_sockaddr(0, INADDR_ANY, localPort);
+        if(bind(clntSock, (struct sockaddr*) &local, sizeof(local)) == -1)
+        {
+            perror("failed to bind socket to local host");
+            close(clntSock);
+            clntSock = -1;
+        }
+    }
+
+    // make the socket non-blocking if specified
+    if (clntSock > 0 && isNonBlocking)
+    {
+        int existingFlags = fcntl(clntSock, F_GETFL,0);
+        if (existingFlags == -1 || fcntl(clntSock, F_SETFL, O_NONBLOCK | existingFlags) == -1)
+        {
+            fatal_error("failed to make socket non-blocking");
+        }
+    }
+
+    // connect socket to remote host; this only sets the default destination
+    remote = make_sockaddr(remoteName, remoteAddr, remotePort);
+    if (clntSock > 0 && connect(clntSock, (struct sockaddr*) &remote, sizeof(remote)) == -1)
+    {
+        perror("failed to connect to remote host");
+        close(clntSock);
+        clntSock = -1;
+    }
+
+    // return...
+    struct socket_t socket;
+    memset(&socket,0,sizeof(socket_t));
+    socket.fd = clntSock;
+    socket.localAddr = local;
+    socket.remoteAddr = remote;
+    return socket;
+}
+
 /**
  * makes a address structure. the hostPort must be provided. if {hostName} is
  *   specified, the function will perform a query to find the remote IP. if
@@ -339,6 +722,124 @@ int read_file(int socket, void* bufferPointer, int bytesToRead)
     return result;
 }
 
+/**
+ * sends the file descriptor {fd} to the process at the other end of the unix
+ *   domain socket {socket}, using an SCM_RIGHTS control message, along with
+ *   {dataLen} bytes of {data} in the same message.
+ *
+ * @function   send_fd
+ *
+ * @date       2026-10-16
+ *
+ * @revision   2026-10-16 Eric Tsang - sends data along with the descriptor.
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       {dataLen} must be at least 1, because a control message cannot
+ *   be sent on its own.
+ *
+ * @signature  bool send_fd(int socket, int fd, const void* data,
+ *   size_t dataLen)
+ *
+ * @param      socket unix domain socket to send the descriptor over.
+ * @param      fd file descriptor to send.
+ * @param      data data to send along with the descriptor.
+ * @param      dataLen number of bytes of {data} to send.
+ *
+ * @return     true on success; false otherwise.
+ */
+bool send_fd(int socket, int fd, const void* data, size_t dataLen)
+{
+    struct iovec iov;
+    iov.iov_base = (void*) data;
+    iov.iov_len = dataLen;
+
+    union
+    {
+        char buf[CMSG_SPACE(sizeof(int))];
+        struct cmsghdr align;
+    } control;
+    memset(&control,0,sizeof(control));
+
+    struct msghdr msg;
+    memset(&msg,0,sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = sizeof(control.buf);
+
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(cmsg),&fd,sizeof(int));
+
+    return sendmsg(socket,&msg,MSG_NOSIGNAL) == (ssize_t) dataLen;
+}
+
+/**
+ * receives a file descriptor sent by send_fd over the unix domain socket
+ *   {socket}, and the {dataLen} bytes of data sent along with it.
+ *
+ * @function   recv_fd
+ *
+ * @date       2026-10-16
+ *
+ * @revision   2026-10-16 Eric Tsang - receives the data sent along with the
+ *   descriptor.
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the received descriptor is marked close-on-exec.
+ *
+ * @signature  int recv_fd(int socket, void* data, size_t dataLen)
+ *
+ * @param      socket unix domain socket to receive the descriptor from.
+ * @param      data buffer to receive the data sent along with the descriptor.
+ * @param      dataLen number of bytes of data to receive.
+ *
+ * @return     the received file descriptor; -1 if the socket was closed, or
+ *   would block, or no descriptor came with the message.
+ */
+int recv_fd(int socket, void* data, size_t dataLen)
+{
+    struct iovec iov;
+    iov.iov_base = data;
+    iov.iov_len = dataLen;
+
+    union
+    {
+        char buf[CMSG_SPACE(sizeof(int))];
+        struct cmsghdr align;
+    } control;
+
+    struct msghdr msg;
+    memset(&msg,0,sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = sizeof(control.buf);
+
+    if (recvmsg(socket,&msg,MSG_CMSG_CLOEXEC) != (ssize_t) dataLen)
+    {
+        return -1;
+    }
+
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    if (cmsg == 0 || cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS)
+    {
+        return -1;
+    }
+
+    int fd;
+    memcpy(&fd,CMSG_DATA(cmsg),sizeof(int));
+    return fd;
+}
+
 /**
  * prints the error message, then exits the program.
  *
@@ -363,3 +864,39 @@ static void fatal_error(const char* errstr)
     perror(errstr);
     exit(errno);
 }
+
+/**
+ * applies the socket level options of the socket options profile, which apply
+ *   to UDP sockets as well as TCP sockets.
+ *
+ * @function   apply_socket_options
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  static void apply_socket_options(int socket)
+ *
+ * @param      socket socket to apply the options to.
+ */
+static void apply_socket_options(int socket)
+{
+    if (sockoptProfile.sendBufferLen && setsockopt(socket,SOL_SOCKET,SO_SNDBUF,&sockoptProfile.sendBufferLen,sizeof(int)) == -1)
+    {
+        fatal_error("failed to set sock opt SO_SNDBUF");
+    }
+    if (sockoptProfile.recvBufferLen && setsockopt(socket,SOL_SOCKET,SO_RCVBUF,&sockoptProfile.recvBufferLen,sizeof(int)) == -1)
+    {
+        fatal_error("failed to set sock opt SO_RCVBUF");
+    }
+    if (sockoptProfile.busyPollTime && setsockopt(socket,SOL_SOCKET,SO_BUSY_POLL,&sockoptProfile.busyPollTime,sizeof(int)) == -1)
+    {
+        fatal_error("failed to set sock opt SO_BUSY_POLL");
+    }
+}
@@ -10,9 +10,34 @@ struct socket_t
     struct sockaddr remoteAddr;
 };
 
+/**
+ * socket options applied to every socket made by this module, and to sockets
+ *   accepted with them. options left at 0 (or false) keep the system default.
+ */
+struct sockopt_profile_t
+{
+    bool isNoDelay;             // TCP_NODELAY; disables Nagle's algorithm
+    bool isQuickAck;            // TCP_QUICKACK; acknowledges without delay
+    int sendBufferLen;          // SO_SNDBUF in bytes
+    int recvBufferLen;          // SO_RCVBUF in bytes
+    int notSentLowWatermark;    // TCP_NOTSENT_LOWAT in bytes
+    int busyPollTime;           // SO_BUSY_POLL in microseconds
+    int userTimeout;            // TCP_USER_TIMEOUT in milliseconds
+    int deferAcceptTime;        // TCP_DEFER_ACCEPT in seconds; listening sockets only
+    int fastOpenQueueLen;       // TCP_FASTOPEN queue length; listening sockets only
+    bool isFastOpenConnect;     // TCP_FASTOPEN_CONNECT; client sockets only
+};
+
+bool parse_sockopt_profile(const char* spec, struct sockopt_profile_t* profile);
+void set_sockopt_profile(const struct sockopt_profile_t* profile);
+void apply_sockopt_profile(int socket);
 struct socket_t make_tcp_server_socket(short port, bool isNonBlocking);
 struct socket_t make_tcp_client_socket(char* remoteName, long remoteAddr, short remotePort, short localPort, bool isNonBlocking);
+struct socket_t make_udp_server_socket(short port, bool isNonBlocking, bool isReusePort);
+struct socket_t make_udp_client_socket(char* remoteName, long remoteAddr, short remotePort, short localPort, bool isNonBlocking);
 struct sockaddr make_sockaddr(char* hostName, long hostAddr, short hostPort);
 int read_file(int socket, void* bufferPointer, int bytesToRead);
+bool send_fd(int socket, int fd, const void* data, size_t dataLen);
+int recv_fd(int socket, void* data, size_t dataLen);
 
 #endif
@@ -0,0 +1,475 @@
+#include "payload_helper.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+static void size_dist_alloc(struct size_dist_t* dist, size_t count);
+static void payload_alloc(struct payload_t* payload, size_t patternLen, size_t sliceLen);
+static void payload_extend(struct payload_t* payload);
+static uint64_t mix64(uint64_t x);
+
+/**
+ * uses the literal string {data} as the pattern. every connection's stream
+ *   starts at the beginning of the string, so each request of strlen(data)
+ *   bytes is exactly {data}.
+ *
+ * @function   payload_init_literal
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  void payload_init_literal(struct payload_t* payload,
+ *   const char* data, size_t sliceLen)
+ *
+ * @param      payload payload structure to initialize.
+ * @param      data non-empty string to use as the pattern.
+ * @param      sliceLen longest slice that will ever be requested from
+ *   payload_at.
+ */
+void payload_init_literal(struct payload_t* payload, const char* data, size_t sliceLen)
+{
+    payload_alloc(payload,strlen(data),sliceLen);
+    memcpy(payload->pattern,data,payload->patternLen);
+    payload_extend(payload);
+    payload->isLiteral = true;
+}
+
+/**
+ * fills the pattern with PAYLOAD_PATTERN_LEN pseudo-random bytes derived from
+ *   {seed}. each connection's stream starts at its own offset into it.
+ *
+ * @function   payload_init_seeded
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the same seed always produces the same streams, so a failing run
+ *   can be reproduced exactly.
+ *
+ * @signature  void payload_init_seeded(struct payload_t* payload,
+ *   unsigned long seed, size_t sliceLen)
+ *
+ * @param      payload payload structure to initialize.
+ * @param      seed seed of the pseudo-random pattern.
+ * @param      sliceLen longest slice that will ever be requested from
+ *   payload_at.
+ */
+void payload_init_seeded(struct payload_t* payload, unsigned long seed, size_t sliceLen)
+{
+    payload_alloc(payload,PAYLOAD_PATTERN_LEN,sliceLen);
+    payload->seed = seed;
+
+    uint64_t state = seed;
+    for (size_t i = 0; i < payload->patternLen; i += sizeof(uint64_t))
+    {
+        uint64_t word = mix64(state++);
+        size_t len = payload->patternLen-i < sizeof(word) ? payload->patternLen-i : sizeof(word);
+        memcpy(payload->pattern+i,&word,len);
+    }
+    payload_extend(payload);
+}
+
+/**
+ * loads the pattern from the file at {path}. each connection's stream starts
+ *   at its own offset into the file's contents, chosen using {seed}.
+ *
+ * @function   payload_init_file
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  bool payload_init_file(struct payload_t* payload,
+ *   const char* path, unsigned long seed, size_t sliceLen)
+ *
+ * @param      payload payload structure to initialize.
+ * @param      path path to a non-empty file.
+ * @param      seed seed used to choose each connection's starting offset.
+ * @param      sliceLen longest slice that will ever be requested from
+ *   payload_at.
+ *
+ * @return     true on success; false if the file could not be read, or is
+ *   empty.
+ */
+bool payload_init_file(struct payload_t* payload, const char* path, unsigned long seed, size_t sliceLen)
+{
+    FILE* file = fopen(path,"rb");
+    if (file == 0)
+    {
+        return false;
+    }
+
+    // find the size of the file
+    long fileLen = -1;
+    if (fseek(file,0,SEEK_END) == 0)
+    {
+        fileLen = ftell(file);
+        rewind(file);
+    }
+    if (fileLen <= 0)
+    {
+        fclose(file);
+        return false;
+    }
+
+    // read the file into the pattern
+    payload_alloc(payload,fileLen,sliceLen);
+    payload->seed = seed;
+    bool isRead = fread(payload->pattern,1,fileLen,file) == (size_t) fileLen;
+    fclose(file);
+    if (!isRead)
+    {
+        free(payload->pattern);
+        return false;
+    }
+    payload_extend(payload);
+    return true;
+}
+
+/**
+ * returns the pattern offset that the stream of connection {connectionId}
+ *   starts at.
+ *
+ * @function   payload_stream_base
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       literal payloads always start at offset 0.
+ *
+ * @signature  size_t payload_stream_base(const struct payload_t* payload,
+ *   unsigned long connectionId)
+ *
+ * @param      payload initialized payload structure.
+ * @param      connectionId identifier of the connection; unique within a run.
+ *
+ * @return     offset into the pattern where the connection's stream starts.
+ */
+size_t payload_stream_base(const struct payload_t* payload, unsigned long connectionId)
+{
+    if (payload->isLiteral)
+    {
+        return 0;
+    }
+    return mix64(payload->seed^mix64(connectionId))%payload->patternLen;
+}
+
+/**
+ * compares {len} bytes of {actual} against {expected}, 16 bytes at a time when
+ *   SSE2 is available.
+ *
+ * @function   payload_compare
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  size_t payload_compare(const char* expected, const char* actual,
+ *   size_t len)
+ *
+ * @param      expected bytes that should have been received.
+ * @param      actual bytes that were received.
+ * @param      len number of bytes to compare.
+ *
+ * @return     offset of the first mismatching byte, or {len} if all bytes
+ *   match.
+ */
+size_t payload_compare(const char* expected, const char* actual, size_t len)
+{
+    size_t i = 0;
+#ifdef __SSE2__
+    for (; i+sizeof(__m128i) <= len; i += sizeof(__m128i))
+    {
+        __m128i a = _mm_loadu_si128((const __m128i*) (expected+i));
+        __m128i b = _mm_loadu_si128((const __m128i*) (actual+i));
+        unsigned int equalMask = _mm_movemask_epi8(_mm_cmpeq_epi8(a,b));
+        if (equalMask != 0xffff)
+        {
+            return i+__builtin_ctz(~equalMask);
+        }
+    }
+#endif
+    for (; i < len; ++i)
+    {
+        if (expected[i] != actual[i])
+        {
+            return i;
+        }
+    }
+    return len;
+}
+
+/**
+ * initializes a size distribution from a command line specification: either a
+ *   fixed size "N", or a uniform range "A:B" of sizes from A to B inclusive.
+ *
+ * @function   size_dist_init_spec
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  bool size_dist_init_spec(struct size_dist_t* dist,
+ *   const char* spec, unsigned long seed)
+ *
+ * @param      dist size distribution to initialize.
+ * @param      spec "N" or "A:B"; sizes must be at least 1.
+ * @param      seed seed used to sample uniform sizes.
+ *
+ * @return     true on success; false if {spec} is malformed.
+ */
+bool size_dist_init_spec(struct size_dist_t* dist, const char* spec, unsigned long seed)
+{
+    char* parsedCursor;
+    unsigned long lower = strtoul(spec,&parsedCursor,10);
+    unsigned long upper = lower;
+    if (parsedCursor == spec)
+    {
+        return false;
+    }
+    if (*parsedCursor == ':')
+    {
+        const char* upperSpec = parsedCursor+1;
+        upper = strtoul(upperSpec,&parsedCursor,10);
+        if (parsedCursor == upperSpec)
+        {
+            return false;
+        }
+    }
+    if (*parsedCursor != 0 || lower == 0 || upper < lower || upper > UINT32_MAX)
+    {
+        return false;
+    }
+
+    // a fixed size needs only one entry
+    if (lower == upper)
+    {
+        size_dist_alloc(dist,1);
+        dist->sizes[0] = dist->maxSize = lower;
+        return true;
+    }
+
+    // sample the uniform range
+    size_dist_alloc(dist,SIZE_DIST_TABLE_LEN);
+    uint64_t state = seed;
+    for (size_t i = 0; i < dist->count; ++i)
+    {
+        dist->sizes[i] = lower+mix64(state++)%(upper-lower+1);
+        if (dist->maxSize < dist->sizes[i])
+        {
+            dist->maxSize = dist->sizes[i];
+        }
+    }
+    return true;
+}
+
+/**
+ * initializes an empirical size distribution from the file at {path}. each
+ *   line holds a size, optionally followed by its weight (1 by default). blank
+ *   lines and lines starting with '#' are ignored.
+ *
+ * @function   size_dist_init_file
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  bool size_dist_init_file(struct size_dist_t* dist,
+ *   const char* path, unsigned long seed)
+ *
+ * @param      dist size distribution to initialize.
+ * @param      path path to the file of sizes.
+ * @param      seed seed used to sample sizes by weight.
+ *
+ * @return     true on success; false if the file could not be read, is
+ *   malformed or holds no sizes.
+ */
+bool size_dist_init_file(struct size_dist_t* dist, const char* path, unsigned long seed)
+{
+    FILE* file = fopen(path,"r");
+    if (file == 0)
+    {
+        return false;
+    }
+
+    // read the sizes and their cumulative weights
+    size_t entryCount = 0;
+    size_t entryCapacity = 0;
+    unsigned int* sizes = 0;
+    double* cumulativeWeights = 0;
+    double totalWeight = 0;
+    bool isValid = true;
+    char line[256];
+    while (isValid && fgets(line,sizeof(line),file) != 0)
+    {
+        char* cursor = line;
+        while (*cursor == ' ' || *cursor == '\t') ++cursor;
+        if (*cursor == '#' || *cursor == '\n' || *cursor == 0)
+        {
+            continue;
+        }
+
+        char* parsedCursor;
+        unsigned long size = strtoul(cursor,&parsedCursor,10);
+        double weight = 1;
+        if (parsedCursor == cursor || size == 0 || size > UINT32_MAX)
+        {
+            isValid = false;
+            break;
+        }
+        cursor = parsedCursor;
+        weight = strtod(cursor,&parsedCursor);
+        if (parsedCursor == cursor)
+        {
+            weight = 1;
+        }
+        if (weight <= 0)
+        {
+            continue;
+        }
+
+        if (entryCount == entryCapacity)
+        {
+            entryCapacity = entryCapacity ? entryCapacity*2 : 64;
+            sizes = (unsigned int*) realloc(sizes,entryCapacity*sizeof(*sizes));
+            cumulativeWeights = (double*) realloc(cumulativeWeights,entryCapacity*sizeof(*cumulativeWeights));
+            if (sizes == 0 || cumulativeWeights == 0)
+            {
+                perror("realloc");
+                exit(EXIT_FAILURE);
+            }
+        }
+        totalWeight += weight;
+        sizes[entryCount] = size;
+        cumulativeWeights[entryCount] = totalWeight;
+        ++entryCount;
+    }
+    fclose(file);
+
+    // sample the table by weight
+    if (isValid && entryCount > 0)
+    {
+        size_dist_alloc(dist,SIZE_DIST_TABLE_LEN);
+        uint64_t state = seed;
+        for (size_t i = 0; i < dist->count; ++i)
+        {
+            double target = (mix64(state++) >> 11)*(1.0/9007199254740992.0)*totalWeight;
+            size_t lo = 0;
+            size_t hi = entryCount-1;
+            while (lo < hi)
+            {
+                size_t mid = (lo+hi)/2;
+                if (cumulativeWeights[mid] <= target) lo = mid+1;
+                else hi = mid;
+            }
+            dist->sizes[i] = sizes[lo];
+            if (dist->maxSize < sizes[lo])
+            {
+                dist->maxSize = sizes[lo];
+            }
+        }
+    }
+    free(sizes);
+    free(cumulativeWeights);
+    return isValid && entryCount > 0;
+}
+
+/**
+ * allocates a table of {count} sizes for {dist}.
+ */
+static void size_dist_alloc(struct size_dist_t* dist, size_t count)
+{
+    dist->count = count;
+    dist->maxSize = 0;
+    dist->sizes = (unsigned int*) malloc(count*sizeof(*dist->sizes));
+    if (dist->sizes == 0)
+    {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * allocates the pattern buffer of {payload}, leaving room for the copy of its
+ *   head that makes slices contiguous.
+ */
+static void payload_alloc(struct payload_t* payload, size_t patternLen, size_t sliceLen)
+{
+    memset(payload,0,sizeof(*payload));
+    payload->patternLen = patternLen;
+    payload->sliceLen = sliceLen;
+    payload->pattern = (char*) malloc(patternLen+sliceLen);
+    if (payload->pattern == 0)
+    {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * repeats the pattern after itself until sliceLen extra bytes are filled.
+ */
+static void payload_extend(struct payload_t* payload)
+{
+    for (size_t i = 0; i < payload->sliceLen; ++i)
+    {
+        payload->pattern[payload->patternLen+i] = payload->pattern[i%payload->patternLen];
+    }
+}
+
+/**
+ * splitmix64 finalizer; spreads the bits of {x} over the whole word.
+ */
+static uint64_t mix64(uint64_t x)
+{
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x^(x >> 30))*0xbf58476d1ce4e5b9ULL;
+    x = (x^(x >> 27))*0x94d049bb133111ebULL;
+    return x^(x >> 31);
+}
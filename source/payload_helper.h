@@ -0,0 +1,68 @@
+#ifndef _PAYLOAD_HELPER_H_
+#define _PAYLOAD_HELPER_H_
+
+#include <stddef.h>
+
+/**
+ * length of the pattern generated by payload_init_seeded. prime, so that slices
+ *   of a connection's stream do not line up with typical message sizes.
+ */
+#define PAYLOAD_PATTERN_LEN 65521
+
+/**
+ * content of the byte stream sent by every connection. byte i of a connection's
+ *   stream is pattern[(base+i) % patternLen]; the pattern is followed by a copy
+ *   of its own first sliceLen bytes, so that any slice of up to sliceLen bytes
+ *   is contiguous in memory.
+ */
+struct payload_t
+{
+    char* pattern;
+    size_t patternLen;
+    size_t sliceLen;
+    bool isLiteral;
+    unsigned long seed;
+};
+
+/**
+ * number of sizes pre-sampled from a uniform or empirical size distribution.
+ */
+#define SIZE_DIST_TABLE_LEN 65536
+
+/**
+ * sizes of echo requests. sizes are sampled up front into a table, and
+ *   requests just walk the table, so picking a size costs nothing at run time.
+ */
+struct size_dist_t
+{
+    unsigned int* sizes;
+    size_t count;
+    unsigned int maxSize;
+};
+
+void payload_init_literal(struct payload_t* payload, const char* data, size_t sliceLen);
+void payload_init_seeded(struct payload_t* payload, unsigned long seed, size_t sliceLen);
+bool payload_init_file(struct payload_t* payload, const char* path, unsigned long seed, size_t sliceLen);
+size_t payload_stream_base(const struct payload_t* payload, unsigned long connectionId);
+size_t payload_compare(const char* expected, const char* actual, size_t len);
+bool size_dist_init_spec(struct size_dist_t* dist, const char* spec, unsigned long seed);
+bool size_dist_init_file(struct size_dist_t* dist, const char* path, unsigned long seed);
+
+/**
+ * returns the size of the {index}th request.
+ */
+inline unsigned int size_dist_at(const struct size_dist_t* dist, unsigned long index)
+{
+    return dist->sizes[index%dist->count];
+}
+
+/**
+ * returns a pointer to at least sliceLen contiguous bytes of the stream that
+ *   starts at pattern offset {base}, beginning at stream offset {offset}.
+ */
+inline const char* payload_at(const struct payload_t* payload, size_t base, unsigned long long offset)
+{
+    return payload->pattern+(base+offset)%payload->patternLen;
+}
+
+#endif
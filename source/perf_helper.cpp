@@ -0,0 +1,342 @@
+#include "perf_helper.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+/**
+ * type and config of each counter, in the order of perf_counter_t.
+ */
+static const struct { unsigned int type; unsigned long long config; } events[PERF_COUNTER_COUNT] =
+{
+    {PERF_TYPE_HARDWARE,PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE,PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HARDWARE,PERF_COUNT_HW_CACHE_MISSES},
+    {PERF_TYPE_SOFTWARE,PERF_COUNT_SW_CONTEXT_SWITCHES},
+    {PERF_TYPE_SOFTWARE,PERF_COUNT_SW_CPU_MIGRATIONS},
+};
+
+/**
+ * names of the counters, as printed by perf_print.
+ */
+static const char* counterNames[PERF_COUNTER_COUNT] =
+{
+    "cycles",
+    "instructions",
+    "cacheMisses",
+    "contextSwitches",
+    "cpuMigrations",
+};
+
+static int open_event(int counter, int groupFd, bool inherit, bool isUserOnly);
+
+/**
+ * opens a group of counters that count events of the calling thread from now
+ *   on.
+ *
+ * @function   perf_open
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       never fails: events that cannot be counted, because the CPU
+ *   has no PMU (as in many virtual machines), perf_event_paranoid forbids it,
+ *   or perf_event_open is not permitted at all, are left out of the group and
+ *   reported as n/a. if kernel time may not be counted, only user time is.
+ *   with {inherit}, threads created afterwards are counted as well, but only
+ *   once they have exited.
+ *
+ * @signature  void perf_open(struct perf_group_t* group, bool inherit)
+ *
+ * @param      group group to open.
+ * @param      inherit true to also count threads the caller creates later.
+ */
+void perf_open(struct perf_group_t* group, bool inherit)
+{
+    group->isUserOnly = false;
+    while (true)
+    {
+        int leaderFd = -1;
+        bool isDenied = false;
+        for (register int i = 0; i < PERF_COUNTER_COUNT; ++i)
+        {
+            group->fds[i] = open_event(i,leaderFd,inherit,group->isUserOnly);
+            if (group->fds[i] == -1 && (errno == EACCES || errno == EPERM))
+            {
+                isDenied = true;
+            }
+            if (leaderFd == -1)
+            {
+                leaderFd = group->fds[i];
+            }
+        }
+        errno = 0;
+
+        // count user time only if counting kernel time is not permitted
+        if (isDenied && !group->isUserOnly)
+        {
+            perf_close(group);
+            group->isUserOnly = true;
+            continue;
+        }
+
+        if (leaderFd != -1)
+        {
+            ioctl(leaderFd,PERF_EVENT_IOC_RESET,PERF_IOC_FLAG_GROUP);
+            ioctl(leaderFd,PERF_EVENT_IOC_ENABLE,PERF_IOC_FLAG_GROUP);
+        }
+        break;
+    }
+}
+
+/**
+ * reads the counters of {group}.
+ *
+ * @function   perf_read
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       can be called from any thread. values are scaled up if the
+ *   group only got part of the time on the PMU because it was shared.
+ *
+ * @signature  void perf_read(const struct perf_group_t* group,
+ *   struct perf_counts_t* counts)
+ *
+ * @param      group group to read.
+ * @param      counts set to the values read.
+ */
+void perf_read(const struct perf_group_t* group, struct perf_counts_t* counts)
+{
+    memset(counts,0,sizeof(struct perf_counts_t));
+    counts->isUserOnly = group->isUserOnly;
+    for (register int i = 0; i < PERF_COUNTER_COUNT; ++i)
+    {
+        unsigned long long value[3];    // value, time enabled, time running
+        if (group->fds[i] == -1 || read(group->fds[i],value,sizeof(value)) != sizeof(value) || value[2] == 0)
+        {
+            continue;
+        }
+        counts->values[i] = value[2] < value[1] ? (unsigned long long) ((double) value[0]*value[1]/value[2]) : value[0];
+        counts->isCounted[i] = true;
+    }
+    errno = 0;
+}
+
+/**
+ * closes the counters of {group}.
+ *
+ * @function   perf_close
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  void perf_close(struct perf_group_t* group)
+ *
+ * @param      group group to close.
+ */
+void perf_close(struct perf_group_t* group)
+{
+    for (register int i = PERF_COUNTER_COUNT-1; i >= 0; --i)
+    {
+        if (group->fds[i] != -1)
+        {
+            close(group->fds[i]);
+            group->fds[i] = -1;
+        }
+    }
+}
+
+/**
+ * adds the counts {other} to {totals}.
+ *
+ * @function   perf_merge
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       a counter is known in {totals} if any of the merged counts
+ *   knew it.
+ *
+ * @signature  void perf_merge(struct perf_counts_t* totals,
+ *   const struct perf_counts_t* other)
+ *
+ * @param      totals counts to add to.
+ * @param      other counts to add.
+ */
+void perf_merge(struct perf_counts_t* totals, const struct perf_counts_t* other)
+{
+    for (register int i = 0; i < PERF_COUNTER_COUNT; ++i)
+    {
+        totals->values[i] += other->values[i];
+        totals->isCounted[i] = totals->isCounted[i] || other->isCounted[i];
+    }
+    totals->isUserOnly = totals->isUserOnly || other->isUserOnly;
+}
+
+/**
+ * prints {counts}, each also divided by the number of echoes and connections
+ *   they were counted over.
+ *
+ * @function   perf_print
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       printed in the layout of the client's statistics, one counter
+ *   per line. ratios are left out where their denominator is 0.
+ *
+ * @signature  void perf_print(FILE* file, const struct perf_counts_t* counts,
+ *   unsigned long numEchoes, unsigned long numConnections)
+ *
+ * @param      file file to print to.
+ * @param      counts counts to print.
+ * @param      numEchoes number of echo requests or datagrams served.
+ * @param      numConnections number of connections served.
+ */
+void perf_print(FILE* file, const struct perf_counts_t* counts, unsigned long numEchoes, unsigned long numConnections)
+{
+    for (register int i = 0; i < PERF_COUNTER_COUNT; ++i)
+    {
+        if (!counts->isCounted[i])
+        {
+            fprintf(file,"%18s: n/a\n",counterNames[i]);
+            continue;
+        }
+        fprintf(file,"%18s: %llu",counterNames[i],counts->values[i]);
+        if (numEchoes > 0)
+        {
+            fprintf(file," (%.2lf per echo",(double) counts->values[i]/numEchoes);
+            if (numConnections > 0)
+            {
+                fprintf(file,", %.2lf per connection",(double) counts->values[i]/numConnections);
+            }
+            fprintf(file,")");
+        }
+        fprintf(file,"\n");
+    }
+    if (counts->isUserOnly)
+    {
+        fprintf(file,"%18s: user space only\n","perfScope");
+    }
+}
+
+/**
+ * reads the counters of {group}, and prints them in one block under a line
+ *   naming the worker, and what it served.
+ *
+ * @function   perf_report
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       used by the servers, which have no statistics report of their
+ *   own. the block is written with one call, so reports of workers sharing
+ *   stderr do not interleave.
+ *
+ * @signature  void perf_report(FILE* file, const char* label,
+ *   const struct perf_group_t* group, unsigned long numEchoes,
+ *   unsigned long numConnections)
+ *
+ * @param      file file to print to.
+ * @param      label label of the worker, e.g. "worker 0".
+ * @param      group group to read.
+ * @param      numEchoes number of echoes served since {group} was opened.
+ * @param      numConnections number of connections served since {group} was
+ *   opened.
+ */
+void perf_report(FILE* file, const char* label, const struct perf_group_t* group, unsigned long numEchoes, unsigned long numConnections)
+{
+    struct perf_counts_t counts;
+    perf_read(group,&counts);
+
+    char* report;
+    size_t reportLen;
+    FILE* stream = open_memstream(&report,&reportLen);
+    if (stream == 0)
+    {
+        return;
+    }
+    fprintf(stream,"[%d] %s: %lu echoes, %lu connections\n",getpid(),label,numEchoes,numConnections);
+    perf_print(stream,&counts,numEchoes,numConnections);
+    fclose(stream);
+    fwrite(report,1,reportLen,file);
+    fflush(file);
+    free(report);
+}
+
+/**
+ * opens the perf event {counter} for the calling thread.
+ *
+ * @function   open_event
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the group leader is opened disabled, and the rest follow it.
+ *
+ * @signature  static int open_event(int counter, int groupFd, bool inherit,
+ *   bool isUserOnly)
+ *
+ * @param      counter counter to open; one of perf_counter_t.
+ * @param      groupFd file descriptor of the group leader; -1 to open a leader.
+ * @param      inherit true to also count threads the caller creates later.
+ * @param      isUserOnly true to leave kernel time out.
+ *
+ * @return     file descriptor of the event; -1 on failure, with errno set.
+ */
+static int open_event(int counter, int groupFd, bool inherit, bool isUserOnly)
+{
+    struct perf_event_attr attr;
+    memset(&attr,0,sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = events[counter].type;
+    attr.config = events[counter].config;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED|PERF_FORMAT_TOTAL_TIME_RUNNING;
+    attr.disabled = groupFd == -1;
+    attr.inherit = inherit;
+    attr.exclude_kernel = isUserOnly;
+    attr.exclude_hv = 1;
+    return (int) syscall(SYS_perf_event_open,&attr,0,-1,groupFd,PERF_FLAG_FD_CLOEXEC);
+}
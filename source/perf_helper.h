@@ -0,0 +1,46 @@
+#ifndef _PERF_HELPER_H_
+#define _PERF_HELPER_H_
+
+#include <stdio.h>
+
+/**
+ * hardware and software events counted with perf_event_open.
+ */
+enum perf_counter_t
+{
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_CACHE_MISSES,
+    PERF_CONTEXT_SWITCHES,
+    PERF_CPU_MIGRATIONS,
+    PERF_COUNTER_COUNT
+};
+
+/**
+ * counters of one worker, opened as a single perf event group so they are
+ *   scheduled onto the PMU together.
+ */
+struct perf_group_t
+{
+    int fds[PERF_COUNTER_COUNT];    // -1 where the event cannot be counted
+    bool isUserOnly;                // true if kernel time is not counted
+};
+
+/**
+ * values read from one or more perf groups.
+ */
+struct perf_counts_t
+{
+    unsigned long long values[PERF_COUNTER_COUNT];
+    bool isCounted[PERF_COUNTER_COUNT];     // false where values[] is unknown
+    bool isUserOnly;                        // true if kernel time is not counted
+};
+
+void perf_open(struct perf_group_t* group, bool inherit);
+void perf_read(const struct perf_group_t* group, struct perf_counts_t* counts);
+void perf_close(struct perf_group_t* group);
+void perf_merge(struct perf_counts_t* totals, const struct perf_counts_t* other);
+void perf_print(FILE* file, const struct perf_counts_t* counts, unsigned long numEchoes, unsigned long numConnections);
+void perf_report(FILE* file, const char* label, const struct perf_group_t* group, unsigned long numEchoes, unsigned long numConnections);
+
+#endif
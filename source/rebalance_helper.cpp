@@ -0,0 +1,467 @@
+#include "rebalance_helper.h"
+
+#include <time.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sysexits.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+#include "net_helper.h"
+
+static void fatal_error(const char* errstr);
+static long current_time();
+
+/**
+ * sets up the load table and the socket pairs of {numWorkers} workers. to be
+ *   called before the workers are forked, so that they all share them.
+ *
+ * @function   rebalance_init
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the socket pairs are SOCK_SEQPACKET, so every connection sent
+ *   arrives as one message along with its state, and non-blocking, so a worker
+ *   never waits on a sibling that is slow to take connections.
+ *
+ * @signature  void rebalance_init(struct rebalancer_t* rebalancer,
+ *   int numWorkers)
+ *
+ * @param      rebalancer rebalancer to initialize.
+ * @param      numWorkers number of worker processes.
+ */
+void rebalance_init(struct rebalancer_t* rebalancer, int numWorkers)
+{
+    rebalancer->loads = (struct worker_load_t*) mmap(0,numWorkers*sizeof(struct worker_load_t),
+        PROT_READ|PROT_WRITE,MAP_SHARED|MAP_ANONYMOUS,-1,0);
+    if (rebalancer->loads == MAP_FAILED)
+    {
+        fatal_error("mmap");
+    }
+    for (register int i = 0; i < numWorkers; ++i)
+    {
+        rebalancer->loads[i].numConnections = 0;
+        rebalancer->loads[i].isAccepting = false;
+    }
+
+    rebalancer->inboxes = (int (*)[2]) malloc(numWorkers*sizeof(int[2]));
+    for (register int i = 0; i < numWorkers; ++i)
+    {
+        if (socketpair(AF_UNIX,SOCK_SEQPACKET|SOCK_NONBLOCK|SOCK_CLOEXEC,0,rebalancer->inboxes[i]) == -1)
+        {
+            fatal_error("socketpair");
+        }
+    }
+
+    rebalancer->numWorkers = numWorkers;
+    rebalancer->workerIndex = -1;
+    rebalancer->states = 0;
+    rebalancer->tableLen = 0;
+    rebalancer->maxFd = -1;
+    rebalancer->nextRebalanceTime = 0;
+    rebalancer->migratedCount = 0;
+    rebalancer->adoptedCount = 0;
+}
+
+/**
+ * makes the calling worker process worker {workerIndex} of the rebalancer,
+ *   and starts publishing its load.
+ *
+ * @function   rebalance_attach
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       a respawned worker takes over the slot of the one it replaces,
+ *   along with any connections still waiting in its socket pair.
+ *
+ * @signature  int rebalance_attach(struct rebalancer_t* rebalancer,
+ *   int workerIndex)
+ *
+ * @param      rebalancer rebalancer set up by rebalance_init.
+ * @param      workerIndex index of the calling worker.
+ *
+ * @return     socket that connections handed to this worker arrive on; it
+ *   becomes readable when one does.
+ */
+int rebalance_attach(struct rebalancer_t* rebalancer, int workerIndex)
+{
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE,&limit) == -1 || limit.rlim_cur == RLIM_INFINITY)
+    {
+        limit.rlim_cur = 65536;
+    }
+    rebalancer->tableLen = (int) limit.rlim_cur;
+    rebalancer->states = (struct connection_state_t*) calloc(rebalancer->tableLen,sizeof(struct connection_state_t));
+    rebalancer->workerIndex = workerIndex;
+    rebalancer->nextRebalanceTime = current_time()+REBALANCE_INTERVAL;
+
+    struct worker_load_t* load = &rebalancer->loads[workerIndex];
+    __atomic_store_n(&load->numConnections,0,__ATOMIC_RELAXED);
+    __atomic_store_n(&load->isAccepting,true,__ATOMIC_RELAXED);
+    return rebalancer->inboxes[workerIndex][0];
+}
+
+/**
+ * starts tracking the connection {fd}, and counts it in this worker's load.
+ *
+ * @function   rebalance_open
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  void rebalance_open(struct rebalancer_t* rebalancer, int fd)
+ *
+ * @param      rebalancer rebalancer of this worker.
+ * @param      fd socket of the connection.
+ */
+void rebalance_open(struct rebalancer_t* rebalancer, int fd)
+{
+    struct worker_load_t* load = &rebalancer->loads[rebalancer->workerIndex];
+    __atomic_store_n(&load->numConnections,load->numConnections+1,__ATOMIC_RELAXED);
+    if (fd >= rebalancer->tableLen) return;
+
+    rebalancer->states[fd].bytesEchoed = 0;
+    rebalancer->states[fd].recentReads = 0;
+    rebalancer->states[fd].isOpen = true;
+    rebalancer->states[fd].isPinned = false;
+    if (fd > rebalancer->maxFd) rebalancer->maxFd = fd;
+}
+
+/**
+ * stops tracking the connection {fd}; called when it is closed, or handed to
+ *   another worker.
+ *
+ * @function   rebalance_close
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  void rebalance_close(struct rebalancer_t* rebalancer, int fd)
+ *
+ * @param      rebalancer rebalancer of this worker.
+ * @param      fd socket of the connection.
+ */
+void rebalance_close(struct rebalancer_t* rebalancer, int fd)
+{
+    struct worker_load_t* load = &rebalancer->loads[rebalancer->workerIndex];
+    __atomic_store_n(&load->numConnections,load->numConnections-1,__ATOMIC_RELAXED);
+    if (fd < rebalancer->tableLen)
+    {
+        rebalancer->states[fd].isOpen = false;
+    }
+}
+
+/**
+ * stops this worker from being handed connections; called when it starts
+ *   draining.
+ *
+ * @function   rebalance_stop
+ *
+ * @date       2026-10-16
+ *
+ * @revision   2026-10-16 Eric Tsang - shuts the inbox of the worker for
+ *   reading, so siblings that picked it before it stopped cannot hand it
+ *   connections it would never take over.
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       connections already on their way are still taken over, by
+ *   calling rebalance_recv until it returns -1; sending more fails with
+ *   EPIPE, and the connection stays with its sender.
+ *
+ * @signature  void rebalance_stop(struct rebalancer_t* rebalancer)
+ *
+ * @param      rebalancer rebalancer of this worker.
+ */
+void rebalance_stop(struct rebalancer_t* rebalancer)
+{
+    __atomic_store_n(&rebalancer->loads[rebalancer->workerIndex].isAccepting,false,__ATOMIC_RELAXED);
+    if (shutdown(rebalancer->inboxes[rebalancer->workerIndex][0],SHUT_RD) == -1)
+    {
+        fatal_error("shutdown");
+    }
+}
+
+/**
+ * returns the milliseconds until this worker should call rebalance_pick next.
+ *
+ * @function   rebalance_timeout
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  int rebalance_timeout(struct rebalancer_t* rebalancer)
+ *
+ * @param      rebalancer rebalancer of this worker.
+ *
+ * @return     milliseconds until the next load check; 0 if it is due.
+ */
+int rebalance_timeout(struct rebalancer_t* rebalancer)
+{
+    long remaining = rebalancer->nextRebalanceTime-current_time();
+    return remaining > 0 ? (int) remaining : 0;
+}
+
+/**
+ * compares this worker's load with its siblings', and picks the connections
+ *   to hand off if it carries more than REBALANCE_THRESHOLD times the average.
+ *   does nothing until the next load check is due.
+ *
+ * @function   rebalance_pick
+ *
+ * @date       2026-10-16
+ *
+ * @revision   2026-10-16 Eric Tsang - skips pinned connections.
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       connections go to the least loaded sibling that is accepting,
+ *   and no more go than would bring either worker past the average. idle
+ *   connections, with no reads since the last check, are picked first, then
+ *   connections with fewer reads than average; busy connections stay, so the
+ *   handoff does not stall them. pinned connections always stay.
+ *
+ * @signature  int rebalance_pick(struct rebalancer_t* rebalancer, int* fds,
+ *   int maxFds, int* target)
+ *
+ * @param      rebalancer rebalancer of this worker.
+ * @param      fds array to put the connections to hand off in.
+ * @param      maxFds number of entries in {fds}.
+ * @param      target set to the index of the worker to hand them to.
+ *
+ * @return     number of connections put in {fds}.
+ */
+int rebalance_pick(struct rebalancer_t* rebalancer, int* fds, int maxFds, int* target)
+{
+    long now = current_time();
+    if (now < rebalancer->nextRebalanceTime) return 0;
+    rebalancer->nextRebalanceTime = now+REBALANCE_INTERVAL;
+
+    // work out the average load, and the least loaded sibling
+    int ownLoad = rebalancer->loads[rebalancer->workerIndex].numConnections;
+    int totalLoad = 0;
+    int numAccepting = 0;
+    int minLoad = -1;
+    for (register int i = 0; i < rebalancer->numWorkers; ++i)
+    {
+        if (!__atomic_load_n(&rebalancer->loads[i].isAccepting,__ATOMIC_RELAXED)) continue;
+        int load = __atomic_load_n(&rebalancer->loads[i].numConnections,__ATOMIC_RELAXED);
+        totalLoad += load;
+        numAccepting++;
+        if (i != rebalancer->workerIndex && (minLoad < 0 || load < minLoad))
+        {
+            minLoad = load;
+            *target = i;
+        }
+    }
+
+    // hand off as many as brings this worker or the target to the average
+    int count = 0;
+    if (minLoad >= 0 && ownLoad > REBALANCE_THRESHOLD*totalLoad/numAccepting)
+    {
+        int averageLoad = totalLoad/numAccepting;
+        int numToMove = ownLoad-averageLoad;
+        if (averageLoad-minLoad < numToMove) numToMove = averageLoad-minLoad;
+        if (maxFds < numToMove) numToMove = maxFds;
+        if (REBALANCE_BATCH_LEN < numToMove) numToMove = REBALANCE_BATCH_LEN;
+
+        // pick idle connections first, then quiet ones
+        unsigned long totalReads = 0;
+        for (register int fd = 0; fd <= rebalancer->maxFd; ++fd)
+        {
+            if (rebalancer->states[fd].isOpen) totalReads += rebalancer->states[fd].recentReads;
+        }
+        unsigned int averageReads = ownLoad > 0 ? (unsigned int) (totalReads/ownLoad) : 0;
+        for (register int pass = 0; pass < 2 && count < numToMove; ++pass)
+        {
+            unsigned int maxReads = pass == 0 ? 0 : averageReads;
+            for (register int fd = 0; fd <= rebalancer->maxFd && count < numToMove; ++fd)
+            {
+                struct connection_state_t* state = &rebalancer->states[fd];
+                if (!state->isOpen || state->isPinned || state->recentReads > maxReads) continue;
+                if (pass == 1 && state->recentReads == 0) continue;
+                fds[count++] = fd;
+            }
+        }
+    }
+
+    // start a new interval
+    for (register int fd = 0; fd <= rebalancer->maxFd; ++fd)
+    {
+        rebalancer->states[fd].recentReads = 0;
+    }
+    return count;
+}
+
+/**
+ * hands the connection {fd} and its state to worker {target}. on success, the
+ *   connection is no longer tracked, and the caller should close its copy of
+ *   {fd}; the connection stays open in the target.
+ *
+ * @function   rebalance_send
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the caller must stop watching {fd} for events first.
+ *
+ * @signature  bool rebalance_send(struct rebalancer_t* rebalancer, int target,
+ *   int fd)
+ *
+ * @param      rebalancer rebalancer of this worker.
+ * @param      target index of the worker to hand the connection to.
+ * @param      fd socket of the connection.
+ *
+ * @return     true if the connection was handed off; false if the target's
+ *   socket pair is full, or the target started draining, in which case the
+ *   connection stays with this worker.
+ */
+bool rebalance_send(struct rebalancer_t* rebalancer, int target, int fd)
+{
+    struct connection_state_t state = fd < rebalancer->tableLen ? rebalancer->states[fd] : connection_state_t();
+    if (!send_fd(rebalancer->inboxes[target][1],fd,&state,sizeof(state)))
+    {
+        errno = 0;
+        return false;
+    }
+    rebalance_close(rebalancer,fd);
+    rebalancer->migratedCount++;
+    return true;
+}
+
+/**
+ * takes over one connection handed to this worker, along with its state.
+ *
+ * @function   rebalance_recv
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       to be called until it returns -1 whenever the socket returned
+ *   by rebalance_attach is readable. the connection is tracked, and counted in
+ *   this worker's load.
+ *
+ * @signature  int rebalance_recv(struct rebalancer_t* rebalancer)
+ *
+ * @param      rebalancer rebalancer of this worker.
+ *
+ * @return     socket of the connection taken over; -1 if there are no more.
+ */
+int rebalance_recv(struct rebalancer_t* rebalancer)
+{
+    struct connection_state_t state;
+    int fd = recv_fd(rebalancer->inboxes[rebalancer->workerIndex][0],&state,sizeof(state));
+    if (fd == -1)
+    {
+        errno = 0;
+        return -1;
+    }
+    rebalance_open(rebalancer,fd);
+    if (fd < rebalancer->tableLen)
+    {
+        rebalancer->states[fd].bytesEchoed = state.bytesEchoed;
+    }
+    rebalancer->adoptedCount++;
+    return fd;
+}
+
+/**
+ * returns the current time of the monotonic clock in milliseconds.
+ *
+ * @function   current_time
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  static long current_time()
+ *
+ * @return     current time in milliseconds.
+ */
+static long current_time()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC,&now);
+    return now.tv_sec*1000+now.tv_nsec/1000000;
+}
+
+/**
+ * prints the error message, then exits the program.
+ *
+ * @function   fatal_error
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  static void fatal_error(const char* errstr)
+ *
+ * @param      errstr string to print before exiting the program
+ */
+static void fatal_error(const char* errstr)
+{
+    fprintf(stderr,"%s: ",errstr);
+    perror(0);
+    exit(EX_OSERR);
+}
@@ -0,0 +1,108 @@
+#ifndef _REBALANCE_HELPER_H_
+#define _REBALANCE_HELPER_H_
+
+#include <sys/types.h>
+
+/**
+ * milliseconds between checks of a worker's load against its siblings'.
+ */
+#define REBALANCE_INTERVAL 1000
+
+/**
+ * a worker hands connections off once it carries this many times the average
+ *   number of connections.
+ */
+#define REBALANCE_THRESHOLD 1.25
+
+/**
+ * most connections a worker hands off per interval, so that load moves in
+ *   steps instead of sloshing between workers.
+ */
+#define REBALANCE_BATCH_LEN 64
+
+/**
+ * size of a cache line; each worker's load gets a line of its own, so workers
+ *   publishing their load do not contend.
+ */
+#define REBALANCE_CACHE_LINE_LEN 64
+
+/**
+ * load of one worker, published in memory shared by all workers.
+ */
+struct alignas(REBALANCE_CACHE_LINE_LEN) worker_load_t
+{
+    int numConnections;         // number of connections open
+    bool isAccepting;           // false until started, and once draining
+};
+
+/**
+ * state of a connection that moves with it from one worker to another. the
+ *   socket's kernel buffers, and any bytes not yet read, move with the file
+ *   descriptor.
+ */
+struct connection_state_t
+{
+    unsigned long long bytesEchoed;     // bytes echoed over the connection's life
+    unsigned int recentReads;           // reads in the current interval
+    bool isOpen;                        // true if the connection is tracked
+    bool isPinned;                      // true while the worker holds state of
+                                        //   the connection that cannot move
+};
+
+/**
+ * connections of a worker, and the means to move them to its siblings: a
+ *   load table in shared memory, and a unix domain socket pair per worker that
+ *   connections are sent to it over with SCM_RIGHTS.
+ */
+struct rebalancer_t
+{
+    struct worker_load_t* loads;        // load of every worker; shared
+    int (*inboxes)[2];                  // socket pair of every worker; [0] is
+                                        //   read by the worker, [1] written by
+                                        //   its siblings
+    int numWorkers;
+    int workerIndex;                    // index of this worker
+    struct connection_state_t* states;  // by file descriptor
+    int tableLen;                       // number of entries in states
+    int maxFd;                          // biggest file descriptor tracked so far
+    long nextRebalanceTime;             // time to check the load at next
+    unsigned long migratedCount;        // connections handed off so far
+    unsigned long adoptedCount;         // connections taken over so far
+};
+
+void rebalance_init(struct rebalancer_t* rebalancer, int numWorkers);
+int rebalance_attach(struct rebalancer_t* rebalancer, int workerIndex);
+void rebalance_open(struct rebalancer_t* rebalancer, int fd);
+void rebalance_close(struct rebalancer_t* rebalancer, int fd);
+void rebalance_stop(struct rebalancer_t* rebalancer);
+int rebalance_timeout(struct rebalancer_t* rebalancer);
+int rebalance_pick(struct rebalancer_t* rebalancer, int* fds, int maxFds, int* target);
+bool rebalance_send(struct rebalancer_t* rebalancer, int target, int fd);
+int rebalance_recv(struct rebalancer_t* rebalancer);
+
+/**
+ * records that {bytes} were echoed over the connection {fd}.
+ */
+inline void rebalance_touch(struct rebalancer_t* rebalancer, int fd, int bytes)
+{
+    if (fd < rebalancer->tableLen)
+    {
+        rebalancer->states[fd].bytesEchoed += bytes;
+        rebalancer->states[fd].recentReads++;
+    }
+}
+
+/**
+ * records whether the worker holds state of the connection {fd} that would be
+ *   lost if it moved, such as output the socket has not taken yet, or part of
+ *   a request; pinned connections are never picked to hand off.
+ */
+inline void rebalance_pin(struct rebalancer_t* rebalancer, int fd, bool isPinned)
+{
+    if (fd < rebalancer->tableLen)
+    {
+        rebalancer->states[fd].isPinned = isPinned;
+    }
+}
+
+#endif
@@ -0,0 +1,215 @@
+#include "schedule_helper.h"
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static void schedule_alloc(struct schedule_t* schedule, size_t count);
+
+/**
+ * makes a schedule of a single phase that ramps up to {targetClients}, and
+ *   holds them forever.
+ *
+ * @function   schedule_init_single
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  void schedule_init_single(struct schedule_t* schedule,
+ *   unsigned int targetClients, double rampRate)
+ *
+ * @param      schedule schedule to initialize.
+ * @param      targetClients number of clients to ramp up to.
+ * @param      rampRate connections to open per second; 0 to open them all at
+ *   once.
+ */
+void schedule_init_single(struct schedule_t* schedule, unsigned int targetClients, double rampRate)
+{
+    schedule_alloc(schedule,1);
+    schedule->phases[0].targetClients = targetClients;
+    schedule->phases[0].rampRate = rampRate;
+    schedule->phases[0].holdTime = -1;
+}
+
+/**
+ * reads a schedule from the file at {path}. each line describes one phase as
+ *   "[clients] [ramp rate] [hold time]": the number of clients to have open,
+ *   the connections opened or closed per second to get there (0 for all at
+ *   once), and the milliseconds to hold that load (-1 for forever). blank lines
+ *   and lines starting with '#' are ignored.
+ *
+ * @function   schedule_init_file
+ *
+ * @date       2026-10-16
+ *
+ * @revision   2026-10-16 Eric Tsang - rejects a negative number of clients,
+ *   which used to wrap around, and tells the caller the malformed line.
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       a phase with fewer clients than the one before it ramps down.
+ *
+ * @signature  bool schedule_init_file(struct schedule_t* schedule,
+ *   const char* path, int* badLine)
+ *
+ * @param      schedule schedule to initialize.
+ * @param      path path to the schedule file.
+ * @param      badLine set to the number of the first malformed line, counting
+ *   from 1, or to 0 if no line is malformed.
+ *
+ * @return     true on success; false if the file could not be read, is
+ *   malformed or holds no phases.
+ */
+bool schedule_init_file(struct schedule_t* schedule, const char* path, int* badLine)
+{
+    *badLine = 0;
+    FILE* file = fopen(path,"r");
+    if (file == 0)
+    {
+        return false;
+    }
+
+    size_t capacity = 0;
+    bool isValid = true;
+    char line[256];
+    int lineNumber = 0;
+    schedule->phases = 0;
+    schedule->count = 0;
+    while (fgets(line,sizeof(line),file) != 0)
+    {
+        ++lineNumber;
+        char* cursor = line;
+        while (*cursor == ' ' || *cursor == '\t') ++cursor;
+        if (*cursor == '#' || *cursor == '\n' || *cursor == 0)
+        {
+            continue;
+        }
+
+        // the number of clients is read as signed, since %u takes "-5" and
+        // wraps it around
+        struct phase_t phase;
+        long targetClients;
+        if (sscanf(cursor,"%ld %lf %ld",&targetClients,&phase.rampRate,&phase.holdTime) != 3 ||
+            targetClients < 0 || targetClients > UINT_MAX || phase.rampRate < 0 || phase.holdTime < -1)
+        {
+            *badLine = lineNumber;
+            isValid = false;
+            break;
+        }
+        phase.targetClients = (unsigned int) targetClients;
+
+        if (schedule->count == capacity)
+        {
+            capacity = capacity ? capacity*2 : 16;
+            schedule->phases = (struct phase_t*) realloc(schedule->phases,capacity*sizeof(struct phase_t));
+            if (schedule->phases == 0)
+            {
+                perror("realloc");
+                exit(EXIT_FAILURE);
+            }
+        }
+        schedule->phases[schedule->count++] = phase;
+    }
+    fclose(file);
+
+    if (!isValid || schedule->count == 0)
+    {
+        free(schedule->phases);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * makes {share}, the part of {schedule} that worker {workerIndex} of
+ *   {numWorkers} runs. clients and ramp rates are split evenly; the first
+ *   worker also takes the remainder of the clients.
+ *
+ * @function   schedule_share
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  void schedule_share(const struct schedule_t* schedule,
+ *   struct schedule_t* share, int workerIndex, int numWorkers)
+ *
+ * @param      schedule schedule of the whole run.
+ * @param      share schedule to initialize with this worker's share.
+ * @param      workerIndex index of the worker.
+ * @param      numWorkers number of workers the schedule is split between.
+ */
+void schedule_share(const struct schedule_t* schedule, struct schedule_t* share, int workerIndex, int numWorkers)
+{
+    schedule_alloc(share,schedule->count);
+    for (size_t i = 0; i < schedule->count; ++i)
+    {
+        const struct phase_t* phase = schedule->phases+i;
+        share->phases[i].targetClients = phase->targetClients/numWorkers+(workerIndex == 0 ? phase->targetClients%numWorkers : 0);
+        share->phases[i].rampRate = phase->rampRate/numWorkers;
+        share->phases[i].holdTime = phase->holdTime;
+    }
+}
+
+/**
+ * returns the largest number of clients any phase of {schedule} has open.
+ *
+ * @function   schedule_max_clients
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  unsigned int schedule_max_clients(const struct schedule_t* schedule)
+ *
+ * @param      schedule schedule to inspect.
+ *
+ * @return     the largest number of clients any phase has open.
+ */
+unsigned int schedule_max_clients(const struct schedule_t* schedule)
+{
+    unsigned int maxClients = 0;
+    for (size_t i = 0; i < schedule->count; ++i)
+    {
+        if (maxClients < schedule->phases[i].targetClients)
+        {
+            maxClients = schedule->phases[i].targetClients;
+        }
+    }
+    return maxClients;
+}
+
+/**
+ * allocates {count} phases for {schedule}.
+ */
+static void schedule_alloc(struct schedule_t* schedule, size_t count)
+{
+    schedule->count = count;
+    schedule->phases = (struct phase_t*) calloc(count,sizeof(struct phase_t));
+    if (schedule->phases == 0)
+    {
+        perror("calloc");
+        exit(EXIT_FAILURE);
+    }
+}
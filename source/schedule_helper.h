@@ -0,0 +1,32 @@
+#ifndef _SCHEDULE_HELPER_H_
+#define _SCHEDULE_HELPER_H_
+
+#include <stddef.h>
+
+/**
+ * one phase of a load schedule: connections are opened (or closed) at
+ *   rampRate per second until targetClients are open, then the load is held
+ *   for holdTime milliseconds before the next phase starts.
+ */
+struct phase_t
+{
+    unsigned int targetClients;     // number of clients to have open
+    double rampRate;                // connections opened or closed per second; 0 for all at once
+    long holdTime;                  // milliseconds to hold once targetClients is reached; -1 for forever
+};
+
+/**
+ * a load schedule made of one or more phases, run in order.
+ */
+struct schedule_t
+{
+    struct phase_t* phases;
+    size_t count;
+};
+
+void schedule_init_single(struct schedule_t* schedule, unsigned int targetClients, double rampRate);
+bool schedule_init_file(struct schedule_t* schedule, const char* path, int* badLine);
+void schedule_share(const struct schedule_t* schedule, struct schedule_t* share, int workerIndex, int numWorkers);
+unsigned int schedule_max_clients(const struct schedule_t* schedule);
+
+#endif
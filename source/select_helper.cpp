@@ -6,6 +6,7 @@ void files_init(Files* files)
     printf("files_init(%p)\n",files);
 #endif
     FD_ZERO(&files->_selectFds);
+    FD_ZERO(&files->_writeFds);
     files->maxFd = 0;
 }
 
@@ -15,7 +16,26 @@ int files_select(Files* files)
     printf("files_select(%p)\n",files);
 #endif
     files->selectFds = files->_selectFds;
-    return select(files->maxFd+1 , &files->selectFds, 0, 0, 0);
+    files->writeFds = files->_writeFds;
+    return select(files->maxFd+1 , &files->selectFds, &files->writeFds, 0, 0);
+}
+
+int files_select_timeout(Files* files, int timeout)
+{
+#ifdef DEBUG
+    printf("files_select_timeout(%p,%d)\n",files,timeout);
+#endif
+    // a negative timeout blocks until a file is ready
+    if(timeout < 0)
+    {
+        return files_select(files);
+    }
+    struct timeval tv;
+    tv.tv_sec = timeout/1000;
+    tv.tv_usec = (timeout%1000)*1000;
+    files->selectFds = files->_selectFds;
+    files->writeFds = files->_writeFds;
+    return select(files->maxFd+1 , &files->selectFds, &files->writeFds, 0, &tv);
 }
 
 void files_add_file(Files* files, int newFd)
@@ -41,6 +61,7 @@ void files_rm_file(Files* files, int fd)
 #endif
     // remove the file from our sets
     FD_CLR(fd, &files->_selectFds);
+    FD_CLR(fd, &files->_writeFds);
     files->fdSet.erase(fd);
 
     // update maxFd if needed
@@ -56,3 +77,21 @@ void files_rm_file(Files* files, int fd)
         }
     }
 }
+
+void files_wait_write(Files* files, int fd, bool isWaiting)
+{
+#ifdef DEBUG
+    printf("files_wait_write(%p,%d,%d)\n",files,fd,isWaiting);
+#endif
+    // a file waiting to be writable is not selected for reading meanwhile
+    if(isWaiting)
+    {
+        FD_CLR(fd, &files->_selectFds);
+        FD_SET(fd, &files->_writeFds);
+    }
+    else
+    {
+        FD_CLR(fd, &files->_writeFds);
+        FD_SET(fd, &files->_selectFds);
+    }
+}
@@ -10,12 +10,16 @@ typedef struct
     std::set<int> fdSet;    // set of all file descriptors
     fd_set _selectFds;      // set of all file descriptors for internal uses
     fd_set selectFds;       // set of selected file descriptors
+    fd_set _writeFds;       // set of file descriptors waiting to be writable
+    fd_set writeFds;        // set of selected writable file descriptors
     int maxFd;              // integer corresponding to biggest file descriptor
 } Files;
 
 void files_init(Files* files);
 int files_select(Files* files);
+int files_select_timeout(Files* files, int timeout);
 void files_add_file(Files* files, int newFd);
 void files_rm_file(Files* files, int fd);
+void files_wait_write(Files* files, int fd, bool isWaiting);
 
 #endif
@@ -26,14 +26,14 @@
 #include <sysexits.h>
 #include <sys/wait.h>
 #include <sys/epoll.h>
+#include <sys/signalfd.h>
 #include <netinet/in.h>
 #include "net_helper.h"
 #include "select_helper.h"
-
-/**
- * size of buffer used to read bytes into from TCP/IP sockets.
- */
-#define ECHO_BUFFER_LEN 1024
+#include "supervisor_helper.h"
+#include "drain_helper.h"
+#include "perf_helper.h"
+#include "handler_helper.h"
 
 /**
  * prints the error message, then exits the program.
@@ -69,23 +69,63 @@ void fatal_error(char const * string)
  *
  * @date       2016-02-14
  *
- * @revision   none
+ * @revision   2026-10-16 Eric Tsang - no longer uses the iterator of a socket
+ *   after the socket is removed from the set.
+ * @revision   2026-10-16 Eric Tsang - on SUPERVISOR_DRAIN_SIGNAL, stops
+ *   accepting connections, half-closes idle ones, and returns once they are
+ *   closed, or {drainTimeout} has passed.
+ * @revision   2026-10-16 Eric Tsang - counts hardware and software events
+ *   with perf, and prints them with the echoes and connections served on
+ *   SUPERVISOR_DUMP_SIGNAL, and once drained.
+ * @revision   2026-10-16 Eric Tsang - serves the protocol of {Handler}
+ *   instead of echoing; an echo counts one read it handled.
+ * @revision   2026-10-16 Eric Tsang - keeps output the socket does not take,
+ *   and selects the connection for writing instead of reading until it is
+ *   sent.
+ * @revision   2026-10-16 Eric Tsang - reads as many bytes at once as
+ *   {Handler} asks for.
+ * @revision   2026-10-16 Eric Tsang - sends the output of a read the
+ *   handler rejects before closing the connection.
  *
  * @designer   Eric Tsang
  *
  * @programmer Eric Tsang
  *
- * @note       none
+ * @note       SUPERVISOR_DRAIN_SIGNAL and SUPERVISOR_DUMP_SIGNAL must already
+ *   be blocked. connections the drain closes are not passed to
+ *   Handler::on_close; the worker exits right after.
  *
- * @signature  int child_process(int serverSocket)
+ * @signature  template<class Handler> int child_process(int serverSocket,
+ *   long drainTimeout, int workerIndex)
  *
  * @param      serverSocket server socket on the local host to accept and
  *   service connection requests from.
+ * @param      drainTimeout milliseconds to wait for connections to close once
+ *   draining, before closing them.
+ * @param      workerIndex index of this worker.
  *
  * @return     exit code of the process.
  */
-int child_process(int serverSocket)
+template<class Handler>
+int child_process(int serverSocket, long drainTimeout, int workerIndex)
 {
+    // connections open, tracked so they can be drained
+    struct drain_t drain;
+    drain_init(&drain);
+
+    // handler state, and output not yet sent, of each connection, by file
+    // descriptor
+    typename Handler::conn_t* conns = new typename Handler::conn_t[handler_table_len()];
+    struct pending_output_t* pendings = new pending_output_t[handler_table_len()]();
+
+    // hardware and software events of the worker, and what it served
+    char label[32];
+    sprintf(label,"worker %d",workerIndex);
+    struct perf_group_t perfGroup;
+    perf_open(&perfGroup,false);
+    unsigned long numEchoes = 0;
+    unsigned long numConnections = 0;
+
     // create selectable files set
     Files files;
     files_init(&files);
@@ -93,50 +133,137 @@ int child_process(int serverSocket)
     // add server socket to select event loop
     files_add_file(&files,serverSocket);
 
-    // execute select event loop
+    // add the drain and dump signals to select event loop
+    int drainFd;
+    {
+        sigset_t signals;
+        sigemptyset(&signals);
+        sigaddset(&signals,SUPERVISOR_DRAIN_SIGNAL);
+        sigaddset(&signals,SUPERVISOR_DUMP_SIGNAL);
+        drainFd = signalfd(-1,&signals,SFD_NONBLOCK|SFD_CLOEXEC);
+        if (drainFd == -1)
+        {
+            fatal_error("signalfd");
+        }
+        files_add_file(&files,drainFd);
+    }
+
+    // execute select event loop until drained
     while (true)
     {
+        // move the drain along, if draining
+        int timeout = -1;
+        if (drain_is_draining(&drain) && !drain_step(&drain,&timeout))
+        {
+            break;
+        }
+
         // wait for select to unblock to report socket activity
         // wait for an event on any socket to occur
-        if(files_select(&files) == -1)
+        if(files_select_timeout(&files,timeout) == -1)
         {
             fatal_error("failed on select");
         }
 
         // loop through sockets, and handle them
-        for(std::set<int>::iterator socketIt = files.fdSet.begin(); socketIt != files.fdSet.end(); ++socketIt)
+        bool isDrainSignalled = false;
+        // the iterator is advanced before the socket is handled, because
+        // closing the socket removes it from the set
+        for(std::set<int>::iterator socketIt = files.fdSet.begin(); socketIt != files.fdSet.end();)
         {
-            int curSock = *socketIt;
+            int curSock = *socketIt++;
 
             // if this socket doesn't have any activity, move on to next socket
-            if(!FD_ISSET(curSock,&files.selectFds))
+            if(!FD_ISSET(curSock,&files.selectFds) && !FD_ISSET(curSock,&files.writeFds))
+            {
+                continue;
+            }
+
+            // print the perf counters when told to dump; stop accepting
+            // connections when told to drain, once done with the sockets of
+            // this round
+            if (curSock == drainFd)
             {
+                struct signalfd_siginfo info;
+                while (read(drainFd,&info,sizeof(info)) == sizeof(info))
+                {
+                    if (info.ssi_signo == SUPERVISOR_DUMP_SIGNAL)
+                    {
+                        perf_report(stderr,label,&perfGroup,numEchoes,numConnections);
+                    }
+                    else
+                    {
+                        isDrainSignalled = true;
+                    }
+                }
+                errno = 0;
                 continue;
             }
 
-            // handling case when client socket has data available for reading
+            // handling case when client socket has data available for reading,
+            // or room to send output that was pending
             if (curSock != serverSocket)
             {
                 // read data from socket...
-                static char buf[ECHO_BUFFER_LEN];
-                register int bytesRead;
+                static char buf[Handler::readLen];
+                register int bytesRead = 0;
+                typename Handler::conn_t* conn = conns+curSock;
+                struct pending_output_t* pending = pendings+curSock;
+                struct handler_output_t output;
+                enum send_result_t sendResult = SEND_DONE;
+
+                // send what the socket did not take before; reading waits
+                // until it has
+                drain_touch(&drain,curSock);
+                bool isWaitingToSend = pending->numSpans > 0;
+                if (isWaitingToSend)
+                {
+                    sendResult = handler_flush(curSock,pending);
+                    if (sendResult == SEND_DONE)
+                    {
+                        files_wait_write(&files,curSock,false);
+                        isWaitingToSend = false;
+                    }
+                }
+
+                // read, and send back what the handler responds with; a
+                // connection the handler rejected is not read again, and closes
+                // once its last output is sent
+                bool isRejected = pending->isClosing;
+                while (!isRejected && sendResult == SEND_DONE && (bytesRead = recv(curSock,buf,Handler::readLen,0)) > 0)
+                {
+                    struct span_t data = {buf,(size_t) bytesRead};
+                    isRejected = !Handler::on_data(conn,data,&output);
+                    sendResult = handler_send(curSock,&output,pending,buf,bytesRead);
+                    numEchoes++;
+                }
 
-                // read and echo back to client
-                while ((bytesRead = recv(curSock,buf,ECHO_BUFFER_LEN,0)) > 0)
+                // if the socket is full, select it for writing until there is
+                // room in it
+                if (sendResult == SEND_PENDING)
                 {
-                    send(curSock,buf,bytesRead,0);
+                    pending->isClosing = isRejected;
+                    if (!isWaitingToSend)
+                    {
+                        files_wait_write(&files,curSock,true);
+                    }
                 }
 
                 // if call would block, continue event loop
-                if (bytesRead == -1 && errno == EWOULDBLOCK)
+                else if (!isRejected && sendResult == SEND_DONE && bytesRead == -1 && errno == EWOULDBLOCK)
                 {
                     errno = 0;
                 }
 
-                // close socket if connection is closed or unexpected error
+                // close socket if connection is closed, unexpected error, or
+                // the handler rejected it and its output is sent
                 else
                 {
                     // close socket & remove from select event loop
+                    Handler::on_close(conn);
+                    handler_free_pending(pending);
+                    drain_close(&drain,curSock);
+                    if (isRejected) handler_linger(curSock);
                     close(curSock);
                     files_rm_file(&files,curSock);
                 }
@@ -170,23 +297,52 @@ int child_process(int serverSocket)
                     fatal_error("fcntl");
                 }
 
+                // apply the socket options profile to the new socket
+                apply_sockopt_profile(newSocket);
+
                 // add new socket to select loop
                 files_add_file(&files,newSocket);
+                drain_open(&drain,newSocket);
+                Handler::on_accept(conns+newSocket,newSocket);
+                numConnections++;
                 continue;
             }
         }
+
+        // stop accepting connections, and start draining
+        if (isDrainSignalled && !drain_is_draining(&drain))
+        {
+            files_rm_file(&files,serverSocket);
+            close(serverSocket);
+            drain_start(&drain,drainTimeout);
+        }
     }
+    perf_report(stderr,label,&perfGroup,numEchoes,numConnections);
+    perf_close(&perfGroup);
+    delete[] conns;
+    delete[] pendings;
     return EX_OK;
 }
 
 /**
- * waits for all child processes to terminate before terminating itself.
+ * arguments shared by all worker processes.
+ */
+struct worker_args_t
+{
+    int serverSocket;           // listening socket
+    long drainTimeout;          // milliseconds workers drain for
+    enum handler_kind_t handler;    // protocol workers serve
+};
+
+/**
+ * entry point of the supervised worker processes.
  *
- * @function   server_process
+ * @function   worker_main
  *
- * @date       2016-02-14
+ * @date       2026-10-16
  *
- * @revision   none
+ * @revision   2026-10-16 Eric Tsang - runs the worker with the handler of
+ *   the server.
  *
  * @designer   Eric Tsang
  *
@@ -194,17 +350,27 @@ int child_process(int serverSocket)
  *
  * @note       none
  *
- * @signature  int server_process(int numWorkerProcesses)
+ * @signature  int worker_main(int workerIndex, void* arg)
  *
- * @param      numWorkerProcesses number of child processes to wait for before
- *   terminating.
+ * @param      workerIndex slot of the worker.
+ * @param      arg pointer to the worker_args_t of the server.
  *
  * @return     exit code of the process.
  */
-int server_process(int numWorkerProcesses)
+int worker_main(int workerIndex, void* arg)
 {
-    for (register int i = 0; i < numWorkerProcesses; ++i) wait(0);
-    return EX_OK;
+    struct worker_args_t* args = (struct worker_args_t*) arg;
+    switch (args->handler)
+    {
+    case HANDLER_DISCARD:
+        return child_process<discard_handler_t>(args->serverSocket,args->drainTimeout,workerIndex);
+    case HANDLER_CHARGEN:
+        return child_process<chargen_handler_t>(args->serverSocket,args->drainTimeout,workerIndex);
+    case HANDLER_LENGTH:
+        return child_process<length_handler_t>(args->serverSocket,args->drainTimeout,workerIndex);
+    default:
+        return child_process<echo_handler_t>(args->serverSocket,args->drainTimeout,workerIndex);
+    }
 }
 
 /**
@@ -218,7 +384,11 @@ int server_process(int numWorkerProcesses)
  *
  * @date       2016-02-14
  *
- * @revision   none
+ * @revision   2026-10-16 Eric Tsang - worker processes are supervised, and
+ *   respawned when they terminate.
+ * @revision   2026-10-16 Eric Tsang - SIGTERM drains the workers; -D sets how
+ *   long for.
+ * @revision   2026-10-16 Eric Tsang - -a picks the protocol workers serve.
  *
  * @designer   Eric Tsang
  *
@@ -244,12 +414,18 @@ int main (int argc, char* argv[])
     // number of worker process to create to server connections
     int numWorkerProcesses;
 
+    // milliseconds to wait for connections to close when draining
+    long drainTimeout = DRAIN_DEFAULT_TIMEOUT;
+
+    // protocol workers serve
+    enum handler_kind_t handler = HANDLER_ECHO;
+
     // parse command line arguments
     {
         char option;
         int portInitialized = false;
         int numWorkerProcessesInitialized = false;
-        while ((option = getopt(argc,argv,"p:n:")) != -1)
+        while ((option = getopt(argc,argv,"p:n:O:D:a:")) != -1)
         {
             switch (option)
             {
@@ -281,6 +457,38 @@ int main (int argc, char* argv[])
                     }
                     break;
                 }
+            case 'D':
+                {
+                    char* parsedCursor = optarg;
+                    drainTimeout = strtol(optarg,&parsedCursor,10);
+                    if (parsedCursor == optarg || drainTimeout < 0)
+                    {
+                        fprintf(stderr,"invalid argument for option -%c\n",option);
+                        drainTimeout = DRAIN_DEFAULT_TIMEOUT;
+                    }
+                    break;
+                }
+            case 'a':
+                {
+                    if (!parse_handler(optarg,&handler))
+                    {
+                        fprintf(stderr,"invalid argument for option -%c\n",option);
+                    }
+                    break;
+                }
+            case 'O':
+                {
+                    struct sockopt_profile_t profile;
+                    if (!parse_sockopt_profile(optarg,&profile))
+                    {
+                        fprintf(stderr,"invalid argument for option -%c\n",option);
+                    }
+                    else
+                    {
+                        set_sockopt_profile(&profile);
+                    }
+                    break;
+                }
             case '?':
                 {
                     if (isprint(optopt))
@@ -303,7 +511,7 @@ int main (int argc, char* argv[])
         if (!portInitialized &&
             !numWorkerProcessesInitialized)
         {
-            fprintf(stderr,"usage: %s [-p server listening port] [-n number of worker processes]\n",argv[0]);
+            fprintf(stderr,"usage: %s [-p server listening port] [-n number of worker processes] [-O socket options, e.g. nodelay,quickack,sndbuf=N] [-D drain timeout in ms] [-a protocol: echo, discard, chargen or length]\n",argv[0]);
             return EX_USAGE;
         }
     }
@@ -315,14 +523,10 @@ int main (int argc, char* argv[])
         fatal_error("socket");
     }
 
-    // start the worker processes
-    for(register int i = 0; i < numWorkerProcesses; ++i)
-    {
-        // if this is worker process, run worker process code
-        if (fork() == 0)
-        {
-            return child_process(serverSocket);
-        }
-    }
-    return server_process(numWorkerProcesses);
+    // start the worker processes, and respawn them if they terminate
+    struct worker_args_t workerArgs;
+    workerArgs.serverSocket = serverSocket;
+    workerArgs.drainTimeout = drainTimeout;
+    workerArgs.handler = handler;
+    return supervise_workers(numWorkerProcesses,worker_main,0,&workerArgs);
 }
@@ -0,0 +1,477 @@
+/**
+ * semaphore contention micro-benchmark. compares the futex based Semaphore
+ *   class against a POSIX sem_t, with threads taking and returning permits
+ *   of one semaphore, and with two threads handing a permit back and forth.
+ *
+ * @sourceFile sembench.cpp
+ *
+ * @program    sembench.out
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the contend workload has every thread wait and post in a loop,
+ *   so with 1 thread, or as many permits as threads, it only measures the
+ *   uncontended fast path. the handoff workload sleeps and wakes on every
+ *   operation, so it measures the slow path.
+ */
+#include <ctype.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sysexits.h>
+#include <sys/resource.h>
+#include "Semaphore.h"
+
+/**
+ * most values a comma separated list option takes.
+ */
+#define SEMBENCH_LIST_LEN 16
+
+/**
+ * most threads of a contend run.
+ */
+#define SEMBENCH_MAX_THREADS 256
+
+/**
+ * a semaphore of either kind, behind the same operations.
+ */
+struct primitive_t
+{
+    const char* name;
+    void* (*create)(int permits);
+    void (*destroy)(void* semaphore);
+    void (*wait)(void* semaphore);
+    void (*post)(void* semaphore);
+};
+
+/**
+ * parameters of one thread of a run.
+ */
+struct run_params_t
+{
+    const struct primitive_t* primitive;
+    void* semaphore;        // semaphore waited on
+    void* peer;             // semaphore posted to in the handoff workload
+    long numOperations;
+    bool isInitiator;       // true for the handoff thread that posts first
+    pthread_barrier_t* startBarrier;
+};
+
+/**
+ * prints the error message, then exits the program.
+ *
+ * @function   fatal_error
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  void fatal_error(const char* string)
+ *
+ * @param      string string to print before exiting the program
+ */
+void fatal_error(char const * string)
+{
+    fprintf(stderr,"%s: ",string);
+    perror(0);
+    exit(EX_OSERR);
+}
+
+/**
+ * operations of the Semaphore class, and of sem_t, for primitive_t.
+ */
+void* semaphore_create(int permits) { return new Semaphore(false,permits); }
+void semaphore_destroy(void* semaphore) { delete (Semaphore*) semaphore; }
+void semaphore_wait(void* semaphore) { ((Semaphore*) semaphore)->wait(); }
+void semaphore_post(void* semaphore) { ((Semaphore*) semaphore)->post(); }
+void* sem_t_create(int permits) { sem_t* sem = new sem_t; sem_init(sem,0,permits); return sem; }
+void sem_t_destroy(void* semaphore) { sem_destroy((sem_t*) semaphore); delete (sem_t*) semaphore; }
+void sem_t_wait(void* semaphore) { while (sem_wait((sem_t*) semaphore) == -1); }
+void sem_t_post(void* semaphore) { sem_post((sem_t*) semaphore); }
+
+/**
+ * primitives compared.
+ */
+static const struct primitive_t primitives[] =
+{
+    {"Semaphore",semaphore_create,semaphore_destroy,semaphore_wait,semaphore_post},
+    {"sem_t",sem_t_create,sem_t_destroy,sem_t_wait,sem_t_post},
+};
+
+/**
+ * returns a monotonic time stamp in nanoseconds.
+ *
+ * @function   current_time_ns
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  long current_time_ns()
+ *
+ * @return     monotonic time stamp in nanoseconds.
+ */
+long current_time_ns()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC,&now);
+    return now.tv_sec*1000000000L+now.tv_nsec;
+}
+
+/**
+ * returns the number of context switches of the process so far.
+ *
+ * @function   context_switches
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       counts voluntary switches, i.e. sleeps, and involuntary ones.
+ *
+ * @signature  long context_switches()
+ *
+ * @return     number of context switches of every thread of the process.
+ */
+long context_switches()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF,&usage);
+    return usage.ru_nvcsw+usage.ru_nivcsw;
+}
+
+/**
+ * parses a comma separated list of positive integers.
+ *
+ * @function   parse_list
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  int parse_list(const char* spec, long* values)
+ *
+ * @param      spec list to parse, e.g. "1,2,4".
+ * @param      values set to the values of the list; SEMBENCH_LIST_LEN long.
+ *
+ * @return     number of values parsed; 0 if {spec} is invalid.
+ */
+int parse_list(const char* spec, long* values)
+{
+    int count = 0;
+    const char* cursor = spec;
+    while (count < SEMBENCH_LIST_LEN)
+    {
+        char* parsedCursor;
+        values[count] = strtol(cursor,&parsedCursor,10);
+        if (parsedCursor == cursor || values[count] <= 0)
+        {
+            return 0;
+        }
+        count++;
+        if (*parsedCursor == '\0')
+        {
+            return count;
+        }
+        if (*parsedCursor != ',')
+        {
+            return 0;
+        }
+        cursor = parsedCursor+1;
+    }
+    return 0;
+}
+
+/**
+ * thread of the contend workload; takes a permit and returns it, over and
+ *   over.
+ *
+ * @function   contend_routine
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  void* contend_routine(void* params)
+ *
+ * @param      params pointer to a run_params_t.
+ *
+ * @return     nothing.
+ */
+void* contend_routine(void* params)
+{
+    struct run_params_t* run = (struct run_params_t*) params;
+    pthread_barrier_wait(run->startBarrier);
+    for (register long i = 0; i < run->numOperations; ++i)
+    {
+        run->primitive->wait(run->semaphore);
+        run->primitive->post(run->semaphore);
+    }
+    return 0;
+}
+
+/**
+ * thread of the handoff workload; waits on its own semaphore, then posts to
+ *   its peer's, over and over.
+ *
+ * @function   handoff_routine
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the initiator posts first, so one permit goes back and forth.
+ *
+ * @signature  void* handoff_routine(void* params)
+ *
+ * @param      params pointer to a run_params_t.
+ *
+ * @return     nothing.
+ */
+void* handoff_routine(void* params)
+{
+    struct run_params_t* run = (struct run_params_t*) params;
+    pthread_barrier_wait(run->startBarrier);
+    if (run->isInitiator)
+    {
+        run->primitive->post(run->peer);
+    }
+    for (register long i = 0; i < run->numOperations; ++i)
+    {
+        run->primitive->wait(run->semaphore);
+        if (!run->isInitiator || i < run->numOperations-1)
+        {
+            run->primitive->post(run->peer);
+        }
+    }
+    return 0;
+}
+
+/**
+ * runs {numThreads} threads of a workload, and prints a row of the results
+ *   table.
+ *
+ * @function   run
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the handoff workload always runs 2 threads, each on a
+ *   semaphore of its own that starts with no permits.
+ *
+ * @signature  void run(const struct primitive_t* primitive, bool isHandoff,
+ *   int numThreads, int permits, long numOperations)
+ *
+ * @param      primitive semaphore to measure.
+ * @param      isHandoff true for the handoff workload; false for contend.
+ * @param      numThreads number of threads of the contend workload.
+ * @param      permits initial permits of the contend workload's semaphore.
+ * @param      numOperations wait and post pairs per thread.
+ */
+void run(const struct primitive_t* primitive, bool isHandoff, int numThreads, int permits, long numOperations)
+{
+    if (isHandoff)
+    {
+        numThreads = 2;
+        permits = 0;
+    }
+    void* semaphores[2];
+    semaphores[0] = primitive->create(permits);
+    semaphores[1] = isHandoff ? primitive->create(permits) : semaphores[0];
+
+    pthread_barrier_t startBarrier;
+    pthread_barrier_init(&startBarrier,0,numThreads+1);
+    struct run_params_t params[SEMBENCH_MAX_THREADS];
+    pthread_t threads[SEMBENCH_MAX_THREADS];
+    for (register int i = 0; i < numThreads; ++i)
+    {
+        params[i].primitive = primitive;
+        params[i].semaphore = semaphores[i%2];
+        params[i].peer = semaphores[(i+1)%2];
+        params[i].numOperations = numOperations;
+        params[i].isInitiator = i == 0;
+        params[i].startBarrier = &startBarrier;
+        if (pthread_create(threads+i,0,isHandoff ? handoff_routine : contend_routine,params+i) != 0)
+        {
+            fatal_error("pthread_create");
+        }
+    }
+
+    long startSwitches = context_switches();
+    pthread_barrier_wait(&startBarrier);
+    long start = current_time_ns();
+    for (register int i = 0; i < numThreads; ++i)
+    {
+        pthread_join(threads[i],0);
+    }
+    long elapsed = current_time_ns()-start;
+    long switches = context_switches()-startSwitches;
+
+    pthread_barrier_destroy(&startBarrier);
+    primitive->destroy(semaphores[0]);
+    if (isHandoff)
+    {
+        primitive->destroy(semaphores[1]);
+    }
+
+    // a handoff operation is one trip of the permit; contend operations of
+    // different threads overlap, so they are counted over the wall time
+    double operations = (double) numOperations*numThreads;
+    printf("%-10s %-8s %7d %7d %10.1f %10.3f\n",primitive->name,isHandoff ? "handoff" : "contend",numThreads,permits,
+        elapsed/operations,switches/operations);
+    fflush(stdout);
+}
+
+/**
+ * main entry point of the application.
+ *
+ * parses command line arguments, then runs the contend workload for every
+ *   thread count, and the handoff workload, with each primitive.
+ *
+ * @function   main
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  int main (int argc, char* argv[])
+ *
+ * @param      argc number of command line arguments.
+ * @param      argv array of c-style strings.
+ *
+ * @return     exit code of the application.
+ */
+int main (int argc, char* argv[])
+{
+    long threadCounts[SEMBENCH_LIST_LEN] = {1,2,4,8};
+    int numThreadCounts = 4;
+    long numOperations = 1000000;
+    int permits = 1;
+
+    // parse command line arguments
+    {
+        int option;
+        while ((option = getopt(argc,argv,"t:n:p:")) != -1)
+        {
+            switch (option)
+            {
+            case 't':
+                {
+                    long parsed[SEMBENCH_LIST_LEN];
+                    int numParsed = parse_list(optarg,parsed);
+                    bool isValid = numParsed > 0;
+                    for (register int i = 0; i < numParsed; ++i)
+                    {
+                        isValid = isValid && parsed[i] <= SEMBENCH_MAX_THREADS;
+                    }
+                    if (!isValid)
+                    {
+                        fprintf(stderr,"invalid argument for option -%c\n",option);
+                        break;
+                    }
+                    memcpy(threadCounts,parsed,sizeof(parsed));
+                    numThreadCounts = numParsed;
+                    break;
+                }
+            case 'n':
+            case 'p':
+                {
+                    char* parsedCursor = optarg;
+                    long value = strtol(optarg,&parsedCursor,10);
+                    if (parsedCursor == optarg || value < 1)
+                    {
+                        fprintf(stderr,"invalid argument for option -%c\n",option);
+                        break;
+                    }
+                    if (option == 'n') numOperations = value;
+                    else permits = (int) value;
+                    break;
+                }
+            case '?':
+                {
+                    if (isprint(optopt))
+                    {
+                        fprintf(stderr,"unknown option \"-%c\".\n",optopt);
+                    }
+                    else
+                    {
+                        fprintf(stderr,"unknown option character \"%x\".\n",optopt);
+                    }
+                }
+            default:
+                {
+                    fprintf(stderr,"usage: %s [-t thread counts, e.g. 1,2,4,8] [-n operations per thread] [-p permits]\n",argv[0]);
+                    return EX_USAGE;
+                }
+            }
+        }
+    }
+
+    const int numPrimitives = sizeof(primitives)/sizeof(primitives[0]);
+    printf("# %-8s %-8s %7s %7s %10s %10s\n","primitive","workload","threads","permits","ns/op","switch/op");
+    for (register int t = 0; t < numThreadCounts; ++t)
+    {
+        for (register int p = 0; p < numPrimitives; ++p)
+        {
+            run(primitives+p,false,(int) threadCounts[t],permits,numOperations);
+        }
+    }
+    for (register int p = 0; p < numPrimitives; ++p)
+    {
+        run(primitives+p,true,2,0,numOperations >= 10 ? numOperations/10 : 1);
+    }
+    return EX_OK;
+}
@@ -0,0 +1,357 @@
+#include "stack_helper.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sysexits.h>
+#include <sys/mman.h>
+
+static struct pooled_stack_t* map_stack(struct stack_pool_t* pool, bool isPrefaulted);
+static void* stack_trampoline(void* voidStack);
+static void fatal_error(const char* errstr);
+
+/**
+ * initializes {pool}, and maps {numPrefaulted} stacks backed by memory up
+ *   front.
+ *
+ * @function   stack_pool_init
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       stacks mapped later, when the pool runs out, are only backed by
+ *   memory as far as their threads touch them; either way a stack stays
+ *   backed once it is reused.
+ *
+ * @signature  void stack_pool_init(struct stack_pool_t* pool, size_t stackLen,
+ *   size_t guardLen, int numPrefaulted)
+ *
+ * @param      pool pool to initialize.
+ * @param      stackLen usable bytes of each stack; rounded up to whole pages.
+ * @param      guardLen bytes of the guard area below each stack; rounded up to
+ *   whole pages. 0 for none.
+ * @param      numPrefaulted number of stacks to map and touch now.
+ */
+void stack_pool_init(struct stack_pool_t* pool, size_t stackLen, size_t guardLen, int numPrefaulted)
+{
+    size_t pageLen = sysconf(_SC_PAGESIZE);
+    pool->stackLen = (stackLen+pageLen-1)/pageLen*pageLen;
+    pool->guardLen = (guardLen+pageLen-1)/pageLen*pageLen;
+    pthread_mutex_init(&pool->lock,0);
+    pool->freeList = 0;
+    pool->exitedList = 0;
+    pool->numStacks = 0;
+    pool->numPrefaulted = 0;
+
+    for (register int i = 0; i < numPrefaulted; ++i)
+    {
+        struct pooled_stack_t* stack = map_stack(pool,true);
+        stack->next = pool->freeList;
+        pool->freeList = stack;
+    }
+}
+
+/**
+ * joins the threads of {pool} that returned, and unmaps every free stack.
+ *
+ * @function   stack_pool_destroy
+ *
+ * @date       2026-10-16
+ *
+ * @revision   2026-10-16 Eric Tsang - keeps the lock while threads still run,
+ *   since they take it when they return.
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       stacks of threads still running are not unmapped, e.g. after a
+ *   drain whose deadline passed; the process is about to exit then anyway.
+ *
+ * @signature  void stack_pool_destroy(struct stack_pool_t* pool)
+ *
+ * @param      pool pool to destroy.
+ */
+void stack_pool_destroy(struct stack_pool_t* pool)
+{
+    stack_pool_reap(pool);
+    while (pool->freeList != 0)
+    {
+        struct pooled_stack_t* stack = pool->freeList;
+        pool->freeList = stack->next;
+        munmap(stack->mapping,pool->guardLen+pool->stackLen);
+        free(stack);
+        __atomic_sub_fetch(&pool->numStacks,1,__ATOMIC_RELAXED);
+    }
+    if (__atomic_load_n(&pool->numStacks,__ATOMIC_RELAXED) == 0)
+    {
+        pthread_mutex_destroy(&pool->lock);
+    }
+}
+
+/**
+ * starts a thread on a stack of {pool} that calls {routine} with {arg}.
+ *
+ * @function   stack_pool_spawn
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       threads that returned are reaped first, so their stacks can be
+ *   reused. a new stack is mapped if none is free.
+ *
+ * @signature  int stack_pool_spawn(struct stack_pool_t* pool,
+ *   void* (*routine)(void*), void* arg)
+ *
+ * @param      pool pool to take the stack from.
+ * @param      routine function to run on the thread.
+ * @param      arg argument to pass to {routine}.
+ *
+ * @return     0, or the error number returned by pthread_create.
+ */
+int stack_pool_spawn(struct stack_pool_t* pool, void* (*routine)(void*), void* arg)
+{
+    stack_pool_reap(pool);
+
+    struct pooled_stack_t* stack = pool->freeList;
+    if (stack != 0)
+    {
+        pool->freeList = stack->next;
+    }
+    else
+    {
+        stack = map_stack(pool,false);
+    }
+    stack->routine = routine;
+    stack->arg = arg;
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstack(&attr,stack->mapping+pool->guardLen,pool->stackLen);
+    int result = pthread_create(&stack->thread,&attr,stack_trampoline,stack);
+    pthread_attr_destroy(&attr);
+    if (result != 0)
+    {
+        stack->next = pool->freeList;
+        pool->freeList = stack;
+    }
+    return result;
+}
+
+/**
+ * joins the threads of {pool} that returned, and frees their stacks for
+ *   reuse.
+ *
+ * @function   stack_pool_reap
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       a thread is still on its stack for a moment after it returns
+ *   from its routine, while it exits; joining it waits that moment out.
+ *
+ * @signature  void stack_pool_reap(struct stack_pool_t* pool)
+ *
+ * @param      pool pool to reap.
+ */
+void stack_pool_reap(struct stack_pool_t* pool)
+{
+    pthread_mutex_lock(&pool->lock);
+    struct pooled_stack_t* exited = pool->exitedList;
+    pool->exitedList = 0;
+    pthread_mutex_unlock(&pool->lock);
+
+    while (exited != 0)
+    {
+        struct pooled_stack_t* stack = exited;
+        exited = stack->next;
+        pthread_join(stack->thread,0);
+        stack->next = pool->freeList;
+        pool->freeList = stack;
+    }
+}
+
+/**
+ * prints the virtual and resident memory of the process, its number of
+ *   threads, and the stacks of {pool}.
+ *
+ * @function   stack_memory_report
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       read from /proc/self/status. the report is written with one
+ *   call, like perf_report.
+ *
+ * @signature  void stack_memory_report(FILE* file, const char* label,
+ *   struct stack_pool_t* pool)
+ *
+ * @param      file file to print to.
+ * @param      label label of the process, e.g. "server".
+ * @param      pool pool whose stacks to print; 0 if threads get their stacks
+ *   from pthread.
+ */
+void stack_memory_report(FILE* file, const char* label, struct stack_pool_t* pool)
+{
+    unsigned long vmSize = 0;
+    unsigned long vmRss = 0;
+    unsigned long numThreads = 0;
+    FILE* status = fopen("/proc/self/status","r");
+    if (status != 0)
+    {
+        char line[256];
+        while (fgets(line,sizeof(line),status) != 0)
+        {
+            sscanf(line,"VmSize: %lu",&vmSize);
+            sscanf(line,"VmRSS: %lu",&vmRss);
+            sscanf(line,"Threads: %lu",&numThreads);
+        }
+        fclose(status);
+    }
+
+    char report[256];
+    int reportLen = snprintf(report,sizeof(report),"[%d] %s: VSZ %lu KiB, RSS %lu KiB, %lu threads\n",
+        getpid(),label,vmSize,vmRss,numThreads);
+    if (pool != 0 && reportLen < (int) sizeof(report))
+    {
+        reportLen += snprintf(report+reportLen,sizeof(report)-reportLen,"%18s: %d mapped, %d prefaulted, %zu KiB each plus %zu KiB guard\n",
+            "stacks",__atomic_load_n(&pool->numStacks,__ATOMIC_RELAXED),pool->numPrefaulted,
+            pool->stackLen/1024,pool->guardLen/1024);
+    }
+    fwrite(report,1,strlen(report),file);
+    fflush(file);
+}
+
+/**
+ * maps a stack for {pool}, with its guard area below it.
+ *
+ * @function   map_stack
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the whole mapping is reserved PROT_NONE, and only the stack is
+ *   made writable, so the guard area never takes memory.
+ *
+ * @signature  static struct pooled_stack_t* map_stack(
+ *   struct stack_pool_t* pool, bool isPrefaulted)
+ *
+ * @param      pool pool to map the stack for.
+ * @param      isPrefaulted true to touch every page of the stack, so it is
+ *   backed by memory before a thread runs on it.
+ *
+ * @return     the stack.
+ */
+static struct pooled_stack_t* map_stack(struct stack_pool_t* pool, bool isPrefaulted)
+{
+    size_t pageLen = sysconf(_SC_PAGESIZE);
+    struct pooled_stack_t* stack = (struct pooled_stack_t*) malloc(sizeof(struct pooled_stack_t));
+    stack->pool = pool;
+    stack->mapping = (char*) mmap(0,pool->guardLen+pool->stackLen,PROT_NONE,
+        MAP_PRIVATE|MAP_ANONYMOUS|MAP_STACK|MAP_NORESERVE,-1,0);
+    if (stack->mapping == MAP_FAILED)
+    {
+        fatal_error("mmap");
+    }
+    if (mprotect(stack->mapping+pool->guardLen,pool->stackLen,PROT_READ|PROT_WRITE) == -1)
+    {
+        fatal_error("mprotect");
+    }
+
+    if (isPrefaulted)
+    {
+        for (register size_t offset = 0; offset < pool->stackLen; offset += pageLen)
+        {
+            ((volatile char*) stack->mapping)[pool->guardLen+offset] = 0;
+        }
+        pool->numPrefaulted++;
+    }
+    __atomic_add_fetch(&pool->numStacks,1,__ATOMIC_RELAXED);
+    return stack;
+}
+
+/**
+ * thread routine of a thread spawned from a pool: runs its routine, then
+ *   queues its stack to be reaped.
+ *
+ * @function   stack_trampoline
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  static void* stack_trampoline(void* voidStack)
+ *
+ * @param      voidStack pointer to the pooled_stack_t the thread runs on.
+ *
+ * @return     what the routine returned.
+ */
+static void* stack_trampoline(void* voidStack)
+{
+    struct pooled_stack_t* stack = (struct pooled_stack_t*) voidStack;
+    struct stack_pool_t* pool = stack->pool;
+    void* result = stack->routine(stack->arg);
+
+    pthread_mutex_lock(&pool->lock);
+    stack->next = pool->exitedList;
+    pool->exitedList = stack;
+    pthread_mutex_unlock(&pool->lock);
+    return result;
+}
+
+/**
+ * prints the error message, then exits the program.
+ *
+ * @function   fatal_error
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  static void fatal_error(const char* errstr)
+ *
+ * @param      errstr string to print before exiting the program
+ */
+static void fatal_error(const char* errstr)
+{
+    fprintf(stderr,"%s: ",errstr);
+    perror(0);
+    exit(EX_OSERR);
+}
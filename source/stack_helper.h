@@ -0,0 +1,44 @@
+#ifndef _STACK_HELPER_H_
+#define _STACK_HELPER_H_
+
+#include <stdio.h>
+#include <stddef.h>
+#include <pthread.h>
+
+/**
+ * thread stack of a stack pool, mapped with a PROT_NONE guard area below it.
+ */
+struct pooled_stack_t
+{
+    char* mapping;                  // starts with the guard area
+    pthread_t thread;               // thread running on the stack
+    void* (*routine)(void*);
+    void* arg;
+    struct stack_pool_t* pool;
+    struct pooled_stack_t* next;    // next in the free or exited list
+};
+
+/**
+ * thread stacks reused by the threads spawned from the pool, so starting a
+ *   thread maps nothing once as many stacks exist as threads run at once.
+ *   threads are spawned and reaped by one thread only; a thread's stack is
+ *   reused once it has been joined.
+ */
+struct stack_pool_t
+{
+    size_t stackLen;                // usable bytes of each stack
+    size_t guardLen;                // bytes of the guard area below each stack
+    pthread_mutex_t lock;           // guards exitedList
+    struct pooled_stack_t* freeList;
+    struct pooled_stack_t* exitedList;  // stacks of threads that returned, not joined
+    int numStacks;                  // stacks mapped
+    int numPrefaulted;              // stacks backed by memory when mapped
+};
+
+void stack_pool_init(struct stack_pool_t* pool, size_t stackLen, size_t guardLen, int numPrefaulted);
+void stack_pool_destroy(struct stack_pool_t* pool);
+int stack_pool_spawn(struct stack_pool_t* pool, void* (*routine)(void*), void* arg);
+void stack_pool_reap(struct stack_pool_t* pool);
+void stack_memory_report(FILE* file, const char* label, struct stack_pool_t* pool);
+
+#endif
@@ -0,0 +1,391 @@
+#include "supervisor_helper.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+#include <stdio.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sysexits.h>
+#include <sys/wait.h>
+#include <sys/signalfd.h>
+
+/**
+ * delay in milliseconds before respawning a worker that crashed soon after it
+ *   was started. the delay doubles with every crash in a row.
+ */
+#define SUPERVISOR_MIN_BACKOFF 100
+
+/**
+ * longest delay in milliseconds before respawning a worker.
+ */
+#define SUPERVISOR_MAX_BACKOFF 10000
+
+/**
+ * milliseconds a worker has to run for before a crash is no longer counted as
+ *   a crash in a row; such workers are respawned straight away.
+ */
+#define SUPERVISOR_STABLE_TIME 5000
+
+/**
+ * state of one worker slot.
+ */
+struct worker_slot_t
+{
+    pid_t pid;              // process id of the worker; 0 if it is not running
+    long startTime;         // time the worker was last started at
+    long restartTime;       // time to respawn the worker at, if it is not running
+    int crashCount;         // number of crashes in a row
+};
+
+static void fatal_error(const char* errstr);
+static long current_time();
+static void spawn_worker(struct worker_slot_t* slots, int workerIndex, worker_main_t workerMain, void* arg, const sigset_t* workerSignals);
+static void log_worker_exit(int workerIndex, pid_t pid, int status, long backoff);
+
+/**
+ * forks {numWorkers} worker processes that run {workerMain}, and supervises
+ *   them until SIGINT or SIGTERM is received. workers that terminate are
+ *   respawned into the same slot, so the number of workers stays at target.
+ *
+ * @function   supervise_workers
+ *
+ * @date       2026-10-16
+ *
+ * @revision   2026-10-16 Eric Tsang - SIGTERM drains the workers.
+ * @revision   2026-10-16 Eric Tsang - passes SUPERVISOR_DUMP_SIGNAL on to
+ *   the workers.
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the exit status or signal of every worker that terminates is
+ *   logged to stderr. a worker that terminates within SUPERVISOR_STABLE_TIME of
+ *   being started is respawned after a delay that doubles with every such
+ *   crash in a row, up to SUPERVISOR_MAX_BACKOFF, so a worker that cannot start
+ *   does not fork in a tight loop. on SIGINT, the signal is passed on to the
+ *   workers, and the function returns once they have all terminated. on
+ *   SIGTERM, the workers are sent SUPERVISOR_DRAIN_SIGNAL instead, and the
+ *   function returns once they have drained their connections and terminated.
+ *   on SIGUSR2, {upgrade} is called to start a new server, and the workers are
+ *   drained if it succeeds. SUPERVISOR_DUMP_SIGNAL is passed on to the workers.
+ *
+ * @signature  int supervise_workers(int numWorkers, worker_main_t workerMain,
+ *   upgrade_t upgrade, void* arg)
+ *
+ * @param      numWorkers number of worker processes to keep running.
+ * @param      workerMain entry point of the worker processes.
+ * @param      upgrade function that starts a new server to take over from
+ *   this one; 0 if SIGUSR2 should be ignored.
+ * @param      arg argument passed to {workerMain} and {upgrade}.
+ *
+ * @return     exit code of the supervising process.
+ */
+int supervise_workers(int numWorkers, worker_main_t workerMain, upgrade_t upgrade, void* arg)
+{
+    // block the signals handled by the supervisor before the first fork, so
+    // none are lost; workers restore the old mask, but keep the drain and
+    // dump signals blocked
+    sigset_t signals;
+    sigset_t oldSignals;
+    sigemptyset(&signals);
+    sigaddset(&signals,SIGINT);
+    sigaddset(&signals,SIGTERM);
+    sigaddset(&signals,SIGCHLD);
+    sigaddset(&signals,SIGUSR2);
+    sigaddset(&signals,SUPERVISOR_DRAIN_SIGNAL);
+    sigaddset(&signals,SUPERVISOR_DUMP_SIGNAL);
+    if (sigprocmask(SIG_BLOCK,&signals,&oldSignals) == -1)
+    {
+        fatal_error("sigprocmask");
+    }
+    sigset_t workerSignals = oldSignals;
+    sigaddset(&workerSignals,SUPERVISOR_DRAIN_SIGNAL);
+    sigaddset(&workerSignals,SUPERVISOR_DUMP_SIGNAL);
+    int signalFd = signalfd(-1,&signals,SFD_NONBLOCK|SFD_CLOEXEC);
+    if (signalFd == -1)
+    {
+        fatal_error("signalfd");
+    }
+
+    // start the worker processes
+    struct worker_slot_t* slots = (struct worker_slot_t*) calloc(numWorkers,sizeof(struct worker_slot_t));
+    for (register int i = 0; i < numWorkers; ++i)
+    {
+        spawn_worker(slots,i,workerMain,arg,&workerSignals);
+    }
+
+    // signal the workers were sent to stop them; 0 while they are supervised
+    int terminatingSignal = 0;
+    int numRunning = numWorkers;
+    while (!terminatingSignal || numRunning > 0)
+    {
+        // respawn the workers that are due, and work out how long to wait
+        // until the next one is
+        int pollTimeout = -1;
+        if (!terminatingSignal)
+        {
+            long now = current_time();
+            for (register int i = 0; i < numWorkers; ++i)
+            {
+                if (slots[i].pid != 0) continue;
+                if (slots[i].restartTime <= now)
+                {
+                    spawn_worker(slots,i,workerMain,arg,&workerSignals);
+                    numRunning++;
+                    continue;
+                }
+                int remaining = (int) (slots[i].restartTime-now);
+                if (pollTimeout < 0 || remaining < pollTimeout)
+                {
+                    pollTimeout = remaining;
+                }
+            }
+        }
+
+        // wait for a signal, or the next respawn
+        struct pollfd pollFd;
+        pollFd.fd = signalFd;
+        pollFd.events = POLLIN;
+        pollFd.revents = 0;
+        if (poll(&pollFd,1,pollTimeout) == -1 && errno != EINTR)
+        {
+            fatal_error("poll");
+        }
+        errno = 0;
+
+        // drain the workers on SIGTERM, and pass SIGINT on to them; either way,
+        // stop respawning them. SIGINT also cuts a drain short
+        struct signalfd_siginfo info;
+        while (read(signalFd,&info,sizeof(info)) == sizeof(info))
+        {
+            int signo = (int) info.ssi_signo;
+            if (signo == SIGCHLD) continue;
+            if (signo == SUPERVISOR_DUMP_SIGNAL)
+            {
+                // have the workers print their counters
+                for (register int i = 0; i < numWorkers; ++i)
+                {
+                    if (slots[i].pid != 0) kill(slots[i].pid,SUPERVISOR_DUMP_SIGNAL);
+                }
+                continue;
+            }
+            if (signo == SIGUSR2)
+            {
+                // hand over to a new server, then drain the workers
+                if (terminatingSignal) continue;
+                if (upgrade == 0)
+                {
+                    fprintf(stderr,"[%d] upgrades are not supported; ignoring SIGUSR2\n",getpid());
+                    continue;
+                }
+                if (!upgrade(arg))
+                {
+                    fprintf(stderr,"[%d] upgrade failed; keeping the current workers\n",getpid());
+                    continue;
+                }
+                fprintf(stderr,"[%d] upgraded; draining %d workers\n",getpid(),numRunning);
+                signo = SUPERVISOR_DRAIN_SIGNAL;
+            }
+            else if (signo == SIGTERM)
+            {
+                if (terminatingSignal) continue;
+                fprintf(stderr,"[%d] draining %d workers\n",getpid(),numRunning);
+                signo = SUPERVISOR_DRAIN_SIGNAL;
+            }
+            else if (terminatingSignal == signo)
+            {
+                continue;
+            }
+            terminatingSignal = signo;
+            for (register int i = 0; i < numWorkers; ++i)
+            {
+                if (slots[i].pid != 0) kill(slots[i].pid,terminatingSignal);
+            }
+        }
+        errno = 0;
+
+        // reap the workers that have terminated, and schedule their respawn
+        int status;
+        pid_t pid;
+        while ((pid = waitpid(-1,&status,WNOHANG)) > 0)
+        {
+            // processes that are not in a slot, like a new server that
+            // failed to start, are just reaped
+            for (register int i = 0; i < numWorkers; ++i)
+            {
+                if (slots[i].pid != pid) continue;
+                slots[i].pid = 0;
+                numRunning--;
+                if (terminatingSignal) break;
+
+                // back off if the worker keeps crashing soon after it starts
+                long now = current_time();
+                long backoff = 0;
+                if (now-slots[i].startTime < SUPERVISOR_STABLE_TIME)
+                {
+                    backoff = SUPERVISOR_MIN_BACKOFF;
+                    for (register int j = 0; j < slots[i].crashCount && backoff < SUPERVISOR_MAX_BACKOFF; ++j)
+                    {
+                        backoff *= 2;
+                    }
+                    if (backoff > SUPERVISOR_MAX_BACKOFF) backoff = SUPERVISOR_MAX_BACKOFF;
+                    slots[i].crashCount++;
+                }
+                else
+                {
+                    slots[i].crashCount = 0;
+                }
+                slots[i].restartTime = now+backoff;
+                log_worker_exit(i,pid,status,backoff);
+                break;
+            }
+        }
+        errno = 0;
+    }
+
+    // tear down
+    free(slots);
+    close(signalFd);
+    sigprocmask(SIG_SETMASK,&oldSignals,0);
+    return EX_OK;
+}
+
+/**
+ * forks a worker process into slot {workerIndex}. the worker sets its signal
+ *   mask to {workerSignals}, runs {workerMain}, and exits with its return
+ *   value.
+ *
+ * @function   spawn_worker
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  static void spawn_worker(struct worker_slot_t* slots,
+ *   int workerIndex, worker_main_t workerMain, void* arg,
+ *   const sigset_t* workerSignals)
+ *
+ * @param      slots array of all worker slots.
+ * @param      workerIndex index of the slot to start a worker in.
+ * @param      workerMain entry point of the worker process.
+ * @param      arg argument passed to {workerMain}.
+ * @param      workerSignals signal mask of the worker.
+ */
+static void spawn_worker(struct worker_slot_t* slots, int workerIndex, worker_main_t workerMain, void* arg, const sigset_t* workerSignals)
+{
+    pid_t pid = fork();
+    if (pid == -1)
+    {
+        fatal_error("fork");
+    }
+    if (pid == 0)
+    {
+        free(slots);
+        sigprocmask(SIG_SETMASK,workerSignals,0);
+        exit(workerMain(workerIndex,arg));
+    }
+    slots[workerIndex].pid = pid;
+    slots[workerIndex].startTime = current_time();
+}
+
+/**
+ * prints why a worker terminated, and when it will be respawned.
+ *
+ * @function   log_worker_exit
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  static void log_worker_exit(int workerIndex, pid_t pid,
+ *   int status, long backoff)
+ *
+ * @param      workerIndex slot of the worker.
+ * @param      pid process id of the worker.
+ * @param      status status of the worker, as returned by waitpid.
+ * @param      backoff milliseconds until the worker is respawned.
+ */
+static void log_worker_exit(int workerIndex, pid_t pid, int status, long backoff)
+{
+    char reason[64];
+    if (WIFSIGNALED(status))
+    {
+        snprintf(reason,sizeof(reason),"was killed by signal %d (%s)%s",
+            WTERMSIG(status),strsignal(WTERMSIG(status)),
+            WCOREDUMP(status) ? ", core dumped" : "");
+    }
+    else
+    {
+        snprintf(reason,sizeof(reason),"exited with status %d",WEXITSTATUS(status));
+    }
+    fprintf(stderr,"[%d] worker %d (pid %d) %s; respawning in %ld ms\n",
+        getpid(),workerIndex,pid,reason,backoff);
+}
+
+/**
+ * returns the current time of the monotonic clock in milliseconds.
+ *
+ * @function   current_time
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  static long current_time()
+ *
+ * @return     current time in milliseconds.
+ */
+static long current_time()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC,&now);
+    return now.tv_sec*1000+now.tv_nsec/1000000;
+}
+
+/**
+ * prints the error message, then exits the program.
+ *
+ * @function   fatal_error
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  static void fatal_error(const char* errstr)
+ *
+ * @param      errstr string to print before exiting the program
+ */
+static void fatal_error(const char* errstr)
+{
+    fprintf(stderr,"%s: ",errstr);
+    perror(0);
+    exit(EX_OSERR);
+}
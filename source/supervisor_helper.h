@@ -0,0 +1,36 @@
+#ifndef _SUPERVISOR_HELPER_H_
+#define _SUPERVISOR_HELPER_H_
+
+#include <signal.h>
+
+/**
+ * entry point of a supervised worker process. {workerIndex} is the worker's
+ *   slot, from 0 to the number of workers; a respawned worker keeps the slot
+ *   of the worker it replaces. the return value is the worker's exit code.
+ */
+typedef int (*worker_main_t)(int workerIndex, void* arg);
+
+/**
+ * starts a new server to take over from this one, when SIGUSR2 is received.
+ *   returns true once the new server is ready; the workers of this server
+ *   are then sent SUPERVISOR_DRAIN_SIGNAL, and are no longer respawned.
+ */
+typedef bool (*upgrade_t)(void* arg);
+
+/**
+ * signal sent to workers when they should stop accepting new connections,
+ *   and exit once their open connections are closed. it is kept blocked in
+ *   the workers, so they can wait on it with a signalfd.
+ */
+#define SUPERVISOR_DRAIN_SIGNAL SIGUSR2
+
+/**
+ * signal passed on to workers when they should print their counters, such as
+ *   cycle probes. it is kept blocked in the workers like the drain signal, and
+ *   is pending harmlessly in workers that do not wait on it.
+ */
+#define SUPERVISOR_DUMP_SIGNAL SIGUSR1
+
+int supervise_workers(int numWorkers, worker_main_t workerMain, upgrade_t upgrade, void* arg);
+
+#endif
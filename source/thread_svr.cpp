@@ -7,7 +7,16 @@
  *
  * @date       2016-02-14
  *
- * @revision   none
+ * @revision   2026-10-16 Eric Tsang - adds the pool mode, where epoll driven
+ *   I/O threads hand readable connections to a fixed pool of worker threads
+ *   through work-stealing deques.
+ * @revision   2026-10-16 Eric Tsang - adds the coroutine mode, where
+ *   worker_routine runs as stackful coroutines on a few threads.
+ * @revision   2026-10-16 Eric Tsang - the stack and guard size of connection
+ *   threads are configurable, stacks can be pooled and prefaulted, and memory
+ *   use is reported.
+ * @revision   2026-10-16 Eric Tsang - every mode serves the protocol picked
+ *   with -a instead of echoing.
  *
  * @designer   Eric Tsang
  *
@@ -18,7 +27,9 @@
 #include <ctype.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <poll.h>
 #include <stdio.h>
+#include <signal.h>
 #include <assert.h>
 #include <stdlib.h>
 #include <unistd.h>
@@ -27,15 +38,38 @@
 #include <sysexits.h>
 #include <sys/wait.h>
 #include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
 #include <netinet/in.h>
 #include "net_helper.h"
+#include "drain_helper.h"
+#include "perf_helper.h"
+#include "deque_helper.h"
+#include "coro_helper.h"
+#include "stack_helper.h"
+#include "handler_helper.h"
 #include "Semaphore.h"
 
 /**
- * size of buffer used to read bytes into from TCP/IP sockets.
+ * most bytes a connection thread or coroutine reads into a buffer on its
+ *   stack, which can be small; handlers that read more at once get a buffer
+ *   from the heap.
  */
 #define ECHO_BUFFER_LEN 1024
 
+/**
+ * size of events array passed to epoll_wait by the I/O threads of the pool
+ *   mode.
+ */
+#define EPOLL_QUEUE_LEN 256
+
+/**
+ * most reads a pool worker makes from a connection per task, before handing
+ *   the connection back to its I/O thread, so that one busy connection cannot
+ *   keep a worker to itself.
+ */
+#define POOL_READS_PER_TASK 16
+
 /**
  * prints the error message, then exits the program.
  *
@@ -70,6 +104,64 @@ struct WorkerRoutineParams
 {
     Semaphore* postOnAcceptPtr;
     int* serverSocketPtr;
+    struct drain_t* drainPtr;
+    long drainTimeout;
+    struct perf_group_t* perfGroupPtr;
+    unsigned long* numEchoesPtr;
+    unsigned long* numConnectionsPtr;
+    struct stack_pool_t* stackPoolPtr;
+    void* (*workerRoutine)(void*);      // worker_routine of the handler
+    void* (*poolWorkerRoutine)(void*);  // pool_worker_routine of the handler
+    void* (*poolIoRoutine)(void*);      // pool_io_routine of the handler
+    size_t connLen;                     // bytes of the handler's conn_t
+};
+
+/**
+ * threads of the pool mode, and what they share. connections are spread over
+ *   the I/O threads, which wait for them to become readable, and push a task
+ *   for each readable one onto a deque. there is a deque per worker thread,
+ *   pushed onto by one I/O thread, its owner; workers steal tasks from their
+ *   own deque first, and from the others when it is empty.
+ */
+struct Pool
+{
+    struct deque_t* deques;     // deque of each worker thread
+    int numWorkers;
+    int numIoThreads;
+    int* epolls;                // epoll of each I/O thread
+    Semaphore* tasksPtr;        // a permit for each task pushed but not taken
+    int stopFd;                 // eventfd; readable once the pool stops
+    bool isStopping;
+    int serverSocket;
+    struct drain_t* drainPtr;
+    unsigned long* numEchoesPtr;
+    unsigned long* numConnectionsPtr;
+    void* conns;                // handler state of each connection, by file
+                                //   descriptor; an array of the handler's conn_t
+    pthread_t* threads;         // worker threads, then I/O threads
+};
+
+/**
+ * a pointer of this structure is passed as the parameter for the threads of
+ *   the pool mode.
+ */
+struct PoolThreadParams
+{
+    struct Pool* pool;
+    int index;                  // index of the worker or I/O thread
+};
+
+/**
+ * threads of the coroutine mode, and what they share. each thread runs
+ *   worker_routine as coroutines, keeping one waiting to accept a connection.
+ */
+struct CoroMode
+{
+    int numThreads;
+    pthread_t* threads;
+    int stopFd;                 // eventfd; readable once the mode stops
+    bool isStopping;
+    WorkerRoutineParams* workerRoutineParamsPtr;
 };
 
 /**
@@ -80,37 +172,62 @@ struct WorkerRoutineParams
  *
  * @date       2016-02-14
  *
- * @revision   none
+ * @revision   2026-10-16 Eric Tsang - terminates instead of accepting once
+ *   the server is draining, and tracks its connection so it can be drained.
+ * @revision   2026-10-16 Eric Tsang - adds the echoes it served to the
+ *   server's count as it terminates, when its perf counters are added to the
+ *   server's too.
+ * @revision   2026-10-16 Eric Tsang - accepts, receives and sends through
+ *   coro_helper, and returns instead of calling pthread_exit, so it also runs
+ *   as a coroutine.
+ * @revision   2026-10-16 Eric Tsang - serves the protocol of {Handler}
+ *   instead of echoing.
+ * @revision   2026-10-16 Eric Tsang - reads as many bytes at once as
+ *   {Handler} asks for, into a buffer from the heap if that is more than
+ *   ECHO_BUFFER_LEN.
+ * @revision   2026-10-16 Eric Tsang - sends the output of a read the
+ *   handler rejects before closing the connection.
  *
  * @designer   Eric Tsang
  *
  * @programmer Eric Tsang
  *
- * @note       none
+ * @note       on a thread of its own, the coro_helper calls are the plain
+ *   blocking system calls; as a coroutine, they wait for the socket by
+ *   switching to another coroutine. the handler state of the connection
+ *   lives on the stack.
  *
- * @signature  void* worker_routine(void* voidParams)
+ * @signature  template<class Handler> void* worker_routine(void* voidParams)
  *
  * @param      voidParams pointer to a WorkerRoutineParams structure.
  */
+template<class Handler>
 void* worker_routine(void* voidParams)
 {
     WorkerRoutineParams* params = (WorkerRoutineParams*) voidParams;
     int serverSocket = *(params->serverSocketPtr);
-    char buf[ECHO_BUFFER_LEN];
+    struct drain_t* drain = params->drainPtr;
+    char stackBuf[ECHO_BUFFER_LEN];
     int clntSock;
 
     // accept a client
     while (true)
     {
         // accept the remote connection
-        if ((clntSock = accept(serverSocket,0,0)) >= 0)
+        if ((clntSock = coro_accept(serverSocket,0,0)) >= 0)
         {
             break;
         }
 
+        // the server socket is shut down once the server starts draining
+        if (drain_is_draining(drain))
+        {
+            return 0;
+        }
+
         // ignore EAGAIN because this socket is shared, and connection
         // may have been accepted by another process
-        if (errno == EAGAIN)
+        else if (errno == EAGAIN)
         {
             errno = 0;
         }
@@ -122,19 +239,51 @@ void* worker_routine(void* voidParams)
         }
     }
 
+    // apply the socket options profile to the new socket
+    apply_sockopt_profile(clntSock);
+    drain_open(drain,clntSock);
+
     // connection established; post
     params->postOnAcceptPtr->post();
+    typename Handler::conn_t conn;
+    Handler::on_accept(&conn,clntSock);
+    char* heapBuf = 0;
+    if (Handler::readLen > ECHO_BUFFER_LEN && (heapBuf = (char*) malloc(Handler::readLen)) == 0)
+    {
+        fatal_error("malloc");
+    }
+    char* buf = heapBuf != 0 ? heapBuf : stackBuf;
 
-    // read and echo back to client
+    // read, and send back what the handler responds with
     register int bytesRead;
-    while ((bytesRead = recv(clntSock,buf,ECHO_BUFFER_LEN,0)) > 0)
+    unsigned long numEchoes = 0;
+    bool isRejected = false;
+    while ((bytesRead = coro_recv(clntSock,buf,Handler::readLen,0)) > 0)
     {
-        send(clntSock,buf,bytesRead,0);
+        drain_touch(drain,clntSock);
+        struct span_t data = {buf,(size_t) bytesRead};
+        struct handler_output_t output;
+        isRejected = !Handler::on_data(&conn,data,&output);
+        for (register int i = 0; i < output.numSpans; ++i)
+        {
+            coro_send(clntSock,output.spans[i].data,output.spans[i].len,0);
+        }
+        numEchoes++;
+        if (isRejected)
+        {
+            break;
+        }
     }
+    Handler::on_close(&conn);
+    free(heapBuf);
+    __atomic_add_fetch(params->numEchoesPtr,numEchoes,__ATOMIC_RELAXED);
+    __atomic_add_fetch(params->numConnectionsPtr,1,__ATOMIC_RELAXED);
 
-    // if socket is closed, close socket
-    if (bytesRead == 0 || errno == ECONNRESET)
+    // if socket is closed, or the handler rejected what it read, close socket
+    if (isRejected || bytesRead == 0 || errno == ECONNRESET)
     {
+        drain_close(drain,clntSock);
+        if (isRejected) handler_linger(clntSock);
         close(clntSock);
         errno = 0;
     }
@@ -145,7 +294,637 @@ void* worker_routine(void* voidParams)
         fatal_error("recv");
     }
 
-    pthread_exit(0);
+    return 0;
+}
+
+/**
+ * sends all {len} bytes of {buf} over the non-blocking socket {fd}, waiting
+ *   for room in its send buffer as needed.
+ *
+ * @function   send_all
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       errors are left to the next recv on the socket to report.
+ *
+ * @signature  void send_all(int fd, const char* buf, int len)
+ *
+ * @param      fd socket to send on.
+ * @param      buf bytes to send.
+ * @param      len number of bytes to send.
+ */
+void send_all(int fd, const char* buf, int len)
+{
+    while (len > 0)
+    {
+        register int bytesSent = send(fd,buf,len,MSG_NOSIGNAL);
+        if (bytesSent == -1)
+        {
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+                errno = 0;
+                return;
+            }
+            struct pollfd pollFd;
+            pollFd.fd = fd;
+            pollFd.events = POLLOUT;
+            poll(&pollFd,1,-1);
+            errno = 0;
+            continue;
+        }
+        buf += bytesSent;
+        len -= bytesSent;
+    }
+}
+
+/**
+ * services one task of the pool mode: echoes what the connection {fd} has to
+ *   read, then hands it back to its I/O thread, or closes it.
+ *
+ * @function   serve_task
+ *
+ * @date       2026-10-16
+ *
+ * @revision   2026-10-16 Eric Tsang - serves the protocol of {Handler}
+ *   instead of echoing.
+ * @revision   2026-10-16 Eric Tsang - reads as many bytes at once as
+ *   {Handler} asks for; pool workers have full-size stacks.
+ * @revision   2026-10-16 Eric Tsang - sends the output of a read the
+ *   handler rejects before closing the connection.
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the same loop as worker_routine, on a non-blocking socket.
+ *   connections are registered with EPOLLONESHOT, so only one worker services
+ *   a connection at a time, and it is only armed again once the worker is
+ *   done with it; the same goes for its handler state.
+ *
+ * @signature  template<class Handler> void serve_task(struct Pool* pool,
+ *   int epoll, int fd)
+ *
+ * @param      pool pool the task came from.
+ * @param      epoll epoll of the I/O thread the connection belongs to.
+ * @param      fd connection to service.
+ */
+template<class Handler>
+void serve_task(struct Pool* pool, int epoll, int fd)
+{
+    struct drain_t* drain = pool->drainPtr;
+    char buf[Handler::readLen];
+    typename Handler::conn_t* conn = ((typename Handler::conn_t*) pool->conns)+fd;
+
+    // read, and send back what the handler responds with
+    register int bytesRead = 0;
+    unsigned long numEchoes = 0;
+    int numReads = 0;
+    bool isRejected = false;
+    while (numReads++ < POOL_READS_PER_TASK && (bytesRead = recv(fd,buf,Handler::readLen,0)) > 0)
+    {
+        drain_touch(drain,fd);
+        struct span_t data = {buf,(size_t) bytesRead};
+        struct handler_output_t output;
+        isRejected = !Handler::on_data(conn,data,&output);
+        for (register int i = 0; i < output.numSpans; ++i)
+        {
+            send_all(fd,output.spans[i].data,(int) output.spans[i].len);
+        }
+        numEchoes++;
+        if (isRejected)
+        {
+            break;
+        }
+    }
+    __atomic_add_fetch(pool->numEchoesPtr,numEchoes,__ATOMIC_RELAXED);
+
+    // nothing left to read for now, or the connection had its turn; hand it
+    // back to its I/O thread
+    if (!isRejected && (numReads > POOL_READS_PER_TASK || (bytesRead == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))))
+    {
+        errno = 0;
+        struct epoll_event event = epoll_event();
+        event.events = EPOLLIN|EPOLLONESHOT;
+        event.data.fd = fd;
+        if (epoll_ctl(epoll,EPOLL_CTL_MOD,fd,&event) == -1)
+        {
+            fatal_error("epoll_ctl");
+        }
+    }
+
+    // if socket is closed, or the handler rejected what it read, close socket
+    else if (isRejected || bytesRead == 0 || errno == ECONNRESET)
+    {
+        Handler::on_close(conn);
+        __atomic_add_fetch(pool->numConnectionsPtr,1,__ATOMIC_RELAXED);
+        drain_close(drain,fd);
+        if (isRejected) handler_linger(fd);
+        close(fd);
+        errno = 0;
+    }
+
+    // else unexpected error, die
+    else
+    {
+        fatal_error("recv");
+    }
+}
+
+/**
+ * thread routine of a worker of the pool mode: takes a task whenever there is
+ *   one, and services it, until the pool stops.
+ *
+ * @function   pool_worker_routine
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       a worker only looks for a task once it holds a permit of the
+ *   tasks semaphore, so there is always a task left for it in some deque; it
+ *   sleeps on the semaphore while there are none. tasks are encoded as the
+ *   I/O thread's index in the upper half, and the connection in the lower.
+ *
+ * @signature  template<class Handler> void* pool_worker_routine(
+ *   void* voidParams)
+ *
+ * @param      voidParams pointer to a PoolThreadParams structure.
+ */
+template<class Handler>
+void* pool_worker_routine(void* voidParams)
+{
+    PoolThreadParams* params = (PoolThreadParams*) voidParams;
+    struct Pool* pool = params->pool;
+
+    while (true)
+    {
+        pool->tasksPtr->wait();
+        if (__atomic_load_n(&pool->isStopping,__ATOMIC_ACQUIRE))
+        {
+            return 0;
+        }
+
+        // steal from our own deque first, then from the others in turn
+        long task;
+        int victim = params->index;
+        while (!deque_steal(pool->deques+victim,&task))
+        {
+            victim = (victim+1)%pool->numWorkers;
+        }
+        serve_task<Handler>(pool,pool->epolls[task>>32],(int) (task&0xffffffff));
+    }
+}
+
+/**
+ * thread routine of an I/O thread of the pool mode: accepts connections, and
+ *   pushes a task for each of its connections that becomes readable onto its
+ *   deques, until the pool stops.
+ *
+ * @function   pool_io_routine
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       I/O thread i owns deques i, i+numIoThreads, and so on, and
+ *   pushes onto them in turn. every I/O thread waits on the server socket
+ *   with EPOLLEXCLUSIVE, so a connection wakes one of them, which keeps it.
+ *   once the server drains, the server socket is shut down, and taken out.
+ *
+ * @signature  template<class Handler> void* pool_io_routine(
+ *   void* voidParams)
+ *
+ * @param      voidParams pointer to a PoolThreadParams structure.
+ */
+template<class Handler>
+void* pool_io_routine(void* voidParams)
+{
+    PoolThreadParams* params = (PoolThreadParams*) voidParams;
+    struct Pool* pool = params->pool;
+    int epoll = pool->epolls[params->index];
+    int nextDeque = params->index;
+    struct epoll_event events[EPOLL_QUEUE_LEN];
+
+    while (true)
+    {
+        int eventCount = epoll_wait(epoll,events,EPOLL_QUEUE_LEN,-1);
+        if (eventCount == -1)
+        {
+            if (errno == EINTR)
+            {
+                errno = 0;
+                continue;
+            }
+            fatal_error("epoll_wait");
+        }
+
+        for (register int i = 0; i < eventCount; ++i)
+        {
+            int fd = events[i].data.fd;
+            if (fd == pool->stopFd)
+            {
+                return 0;
+            }
+
+            // accept every pending connection, and wait for it to be readable
+            if (fd == pool->serverSocket)
+            {
+                int clntSock;
+                while ((clntSock = accept4(pool->serverSocket,0,0,SOCK_NONBLOCK)) != -1)
+                {
+                    apply_sockopt_profile(clntSock);
+                    drain_open(pool->drainPtr,clntSock);
+                    Handler::on_accept(((typename Handler::conn_t*) pool->conns)+clntSock,clntSock);
+                    struct epoll_event event = epoll_event();
+                    event.events = EPOLLIN|EPOLLONESHOT;
+                    event.data.fd = clntSock;
+                    if (epoll_ctl(epoll,EPOLL_CTL_ADD,clntSock,&event) == -1)
+                    {
+                        fatal_error("epoll_ctl");
+                    }
+                }
+                if (drain_is_draining(pool->drainPtr))
+                {
+                    epoll_ctl(epoll,EPOLL_CTL_DEL,pool->serverSocket,0);
+                }
+                else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != ECONNABORTED)
+                {
+                    fatal_error("accept4");
+                }
+                errno = 0;
+                continue;
+            }
+
+            // hand the readable connection to the workers
+            deque_push(pool->deques+nextDeque,((long) params->index<<32)|fd);
+            pool->tasksPtr->post();
+            nextDeque += pool->numIoThreads;
+            if (nextDeque >= pool->numWorkers)
+            {
+                nextDeque = params->index;
+            }
+        }
+    }
+}
+
+/**
+ * starts the threads of the pool mode.
+ *
+ * @function   pool_start
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       there are at most as many I/O threads as workers, so every I/O
+ *   thread owns at least one deque.
+ *
+ * @signature  void pool_start(struct Pool* pool, int numWorkers,
+ *   int numIoThreads, WorkerRoutineParams* workerRoutineParams)
+ *
+ * @param      pool pool to start.
+ * @param      numWorkers number of worker threads.
+ * @param      numIoThreads number of I/O threads.
+ * @param      workerRoutineParams server socket, drain and counters the pool
+ *   shares with the rest of the server.
+ */
+void pool_start(struct Pool* pool, int numWorkers, int numIoThreads, WorkerRoutineParams* workerRoutineParams)
+{
+    if (numIoThreads > numWorkers)
+    {
+        numIoThreads = numWorkers;
+    }
+    pool->numWorkers = numWorkers;
+    pool->numIoThreads = numIoThreads;
+    pool->deques = new struct deque_t[numWorkers];
+    for (register int i = 0; i < numWorkers; ++i)
+    {
+        deque_init(pool->deques+i);
+    }
+    pool->tasksPtr = new Semaphore(false,0);
+    pool->isStopping = false;
+    pool->serverSocket = *(workerRoutineParams->serverSocketPtr);
+    pool->drainPtr = workerRoutineParams->drainPtr;
+    pool->numEchoesPtr = workerRoutineParams->numEchoesPtr;
+    pool->numConnectionsPtr = workerRoutineParams->numConnectionsPtr;
+    pool->conns = calloc(handler_table_len(),workerRoutineParams->connLen);
+    pool->stopFd = eventfd(0,EFD_NONBLOCK|EFD_CLOEXEC);
+    if (pool->stopFd == -1)
+    {
+        fatal_error("eventfd");
+    }
+
+    // every I/O thread waits for connections, and for the pool to stop
+    pool->epolls = new int[numIoThreads];
+    for (register int i = 0; i < numIoThreads; ++i)
+    {
+        pool->epolls[i] = epoll_create1(EPOLL_CLOEXEC);
+        if (pool->epolls[i] == -1)
+        {
+            fatal_error("epoll_create1");
+        }
+        struct epoll_event event = epoll_event();
+        event.events = EPOLLIN|EPOLLEXCLUSIVE;
+        event.data.fd = pool->serverSocket;
+        if (epoll_ctl(pool->epolls[i],EPOLL_CTL_ADD,pool->serverSocket,&event) == -1)
+        {
+            fatal_error("epoll_ctl");
+        }
+        event.events = EPOLLIN;
+        event.data.fd = pool->stopFd;
+        if (epoll_ctl(pool->epolls[i],EPOLL_CTL_ADD,pool->stopFd,&event) == -1)
+        {
+            fatal_error("epoll_ctl");
+        }
+    }
+
+    // start the workers, then the I/O threads
+    int numThreads = numWorkers+numIoThreads;
+    pool->threads = new pthread_t[numThreads];
+    PoolThreadParams* threadParams = new PoolThreadParams[numThreads];
+    for (register int i = 0; i < numThreads; ++i)
+    {
+        threadParams[i].pool = pool;
+        threadParams[i].index = i < numWorkers ? i : i-numWorkers;
+        if (pthread_create(pool->threads+i,0,i < numWorkers ? workerRoutineParams->poolWorkerRoutine : workerRoutineParams->poolIoRoutine,threadParams+i) != 0)
+        {
+            fatal_error("pthread_create");
+        }
+    }
+}
+
+/**
+ * stops the threads of the pool mode, and waits for them to terminate.
+ *
+ * @function   pool_stop
+ *
+ * @date       2026-10-16
+ *
+ * @revision   2026-10-16 Eric Tsang - frees the deques of the workers once
+ *   they are joined.
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the threads are joined, so their perf counters, which they
+ *   inherited from the main thread, are added to the server's.
+ *
+ * @signature  void pool_stop(struct Pool* pool)
+ *
+ * @param      pool pool to stop.
+ */
+void pool_stop(struct Pool* pool)
+{
+    __atomic_store_n(&pool->isStopping,true,__ATOMIC_RELEASE);
+    uint64_t one = 1;
+    if (write(pool->stopFd,&one,sizeof(one)) == -1)
+    {
+        fatal_error("write");
+    }
+    for (register int i = 0; i < pool->numWorkers; ++i)
+    {
+        pool->tasksPtr->post();
+    }
+    for (register int i = 0; i < pool->numWorkers+pool->numIoThreads; ++i)
+    {
+        pthread_join(pool->threads[i],0);
+    }
+    for (register int i = 0; i < pool->numWorkers; ++i)
+    {
+        deque_destroy(pool->deques+i);
+    }
+    delete[] pool->deques;
+}
+
+/**
+ * thread routine of the coroutine mode: runs worker_routine as coroutines,
+ *   starting a new one whenever one accepts a connection, until the mode
+ *   stops.
+ *
+ * @function   coro_thread_routine
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the coroutines post to a semaphore of the thread's own when
+ *   they accept, as threads post to the main thread's; the thread checks it
+ *   between runs of the scheduler. only one coroutine per thread waits to
+ *   accept, because a scheduler lets one coroutine at a time wait on a file
+ *   descriptor.
+ *
+ * @signature  void* coro_thread_routine(void* voidParams)
+ *
+ * @param      voidParams pointer to a CoroMode structure.
+ */
+void* coro_thread_routine(void* voidParams)
+{
+    CoroMode* mode = (CoroMode*) voidParams;
+
+    struct coro_scheduler_t scheduler;
+    coro_scheduler_init(&scheduler,CORO_DEFAULT_STACK_LEN);
+    struct epoll_event event = epoll_event();
+    event.events = EPOLLIN;
+    event.data.ptr = 0;
+    if (epoll_ctl(scheduler.epoll,EPOLL_CTL_ADD,mode->stopFd,&event) == -1)
+    {
+        fatal_error("epoll_ctl");
+    }
+
+    Semaphore postOnAccept(false,1);
+    WorkerRoutineParams workerRoutineParams = *(mode->workerRoutineParamsPtr);
+    workerRoutineParams.postOnAcceptPtr = &postOnAccept;
+
+    while (!__atomic_load_n(&mode->isStopping,__ATOMIC_ACQUIRE))
+    {
+        while (postOnAccept.try_wait())
+        {
+            coro_spawn(&scheduler,workerRoutineParams.workerRoutine,&workerRoutineParams);
+        }
+        coro_run(&scheduler,-1);
+    }
+    coro_scheduler_destroy(&scheduler);
+    return 0;
+}
+
+/**
+ * starts the threads of the coroutine mode.
+ *
+ * @function   coro_mode_start
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       none
+ *
+ * @signature  void coro_mode_start(struct CoroMode* mode, int numThreads,
+ *   WorkerRoutineParams* workerRoutineParams)
+ *
+ * @param      mode mode to start.
+ * @param      numThreads number of threads to run coroutines on.
+ * @param      workerRoutineParams parameters of worker_routine; each thread
+ *   gives its coroutines a semaphore of its own to post to.
+ */
+void coro_mode_start(struct CoroMode* mode, int numThreads, WorkerRoutineParams* workerRoutineParams)
+{
+    mode->numThreads = numThreads;
+    mode->isStopping = false;
+    mode->workerRoutineParamsPtr = workerRoutineParams;
+    mode->stopFd = eventfd(0,EFD_NONBLOCK|EFD_CLOEXEC);
+    if (mode->stopFd == -1)
+    {
+        fatal_error("eventfd");
+    }
+    mode->threads = new pthread_t[numThreads];
+    for (register int i = 0; i < numThreads; ++i)
+    {
+        if (pthread_create(mode->threads+i,0,coro_thread_routine,mode) != 0)
+        {
+            fatal_error("pthread_create");
+        }
+    }
+}
+
+/**
+ * stops the threads of the coroutine mode, and waits for them to terminate.
+ *
+ * @function   coro_mode_stop
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       coroutines still suspended are abandoned; their connections
+ *   are closed as the server exits. the threads are joined, so their perf
+ *   counters are added to the server's.
+ *
+ * @signature  void coro_mode_stop(struct CoroMode* mode)
+ *
+ * @param      mode mode to stop.
+ */
+void coro_mode_stop(struct CoroMode* mode)
+{
+    __atomic_store_n(&mode->isStopping,true,__ATOMIC_RELEASE);
+    uint64_t one = 1;
+    if (write(mode->stopFd,&one,sizeof(one)) == -1)
+    {
+        fatal_error("write");
+    }
+    for (register int i = 0; i < mode->numThreads; ++i)
+    {
+        pthread_join(mode->threads[i],0);
+    }
+}
+
+/**
+ * makes every mode serve the protocol of {Handler}.
+ *
+ * @function   use_handler
+ *
+ * @date       2026-10-16
+ *
+ * @revision   none
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       the routines are instantiated for the handler, so its calls are
+ *   inlined into them.
+ *
+ * @signature  template<class Handler> void use_handler(
+ *   WorkerRoutineParams* params)
+ *
+ * @param      params parameters to set the routines of.
+ */
+template<class Handler>
+void use_handler(WorkerRoutineParams* params)
+{
+    params->workerRoutine = worker_routine<Handler>;
+    params->poolWorkerRoutine = pool_worker_routine<Handler>;
+    params->poolIoRoutine = pool_io_routine<Handler>;
+    params->connLen = sizeof(typename Handler::conn_t);
+}
+
+/**
+ * thread routine that waits for SIGTERM, then starts draining the server: it
+ *   stops the accept path, and wakes the main thread to drain the connections.
+ *   prints the server's perf counters on every SIGUSR1 until then.
+ *
+ * @function   signal_routine
+ *
+ * @date       2026-10-16
+ *
+ * @revision   2026-10-16 Eric Tsang - prints perf counters on SIGUSR1.
+ * @revision   2026-10-16 Eric Tsang - prints memory use on SIGUSR1.
+ *
+ * @designer   Eric Tsang
+ *
+ * @programmer Eric Tsang
+ *
+ * @note       SIGTERM and SIGUSR1 must be blocked in every thread. shutting
+ *   down the server socket makes the threads blocked in accept return.
+ *
+ * @signature  void* signal_routine(void* voidParams)
+ *
+ * @param      voidParams pointer to a WorkerRoutineParams structure.
+ */
+void* signal_routine(void* voidParams)
+{
+    WorkerRoutineParams* params = (WorkerRoutineParams*) voidParams;
+
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals,SIGTERM);
+    sigaddset(&signals,SIGUSR1);
+    int signo;
+    while (sigwait(&signals,&signo) != 0 || signo == SIGUSR1)
+    {
+        if (signo == SIGUSR1)
+        {
+            perf_report(stderr,"server",params->perfGroupPtr,
+                __atomic_load_n(params->numEchoesPtr,__ATOMIC_RELAXED),
+                __atomic_load_n(params->numConnectionsPtr,__ATOMIC_RELAXED));
+            stack_memory_report(stderr,"server",params->stackPoolPtr);
+        }
+    }
+
+    drain_start(params->drainPtr,params->drainTimeout);
+    shutdown(*(params->serverSocketPtr),SHUT_RD);
+    params->postOnAcceptPtr->post();
+    return 0;
 }
 
 /**
@@ -158,7 +937,19 @@ void* worker_routine(void* voidParams)
  *
  * @date       2016-02-14
  *
- * @revision   none
+ * @revision   2026-10-16 Eric Tsang - on SIGTERM, stops topping off the thread
+ *   pool, and drains the open connections before returning.
+ * @revision   2026-10-16 Eric Tsang - counts hardware and software events of
+ *   every thread with perf, and prints them once drained.
+ * @revision   2026-10-16 Eric Tsang - runs the pool mode instead of a thread
+ *   per connection when given a number of pool threads.
+ * @revision   2026-10-16 Eric Tsang - runs the coroutine mode when given a
+ *   number of coroutine threads.
+ * @revision   2026-10-16 Eric Tsang - creates connection threads with the
+ *   stack and guard size given, on pooled stacks if asked to, and prints
+ *   memory use once drained.
+ * @revision   2026-10-16 Eric Tsang - -a picks the protocol served.
+ * @revision   2026-10-16 Eric Tsang - unmaps the pooled stacks once drained.
  *
  * @designer   Eric Tsang
  *
@@ -184,12 +975,35 @@ int main (int argc, char* argv[])
     // number of worker process to create to server connections
     int numWorkerProcesses;
 
+    // milliseconds to wait for connections to close when draining
+    long drainTimeout = DRAIN_DEFAULT_TIMEOUT;
+
+    // number of worker threads of the pool mode; 0 for a thread per connection
+    int numPoolThreads = 0;
+
+    // number of I/O threads of the pool mode
+    int numIoThreads = 1;
+
+    // number of threads of the coroutine mode; 0 for a thread per connection
+    int numCoroThreads = 0;
+
+    // KiB of stack and of guard area of connection threads; -1 for the
+    // pthread default
+    long stackKib = -1;
+    long guardKib = -1;
+
+    // number of prefaulted stacks to pool; -1 to let pthread map the stacks
+    int numPooledStacks = -1;
+
+    // protocol served
+    enum handler_kind_t handler = HANDLER_ECHO;
+
     // parse command line arguments
     {
         char option;
         int portInitialized = false;
         int numWorkerProcessesInitialized = false;
-        while ((option = getopt(argc,argv,"p:n:")) != -1)
+        while ((option = getopt(argc,argv,"p:n:O:D:t:i:c:S:G:P:a:")) != -1)
         {
             switch (option)
             {
@@ -221,6 +1035,86 @@ int main (int argc, char* argv[])
                     }
                     break;
                 }
+            case 'D':
+                {
+                    char* parsedCursor = optarg;
+                    drainTimeout = strtol(optarg,&parsedCursor,10);
+                    if (parsedCursor == optarg || drainTimeout < 0)
+                    {
+                        fprintf(stderr,"invalid argument for option -%c\n",option);
+                        drainTimeout = DRAIN_DEFAULT_TIMEOUT;
+                    }
+                    break;
+                }
+            case 't':
+            case 'i':
+            case 'c':
+                {
+                    char* parsedCursor = optarg;
+                    int value = (int) strtol(optarg,&parsedCursor,10);
+                    if (parsedCursor == optarg || value < (option == 'i' ? 1 : 0))
+                    {
+                        fprintf(stderr,"invalid argument for option -%c\n",option);
+                    }
+                    else if (option == 't')
+                    {
+                        numPoolThreads = value;
+                    }
+                    else if (option == 'c')
+                    {
+                        numCoroThreads = value;
+                    }
+                    else
+                    {
+                        numIoThreads = value;
+                    }
+                    break;
+                }
+            case 'S':
+            case 'G':
+            case 'P':
+                {
+                    char* parsedCursor = optarg;
+                    long value = strtol(optarg,&parsedCursor,10);
+                    if (parsedCursor == optarg || value < (option == 'S' ? 1 : 0))
+                    {
+                        fprintf(stderr,"invalid argument for option -%c\n",option);
+                    }
+                    else if (option == 'S')
+                    {
+                        stackKib = value;
+                    }
+                    else if (option == 'G')
+                    {
+                        guardKib = value;
+                    }
+                    else
+                    {
+                        numPooledStacks = (int) value;
+                    }
+                    break;
+                }
+            case 'a':
+                {
+                    if (!parse_handler(optarg,&handler))
+                    {
+                        fprintf(stderr,"invalid argument for option -%c\n",option);
+                    }
+                    break;
+                }
+            case 'O':
+                {
+                    struct sockopt_profile_t profile;
+                    if (!parse_sockopt_profile(optarg,&profile))
+                    {
+                        fprintf(stderr,"invalid argument for option -%c\n",option);
+                    }
+                    else
+                    {
+                        set_sockopt_profile(&profile);
+                    }
+                    break;
+                }
             case '?':
                 {
                     if (isprint(optopt))
@@ -243,36 +1137,163 @@ int main (int argc, char* argv[])
         if (!portInitialized &&
             !numWorkerProcessesInitialized)
         {
-            fprintf(stderr,"usage: %s [-p server listening port] [-n number of worker processes]\n",argv[0]);
+            fprintf(stderr,"usage: %s [-p server listening port] [-n number of worker processes] [-O socket options, e.g. nodelay,quickack,sndbuf=N] [-D drain timeout in ms] [-t pool worker threads; 0 for a thread per connection] [-i pool I/O threads] [-c coroutine threads; 0 for a thread per connection] [-S connection thread stack in KiB] [-G connection thread guard in KiB] [-P prefaulted stacks to pool] [-a protocol: echo, discard, chargen or length]\n",argv[0]);
+            return EX_USAGE;
+        }
+        if (numPoolThreads > 0 && numCoroThreads > 0)
+        {
+            fprintf(stderr,"options -t and -c cannot be combined\n");
             return EX_USAGE;
         }
     }
 
     // create server socket
-    serverSocket = make_tcp_server_socket(listeningPort,false).fd;
+    serverSocket = make_tcp_server_socket(listeningPort,numPoolThreads > 0 || numCoroThreads > 0).fd;
     if (serverSocket == -1)
     {
         fatal_error("socket");
     }
 
-    // setup IPC
-    Semaphore postOnAccept(false,numWorkerProcesses);
+    // setup IPC; the pool and coroutine modes only wait on it for the drain
+    // to start
+    bool isThreadPerConnection = numPoolThreads == 0 && numCoroThreads == 0;
+    Semaphore postOnAccept(false,isThreadPerConnection ? numWorkerProcesses : 0);
+
+    // connections open, tracked so they can be drained
+    struct drain_t drain;
+    drain_init(&drain);
+
+    // hardware and software events of the server, counted from before any
+    // thread is created so that every thread inherits the counters, and what
+    // the server served
+    struct perf_group_t perfGroup;
+    perf_open(&perfGroup,true);
+    unsigned long numEchoes = 0;
+    unsigned long numConnections = 0;
 
     // setup worker routine parameters
     WorkerRoutineParams workerRoutineParams;
     workerRoutineParams.serverSocketPtr = &serverSocket;
     workerRoutineParams.postOnAcceptPtr = &postOnAccept;
+    workerRoutineParams.drainPtr = &drain;
+    workerRoutineParams.drainTimeout = drainTimeout;
+    workerRoutineParams.perfGroupPtr = &perfGroup;
+    workerRoutineParams.numEchoesPtr = &numEchoes;
+    workerRoutineParams.numConnectionsPtr = &numConnections;
+    switch (handler)
+    {
+    case HANDLER_DISCARD:
+        use_handler<discard_handler_t>(&workerRoutineParams);
+        break;
+    case HANDLER_CHARGEN:
+        use_handler<chargen_handler_t>(&workerRoutineParams);
+        break;
+    case HANDLER_LENGTH:
+        use_handler<length_handler_t>(&workerRoutineParams);
+        break;
+    default:
+        use_handler<echo_handler_t>(&workerRoutineParams);
+        break;
+    }
 
-    // start the worker processes
-    while (true)
+    // attributes of the connection threads; pooled stacks bring their own
+    // guard area, and are reused once their thread is joined
+    pthread_attr_t threadAttr;
+    pthread_attr_init(&threadAttr);
+    pthread_attr_setdetachstate(&threadAttr,PTHREAD_CREATE_DETACHED);
+    if (stackKib != -1 && pthread_attr_setstacksize(&threadAttr,stackKib*1024) != 0)
     {
-        postOnAccept.wait();
+        fprintf(stderr,"stack of %ld KiB is below the minimum of %ld KiB\n",stackKib,(long) PTHREAD_STACK_MIN/1024);
+        return EX_USAGE;
+    }
+    if (guardKib != -1)
+    {
+        pthread_attr_setguardsize(&threadAttr,guardKib*1024);
+    }
+    struct stack_pool_t stackPool;
+    workerRoutineParams.stackPoolPtr = 0;
+    if (numPooledStacks != -1 && isThreadPerConnection)
+    {
+        size_t stackLen;
+        size_t guardLen;
+        pthread_attr_getstacksize(&threadAttr,&stackLen);
+        pthread_attr_getguardsize(&threadAttr,&guardLen);
+        stack_pool_init(&stackPool,stackLen,guardLen,numPooledStacks);
+        workerRoutineParams.stackPoolPtr = &stackPool;
+    }
+
+    // block SIGTERM and SIGUSR1 in every thread, and wait for them on a thread
+    // of its own
+    {
+        sigset_t signals;
+        sigemptyset(&signals);
+        sigaddset(&signals,SIGTERM);
+        sigaddset(&signals,SIGUSR1);
+        pthread_sigmask(SIG_BLOCK,&signals,0);
+
         pthread_t thread;
-        if (pthread_create(&thread,0,worker_routine,&workerRoutineParams) != 0)
+        if (pthread_create(&thread,0,signal_routine,&workerRoutineParams) != 0)
         {
             fatal_error("pthread_create");
         }
         pthread_detach(thread);
     }
+
+    // run the pool or the coroutines until draining
+    struct Pool pool;
+    struct CoroMode coroMode;
+    if (numPoolThreads > 0)
+    {
+        pool_start(&pool,numPoolThreads,numIoThreads,&workerRoutineParams);
+        postOnAccept.wait();
+    }
+    else if (numCoroThreads > 0)
+    {
+        coro_mode_start(&coroMode,numCoroThreads,&workerRoutineParams);
+        postOnAccept.wait();
+    }
+
+    // start the worker processes until draining
+    while (isThreadPerConnection)
+    {
+        postOnAccept.wait();
+        if (drain_is_draining(&drain))
+        {
+            break;
+        }
+        pthread_t thread;
+        int result = workerRoutineParams.stackPoolPtr != 0 ?
+            stack_pool_spawn(&stackPool,workerRoutineParams.workerRoutine,&workerRoutineParams) :
+            pthread_create(&thread,&threadAttr,workerRoutineParams.workerRoutine,&workerRoutineParams);
+        if (result != 0)
+        {
+            errno = result;
+            fatal_error("pthread_create");
+        }
+    }
+
+    // wait for the connections to close; the rest are closed on return
+    int timeout;
+    while (drain_step(&drain,&timeout))
+    {
+        poll(0,0,timeout);
+    }
+    if (numPoolThreads > 0)
+    {
+        pool_stop(&pool);
+    }
+    else if (numCoroThreads > 0)
+    {
+        coro_mode_stop(&coroMode);
+    }
+    perf_report(stderr,"server",&perfGroup,
+        __atomic_load_n(&numEchoes,__ATOMIC_RELAXED),
+        __atomic_load_n(&numConnections,__ATOMIC_RELAXED));
+    stack_memory_report(stderr,"server",workerRoutineParams.stackPoolPtr);
+    if (workerRoutineParams.stackPoolPtr != 0)
+    {
+        stack_pool_destroy(&stackPool);
+    }
+    pthread_attr_destroy(&threadAttr);
     return EX_OK;
 }